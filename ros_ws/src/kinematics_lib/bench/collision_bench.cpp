@@ -0,0 +1,180 @@
+/**
+* @file collision_bench.cpp
+* @brief Collision checks per second of the UR5 capsules against a static scene, with and without the broadphase
+*
+* The scene is loaded from a scene file (the workcell of ur5_controller), optionally with random obstacles (clutter)
+* around the robot. The continuous check of straight motions uses the clearance function, the step and the clearance
+* distance of the controller. It is compared with a fixed number of samples (50, as in move_to before the continuous check)
+* and with a dense reference (2000 samples) of the distance constraints, the obstacles and the workbench: it must never
+* accept a motion rejected by the reference. The singularities are not distances, the controller samples them every step.
+* Build the package in Release mode (catkin_make -DCMAKE_BUILD_TYPE=Release) before running it.
+*
+* Usage: collision_bench <scene file> [configurations] [random obstacles] [motions]
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/collision.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+// Parameters of the continuous checks of the UR5 controller (clearance_distance and max_check_step)
+const double clearance_distance = 0.15;
+const double max_check_step = 0.1;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        cerr << "usage: " << argv[0] << " <scene file> [configurations] [random obstacles] [motions]" << endl;
+        return 1;
+    }
+    int n = argc > 2 ? atoi(argv[2]) : 200000;
+    int n_clutter = argc > 3 ? atoi(argv[3]) : 0;
+    int n_motions = argc > 4 ? atoi(argv[4]) : 2000;
+
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI, M_PI);
+    uniform_real_distribution<double> position(-1.0, 1.0), size(0.02, 0.08);
+
+    CollisionScene scene;
+    if (!scene.load(argv[1]))
+    {
+        cerr << "cannot read the scene " << argv[1] << endl;
+        return 1;
+    }
+    for (int i = 0; i < n_clutter; i++)
+    {
+        Coordinates center(position(gen), position(gen), position(gen));
+        if (center.norm() < 0.3)
+            continue;
+        if (i % 2)
+            scene.add_box("clutter", {center, euler_to_rot(joint_dist(gen), joint_dist(gen), joint_dist(gen)), Coordinates(size(gen), size(gen), size(gen))});
+        else
+            scene.add_capsule("clutter", {center, center + Coordinates(size(gen), size(gen), size(gen)), size(gen)});
+    }
+    scene.build();
+
+    vector<JointStateVector> configurations(n);
+    for (auto &q : configurations)
+        for (int j = 0; j < 6; j++)
+            q(j) = joint_dist(gen);
+
+    // End effector point against the workbench constraint (the previous check)
+    auto start = chrono::steady_clock::now();
+    int point_hits = 0;
+    for (const auto &q : configurations)
+        point_hits += ur5_workbench_distance(ur5_direct(q).pos) < 0;
+    double point_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Capsules of the links against every obstacle, and with the broadphase
+    vector<int> brute(n), tree(n);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+        brute[i] = scene.first_collision(scene.robot_links(configurations[i]), false) >= 0;
+    double brute_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+        tree[i] = scene.first_collision(scene.robot_links(configurations[i])) >= 0;
+    double tree_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int hits = 0, mismatches = 0;
+    for (int i = 0; i < n; i++)
+    {
+        hits += tree[i];
+        mismatches += tree[i] != brute[i];
+    }
+
+    // Distance constraints of a configuration, and its validity and clearance as in the controller (configuration_clearance)
+    auto is_valid = [&scene](const JointStateVector &q) { return ur5_workbench_distance(ur5_direct(q).pos) >= 0 && !scene.in_collision(q); };
+    ClearanceFunction clearance = [&scene](const JointStateVector &q, UR5LinkDistances &distances)
+    {
+        if (!ur5_check_configuration(q))
+            return false;
+        distances = scene.clearance(q, clearance_distance);
+        distances[5] = min(distances[5], ur5_workbench_distance(ur5_direct(q).pos));
+        return *min_element(distances.begin(), distances.end()) > 0;
+    };
+
+    // Straight motions between valid configurations, from short to long
+    vector<pair<JointStateVector, JointStateVector>> motions;
+    for (int i = 0; i + 1 < n && (int)motions.size() < n_motions; i += 2)
+    {
+        if (!is_valid(configurations[i]) || !is_valid(configurations[i + 1]) ||
+            !ur5_check_configuration(configurations[i]) || !ur5_check_configuration(configurations[i + 1]))
+            continue;
+        double scale = (motions.size() % 10 + 1) / 10.0;
+        motions.push_back(make_pair(configurations[i], configurations[i] + scale * (configurations[i + 1] - configurations[i])));
+    }
+
+    auto sampled = [&is_valid](const JointStateVector &from, const JointStateVector &to, int samples)
+    {
+        for (int k = 0; k <= samples; k++)
+            if (!is_valid(from + (to - from) * k / samples))
+                return false;
+        return true;
+    };
+    vector<int> reference(motions.size()), fixed(motions.size()), continuous(motions.size());
+    for (int i = 0; i < (int)motions.size(); i++)
+        reference[i] = sampled(motions[i].first, motions[i].second, 2000);
+
+    // Times and evaluated configurations of the valid motions (index 1) and of the invalid ones (index 0)
+    double fixed_time[2] = {0, 0}, continuous_time[2] = {0, 0};
+    long evaluations[2] = {0, 0};
+    for (int i = 0; i < (int)motions.size(); i++)
+    {
+        start = chrono::steady_clock::now();
+        fixed[i] = sampled(motions[i].first, motions[i].second, 50);
+        fixed_time[reference[i]] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        int count;
+        start = chrono::steady_clock::now();
+        continuous[i] = scene.check_motion(motions[i].first, motions[i].second, clearance, max_check_step, &count);
+        continuous_time[reference[i]] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        evaluations[reference[i]] += count;
+    }
+
+    // The valid motions rejected by the continuous check either cross a singularity or pass too close to an obstacle
+    auto singular = [](const JointStateVector &from, const JointStateVector &to)
+    {
+        for (int k = 0; k <= 2000; k++)
+            if (!ur5_check_configuration(from + (to - from) * k / 2000))
+                return true;
+        return false;
+    };
+    int valid = 0, fixed_misses = 0, unsafe = 0, rejected = 0, rejected_singular = 0;
+    for (int i = 0; i < (int)motions.size(); i++)
+    {
+        valid += reference[i];
+        fixed_misses += fixed[i] && !reference[i];
+        unsafe += continuous[i] && !reference[i];
+        if (!continuous[i] && reference[i])
+        {
+            rejected++;
+            rejected_singular += singular(motions[i].first, motions[i].second);
+        }
+    }
+    int counts[2] = {(int)motions.size() - valid, valid};
+
+    cout << "configurations: " << n << ", obstacles: " << scene.size() << endl;
+    cout << "end effector point:     " << n / point_time / 1e6 << " M checks/s, " << point_hits << " collisions" << endl;
+    cout << "capsules, all pairs:    " << n / brute_time / 1e6 << " M checks/s" << endl;
+    cout << "capsules, broadphase:   " << n / tree_time / 1e6 << " M checks/s, " << hits << " collisions, " << mismatches << " mismatches" << endl;
+
+    cout << "motions: " << motions.size() << ", " << valid << " valid (2000 samples), continuous check step " << max_check_step << " rad" << endl;
+    for (int k = 1; k >= 0; k--)
+    {
+        cout << (k ? "valid motions" : "invalid motions") << endl;
+        cout << "  50 samples:           " << fixed_time[k] / counts[k] * 1e6 << " us/motion" << endl;
+        cout << "  continuous:           " << continuous_time[k] / counts[k] * 1e6 << " us/motion, "
+             << (double)evaluations[k] / counts[k] << " configurations/motion" << endl;
+    }
+    cout << "collisions missed: " << fixed_misses << " with 50 samples, " << unsafe << " continuous; valid motions rejected: " << rejected
+         << " (" << rejected_singular << " across a singularity)" << endl;
+
+    return mismatches == 0 && unsafe == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+/**
+* @file kinematics_lib_bench.cpp
+* @brief Google Benchmark suite of kinematics_lib: the kinematics of the UR5, the trajectory planning, the line control
+* of Shelfino and the path validation pipeline of the UR5 controller, with no ROS master or Gazebo.
+*
+* The results are written to kinematics_lib_bench.json (Google Benchmark JSON format) unless another --benchmark_out
+* is given, e.g. to keep one file per commit:
+*
+*     kinematics_lib_bench --benchmark_out=bench_$(git rev-parse --short HEAD).json
+*
+* The inputs are random reachable poses of the workcell (fixed seed), the same for every run. The obstacles are read from
+* the scene file of the UR5 controller (ur5_controller/config/workcell.scene), or from another one given with --scene=<file>.
+* Build the package in Release mode (catkin_make -DCMAKE_BUILD_TYPE=Release) before running it.
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/shelfino_kinematics.h"
+#include "kinematics_lib/collision.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Scene file of the obstacles, the one checked by the UR5 controller unless --scene is given */
+static string scene_file = WORKCELL_SCENE;
+
+/**
+ * @brief Inputs shared by the benchmarks: reachable poses of the workcell with a valid configuration reaching them,
+ * the home configuration of the FSM and the obstacles of the scene file (empty scene if it cannot be read)
+ */
+struct BenchInputs
+{
+    vector<JointStateVector> configurations;
+    vector<RigidTransform> poses;
+    JointStateVector home;
+    CollisionScene scene;
+
+    BenchInputs()
+    {
+        scene.load(scene_file);
+
+        // Pick and place region of the FSM, default rotation of the gripper
+        RotationMatrix rot = euler_to_rot(M_PI / 2, 0, 0);
+        home = first_valid(Coordinates(0.1, -0.3, 0.4), rot);
+
+        mt19937 gen(42);
+        uniform_real_distribution<double> x(-0.35, 0.45), y(-0.6, 0.15), z(0.45, 0.8);
+        while (poses.size() < 1024)
+        {
+            Coordinates pos(x(gen), y(gen), z(gen));
+            JointStateVector q = first_valid(pos, rot);
+            if (q.allFinite())
+            {
+                configurations.push_back(q);
+                poses.push_back(ur5_direct(q));
+            }
+        }
+    }
+
+    /**
+     * @return The first exact ik solution of the pose that is a valid configuration of the workcell, NaN if none
+     */
+    JointStateVector first_valid(const Coordinates &pos, const RotationMatrix &rot) const
+    {
+        Eigen::Array<bool, 8, 1> exact;
+        Eigen::Matrix<double, 8, 6> ik = ur5_inverse_complete_simd(pos, rot, exact);
+        for (int i = 0; i < 8; i++)
+        {
+            JointStateVector q = ik.row(i).transpose();
+            if (exact(i) && ur5_check_configuration(q) && !scene.in_collision(q))
+                return q;
+        }
+        return JointStateVector::Constant(NAN);
+    }
+};
+
+static const BenchInputs &inputs(void)
+{
+    static BenchInputs instance;
+    return instance;
+}
+
+/* Kinematics */
+
+static void BM_ur5_direct(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ur5_direct(in.configurations[i]));
+        i = (i + 1) % in.configurations.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ur5_direct);
+
+static void BM_ur5_inverse(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ur5_inverse(in.poses[i].pos, in.poses[i].rot));
+        i = (i + 1) % in.poses.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ur5_inverse);
+
+static void BM_ur5_inverse_complete(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ur5_inverse_complete(in.poses[i].pos, in.poses[i].rot));
+        i = (i + 1) % in.poses.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ur5_inverse_complete);
+
+static void BM_ur5_inverse_complete_simd(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ur5_inverse_complete_simd(in.poses[i].pos, in.poses[i].rot));
+        i = (i + 1) % in.poses.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ur5_inverse_complete_simd);
+
+static void BM_ur5_jacobian(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ur5_jacobian(in.configurations[i]));
+        i = (i + 1) % in.configurations.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ur5_jacobian);
+
+/* Trajectories and control */
+
+/**
+ * Planning and evaluation of every configuration of the trajectory, the argument is the number of configurations
+ */
+static void BM_ur5_trajectory_plan(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    int n = state.range(0);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        CubicTrajectory path = ur5_trajectory_plan(in.home, in.configurations[i], n);
+        for (const JointStateVector &q : path)
+            benchmark::DoNotOptimize(q);
+        i = (i + 1) % in.configurations.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ur5_trajectory_plan)->Arg(10)->Arg(50)->Arg(200);
+
+static void BM_line_control(benchmark::State &state)
+{
+    mt19937 gen(42);
+    uniform_real_distribution<double> position(-0.1, 0.1), angle(-M_PI, M_PI);
+    vector<Coordinates> current(1024), desired(1024);
+    vector<double> current_rot(1024), desired_rot(1024);
+    for (int k = 0; k < 1024; k++)
+    {
+        current[k] << position(gen), position(gen), 0;
+        desired[k] << position(gen), position(gen), 0;
+        current_rot[k] = angle(gen);
+        desired_rot[k] = angle(gen);
+    }
+
+    int k = 0;
+    double linear_vel, angular_vel;
+    for (auto _ : state)
+    {
+        line_control(current[k], current_rot[k], desired[k], desired_rot[k], 0.2, 0.0, linear_vel, angular_vel);
+        benchmark::DoNotOptimize(linear_vel);
+        benchmark::DoNotOptimize(angular_vel);
+        k = (k + 1) & 1023;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_line_control);
+
+/* Planning pipeline of UR5Controller::move_to, from the home configuration to every pose */
+
+/**
+ * Exact ik solutions of the pose, closest to the initial configuration first
+ */
+static vector<JointStateVector> ranked_solutions(const RigidTransform &pose, const JointStateVector &initial)
+{
+    Eigen::Array<bool, 8, 1> exact;
+    Eigen::Matrix<double, 8, 6> ik = ur5_inverse_complete_simd(pose.pos, pose.rot, exact);
+    vector<JointStateVector> solutions;
+    for (int i = 0; i < 8; i++)
+        if (exact(i))
+            solutions.push_back(ik.row(i).transpose());
+    stable_sort(solutions.begin(), solutions.end(), [&initial](const JointStateVector &a, const JointStateVector &b)
+    {
+        return (a - initial).norm() < (b - initial).norm();
+    });
+    return solutions;
+}
+
+/**
+ * Pipeline of the controller: ik, trajectory of every solution in ranked order, continuous validation
+ * of the trajectories (constraints of ur5_check_configuration and distances from the obstacles) until a valid one
+ */
+static void BM_validate_path(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    ClearanceFunction clearance = [&in](const JointStateVector &q, UR5LinkDistances &distances)
+    {
+        if (!ur5_check_configuration(q))
+            return false;
+        distances = in.scene.clearance(q, 0.15);
+        distances[5] = min(distances[5], ur5_workbench_distance(ur5_direct(q).pos));
+        return *min_element(distances.begin(), distances.end()) > 0;
+    };
+
+    size_t i = 0;
+    long valid = 0, evaluations = 0;
+    for (auto _ : state)
+    {
+        for (const JointStateVector &q : ranked_solutions(in.poses[i], in.home))
+        {
+            CubicTrajectory path = ur5_trajectory_plan(in.home, q, 50);
+            int count = 0;
+            bool found = in.scene.check_motion(path.front(), path.back(), clearance, 0.1, &count);
+            evaluations += count;
+            if (found)
+            {
+                valid++;
+                break;
+            }
+        }
+        i = (i + 1) % in.poses.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["valid_fraction"] = benchmark::Counter((double)valid / state.iterations());
+    state.counters["configurations"] = benchmark::Counter((double)evaluations / state.iterations());
+}
+BENCHMARK(BM_validate_path);
+
+/**
+ * Same pipeline, every configuration of the trajectory checked at the 50 samples (previous validation)
+ */
+static void BM_validate_path_sampled(benchmark::State &state)
+{
+    const BenchInputs &in = inputs();
+    size_t i = 0;
+    long valid = 0;
+    for (auto _ : state)
+    {
+        for (const JointStateVector &q : ranked_solutions(in.poses[i], in.home))
+        {
+            CubicTrajectory path = ur5_trajectory_plan(in.home, q, 50);
+            bool found = all_of(path.begin(), path.end(), [&in](const JointStateVector &p)
+            {
+                return ur5_check_configuration(p) && !in.scene.in_collision(p);
+            });
+            if (found)
+            {
+                valid++;
+                break;
+            }
+        }
+        i = (i + 1) % in.poses.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["valid_fraction"] = benchmark::Counter((double)valid / state.iterations());
+}
+BENCHMARK(BM_validate_path_sampled);
+
+int main(int argc, char **argv)
+{
+    // JSON results by default, to be tracked across commits
+    vector<char *> args(argv, argv + argc);
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strncmp(args[i], "--scene=", 8) == 0)
+        {
+            scene_file = args[i] + 8;
+            args.erase(args.begin() + i--);
+        }
+    }
+    string out = "--benchmark_out=kinematics_lib_bench.json", format = "--benchmark_out_format=json";
+    bool has_out = any_of(args.begin() + 1, args.end(), [](const char *arg) { return strncmp(arg, "--benchmark_out=", 16) == 0; });
+    if (!has_out)
+    {
+        args.push_back(&out[0]);
+        args.push_back(&format[0]);
+    }
+    int n_args = args.size();
+
+    benchmark::Initialize(&n_args, args.data());
+    if (benchmark::ReportUnrecognizedArguments(n_args, args.data()))
+        return 1;
+    if (inputs().scene.empty())
+    {
+        cerr << "cannot read the scene " << scene_file << endl;
+        return 1;
+    }
+    benchmark::AddCustomContext("inputs", to_string(inputs().poses.size()) + " reachable poses, seed 42");
+    benchmark::AddCustomContext("scene", scene_file);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+/**
+* @file rrt_connect_bench.cpp
+* @brief Planning time and success rate of the RRT-Connect planner over random reachable goals of the UR5
+*
+* The state checker is the one of the UR5 controller (ur5_check_configuration: workbench constraint and singularities).
+* Build the package in Release mode (catkin_make -DCMAKE_BUILD_TYPE=Release) before running it.
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/rrt_connect.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 200;
+    double max_time = argc > 2 ? atof(argv[2]) : 0.5;
+
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI, M_PI);
+    auto random_valid = [&]()
+    {
+        JointStateVector q;
+        do
+        {
+            for (int j = 0; j < 6; j++)
+                q(j) = joint_dist(gen);
+        } while (!ur5_check_configuration(q));
+        return q;
+    };
+
+    JointStateVector upper = JointStateVector::Constant(M_PI);
+    RRTConnect planner(ur5_check_configuration, -upper, upper);
+
+    int queries = 0, direct = 0, solved = 0;
+    vector<double> times;
+    double smoothing_time = 0, raw_length = 0, smooth_length = 0;
+    int raw_waypoints = 0, smooth_waypoints = 0;
+
+    while (queries < n)
+    {
+        // A reachable goal: the pose of a valid configuration, reached by its closest valid ik solution
+        JointStateVector start = random_valid();
+        RigidTransform target = ur5_direct(random_valid());
+        Eigen::Matrix<double, 8, 6> ik_result = ur5_inverse_complete(target.pos, target.rot);
+
+        JointStateVector goal;
+        double best = INFINITY;
+        for (int i = 0; i < 8; i++)
+        {
+            JointStateVector q = ik_result.row(i).transpose();
+            if (q.allFinite() && ur5_check_configuration(q) && (q - start).norm() < best)
+            {
+                best = (q - start).norm();
+                goal = q;
+            }
+        }
+        if (!isfinite(best))
+            continue;
+        queries++;
+
+        // The planner is the fallback of the cubic path: only the goals it cannot reach are of interest
+        CubicTrajectory cubic = ur5_trajectory_plan(start, goal, 50);
+        if (all_of(cubic.begin(), cubic.end(), ur5_check_configuration))
+        {
+            direct++;
+            continue;
+        }
+
+        vector<JointStateVector> path;
+        if (!planner.plan(start, goal, max_time, path))
+            continue;
+        solved++;
+        times.push_back(planner.get_stats().planning_time);
+
+        raw_waypoints += path.size();
+        for (int k = 0; k + 1 < (int)path.size(); k++)
+            raw_length += (path[k + 1] - path[k]).norm();
+
+        planner.shortcut(path);
+        smoothing_time += planner.get_stats().smoothing_time;
+        smooth_waypoints += path.size();
+        for (int k = 0; k + 1 < (int)path.size(); k++)
+            smooth_length += (path[k + 1] - path[k]).norm();
+    }
+
+    int fallback = queries - direct;
+    sort(times.begin(), times.end());
+    cout << "queries: " << queries << ", valid cubic path: " << direct << ", planner queries: " << fallback
+         << ", time budget: " << max_time << " s" << endl;
+    cout << "success rate: " << (fallback ? 100.0 * solved / fallback : 100.0) << " %" << endl;
+    if (solved)
+    {
+        double total = 0;
+        for (double t : times)
+            total += t;
+        cout << "planning time: mean " << total / solved * 1000 << " ms, median " << times[solved / 2] * 1000
+             << " ms, max " << times.back() * 1000 << " ms" << endl;
+        cout << "shortcut time: " << smoothing_time / solved * 1000 << " ms" << endl;
+        cout << "waypoints: " << (double)raw_waypoints / solved << " -> " << (double)smooth_waypoints / solved << endl;
+        cout << "path length: " << raw_length / solved << " -> " << smooth_length / solved << " rad" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+/**
+* @file toppra_bench.cpp
+* @brief Duration of the UR5 motions timed by the time optimal path parameterization, and its computation time
+*
+* Build the package in Release mode (catkin_make -DCMAKE_BUILD_TYPE=Release) before running it.
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/toppra.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 500;
+    int n_gridpoints = argc > 2 ? atoi(argv[2]) : 100;
+
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI / 2, M_PI / 2);
+    JointLimits limits = ur5_joint_limits();
+    OnlineTrajectoryGenerator generator(limits, 0.001);
+
+    double line_generator = 0, line_toppra = 0;
+    double stop_generator = 0, spline_toppra = 0;
+    double compute_time = 0;
+    int failures = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        // A pick and place cycle: four waypoints (above the pick, pick, above the place, place)
+        vector<JointStateVector> waypoints(4);
+        for (auto &q : waypoints)
+            for (int j = 0; j < 6; j++)
+                q(j) = joint_dist(gen);
+
+        // Single movement: the cubic path of the planner
+        CubicTrajectory line(waypoints[0], waypoints[1], 50);
+        PathTiming timing;
+        auto start = chrono::steady_clock::now();
+        bool ok = time_parameterize(line, limits, timing, n_gridpoints);
+        compute_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        generator.set_target(waypoints[0], waypoints[1]);
+        line_generator += generator.duration();
+        line_toppra += timing.duration();
+
+        // Whole cycle: stop at every waypoint, or a single spline through the waypoints
+        WaypointPath spline(waypoints);
+        start = chrono::steady_clock::now();
+        ok = time_parameterize(spline, limits, timing, n_gridpoints) && ok;
+        compute_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        for (int k = 0; k + 1 < (int)waypoints.size(); k++)
+        {
+            generator.set_target(waypoints[k], waypoints[k + 1]);
+            stop_generator += generator.duration();
+        }
+        spline_toppra += timing.duration();
+
+        failures += !ok;
+    }
+
+    cout << "cycles: " << n << ", gridpoints: " << n_gridpoints << ", failures: " << failures << endl;
+    cout << "single movement, jerk limited generator: " << line_generator / n << " s" << endl;
+    cout << "single movement, time optimal:           " << line_toppra / n << " s" << endl;
+    cout << "cycle, stop at every waypoint:           " << stop_generator / n << " s" << endl;
+    cout << "cycle, time optimal through waypoints:   " << spline_toppra / n << " s" << endl;
+    cout << "parameterization time: " << compute_time / (2 * n) * 1000 << " ms/path" << endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+/**
+* @file trajectory_generator_bench.cpp
+* @brief Duration of the UR5 movements timed by the online trajectory generator against the previous linear filter
+*
+* The robot is assumed to track the setpoints exactly, the loop runs at 1000 Hz as in ur5_controller_node.
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+static const double loop_frequency = 1000.0;
+static const double joints_error = 0.05;
+
+/**
+ * Duration of a movement with the previous controller: the filtered setpoint moves towards each of the
+ * n intermediate configurations with a scalar velocity ramping to 0.6, until the error is below joints_error
+ */
+static double linear_filter_duration(const JointStateVector &initial_joints, const JointStateVector &final_joints, int n)
+{
+    JointStateVector lin_filter = initial_joints;
+    double v_ref = 0.0;
+    int cycles = 0;
+
+    for (int k = 0; k < n; k++)
+    {
+        double t = (double)k / n;
+        JointStateVector intermediate_joints = initial_joints + (final_joints - initial_joints) * (3 * t * t - 2 * t * t * t);
+        while ((intermediate_joints - lin_filter).norm() > joints_error)
+        {
+            v_ref += 0.005 * (0.6 - v_ref);
+            lin_filter += 1.0 / loop_frequency * v_ref * (intermediate_joints - lin_filter) / (intermediate_joints - lin_filter).norm();
+            cycles++;
+        }
+    }
+    return cycles / loop_frequency;
+}
+
+/**
+ * Duration of a movement streamed by the online trajectory generator
+ */
+static double generator_duration(OnlineTrajectoryGenerator &generator, const JointStateVector &initial_joints, const JointStateVector &final_joints)
+{
+    int cycles = 0;
+    generator.set_target(initial_joints, final_joints);
+    while (!generator.finished())
+    {
+        generator.next();
+        cycles++;
+    }
+    return cycles / loop_frequency;
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 1000;
+
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI, M_PI);
+    uniform_real_distribution<double> move_dist(0.1, 1.5);
+    OnlineTrajectoryGenerator generator(ur5_joint_limits(), 1.0 / loop_frequency);
+
+    double filter_total = 0, generator_total = 0;
+    for (int i = 0; i < n; i++)
+    {
+        // Pick and place sized movements: every joint moves up to 1.5 rad
+        JointStateVector initial_joints, final_joints;
+        for (int j = 0; j < 6; j++)
+        {
+            initial_joints(j) = joint_dist(gen);
+            final_joints(j) = initial_joints(j) + (j % 2 ? 1 : -1) * move_dist(gen);
+        }
+        filter_total += linear_filter_duration(initial_joints, final_joints, 50);
+        generator_total += generator_duration(generator, initial_joints, final_joints);
+    }
+
+    cout << "movements: " << n << endl;
+    cout << "linear filter:        " << filter_total / n << " s/movement" << endl;
+    cout << "trajectory generator: " << generator_total / n << " s/movement" << endl;
+    cout << "speedup: " << filter_total / generator_total << "x" << endl;
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**
+* @file ur5_batch_bench.cpp
+* @brief Throughput of the batched inverse kinematics over grasp candidates, as a function of the number of threads
+*
+* Usage: ur5_batch_bench [number of poses] [maximum number of threads]
+*/
+
+#include "kinematics_lib/ur5_batch.h"
+#include "kinematics_lib/ur5_kinematics.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : max(8u, thread::hardware_concurrency());
+    int repetitions = 5;
+
+    // Grasp candidates: yaw angles and approach heights around blocks detected on the table,
+    // world coordinates converted to the UR5 frame as done by the FSM
+    mt19937 gen(42);
+    uniform_real_distribution<double> wx_dist(0.2, 0.8);
+    uniform_real_distribution<double> wy_dist(0.35, 0.75);
+    PoseBatch poses;
+    poses.resize(n);
+    int yaw_steps = 36, height_steps = 8;
+    Coordinates pe;
+    for (int i = 0; i < n; i++)
+    {
+        if (i % (yaw_steps * height_steps) == 0)
+            pe << wx_dist(gen) - 0.5, 0.35 - wy_dist(gen), 0;
+
+        double yaw = 2 * M_PI * (i % yaw_steps) / yaw_steps;
+        pe(2) = 0.6 + 0.03 * ((i / yaw_steps) % height_steps);
+        poses.set(i, pe, euler_to_rot(M_PI / 2 + yaw, 0, 0));
+    }
+
+    IkBatchResult result;
+    auto run = [&](ThreadPool *pool) -> double
+    {
+        ur5_inverse_batch(poses, result, pool); // warm up
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++)
+            ur5_inverse_batch(poses, result, pool);
+        auto end = chrono::steady_clock::now();
+        return n * repetitions / chrono::duration<double>(end - start).count();
+    };
+
+    double single = run(nullptr);
+    cout << "poses: " << n << ", hardware threads: " << thread::hardware_concurrency() << endl;
+    cout << "calling thread only: " << single / 1e3 << " kposes/s" << endl;
+
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        ThreadPool pool(threads);
+        double throughput = run(&pool);
+        cout << threads << " worker threads: " << throughput / 1e3 << " kposes/s, scaling " << throughput / single << "x" << endl;
+    }
+
+    long valid = count(result.valid.begin(), result.valid.end(), 1);
+    cout << "valid solutions: " << valid << " / " << result.valid.size() << endl;
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+* @file ur5_inverse_bench.cpp
+* @brief Benchmark of the branch-parallel inverse kinematics against ur5_inverse_complete
+*
+* Build the package in Release mode (catkin_make -DCMAKE_BUILD_TYPE=Release) before running it.
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Difference between two angles, mapped between 0 and pi
+ */
+static double angle_distance(double a, double b)
+{
+    double d = a - b;
+    return fabs(atan2(sin(d), cos(d)));
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 20000;
+    int repetitions = 10;
+
+    // Random reachable poses, computed with direct kinematics
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI, M_PI);
+    vector<Coordinates> positions(n);
+    vector<RotationMatrix> rotations(n);
+    for (int i = 0; i < n; i++)
+    {
+        JointStateVector th;
+        for (int j = 0; j < 6; j++)
+            th(j) = joint_dist(gen);
+        ur5_direct(th, positions[i], rotations[i]);
+    }
+
+    // Check that the two solvers return the same solutions
+    double max_error = 0;
+    int nan_mismatch = 0;
+    for (int i = 0; i < n; i++)
+    {
+        Eigen::Matrix<double, 8, 6> ref = ur5_inverse_complete(positions[i], rotations[i]);
+        Eigen::Matrix<double, 8, 6> res = ur5_inverse_complete_simd(positions[i], rotations[i]);
+        for (int k = 0; k < 48; k++)
+        {
+            if (isnan(ref(k)) != isnan(res(k)))
+                nan_mismatch++;
+            else if (isfinite(ref(k)))
+                max_error = max(max_error, angle_distance(ref(k), res(k)));
+        }
+    }
+
+    // Time the two solvers
+    double checksum = 0;
+    auto time_solver = [&](Eigen::Matrix<double, 8, 6> (*solver)(const Coordinates &, const RotationMatrix &)) -> double
+    {
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++)
+            for (int i = 0; i < n; i++)
+                checksum += solver(positions[i], rotations[i])(0, 0);
+        auto end = chrono::steady_clock::now();
+        return chrono::duration<double, nano>(end - start).count() / (n * repetitions);
+    };
+
+    double scalar_ns = time_solver(ur5_inverse_complete);
+    double simd_ns = time_solver(ur5_inverse_complete_simd);
+
+    cout << "poses: " << n << ", repetitions: " << repetitions << endl;
+    cout << "ur5_inverse_complete:      " << scalar_ns << " ns/call" << endl;
+    cout << "ur5_inverse_complete_simd: " << simd_ns << " ns/call" << endl;
+    cout << "speedup: " << scalar_ns / simd_ns << "x" << endl;
+    cout << "max angle difference: " << max_error << " rad, NaN mismatches: " << nan_mismatch << endl;
+    cout << "(checksum " << checksum << ")" << endl;
+
+    return nan_mismatch == 0 && max_error < 1e-9 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+/**
+* @file ur5_singularity_bench.cpp
+* @brief Benchmark of the analytic singularity check against the jacobian determinant and SVD of the path validation
+*
+* Build the package in Release mode (catkin_make -DCMAKE_BUILD_TYPE=Release) before running it.
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include <Eigen/SVD>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+static const double threshold = 0.00001;
+
+/**
+ * Singularity check of the previous path validation: determinant and dynamic size SVD of the jacobian
+ */
+static bool svd_is_singular(const JointStateVector &th)
+{
+    Eigen::Matrix<double, 6, 6> jac = ur5_jacobian(th);
+    if (abs(jac.determinant()) < threshold)
+        return true;
+    // The QR preconditioner only applies to rectangular matrices
+    Eigen::JacobiSVD<Eigen::MatrixXd, Eigen::NoQRPreconditioner> svd(jac, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    return abs(svd.singularValues()(5)) < threshold;
+}
+
+static bool analytic_is_singular(const JointStateVector &th)
+{
+    return ur5_is_singular(JointTrig(th), threshold);
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+
+    // Random configurations, a quarter of them close to a singularity (elbow, wrist or shoulder)
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI, M_PI);
+    uniform_real_distribution<double> near_dist(-1e-4, 1e-4);
+    vector<JointStateVector> configurations(n);
+    for (int i = 0; i < n; i++)
+    {
+        JointStateVector &th = configurations[i];
+        for (int j = 0; j < 6; j++)
+            th(j) = joint_dist(gen);
+        switch (i % 8)
+        {
+        case 0:
+            th(2) = near_dist(gen);
+            break;
+        case 1:
+            th(4) = M_PI + near_dist(gen);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Check that the two tests reject the same configurations
+    int mismatch = 0, singular = 0;
+    double max_det_error = 0;
+    for (int i = 0; i < n; i++)
+    {
+        bool ref = svd_is_singular(configurations[i]);
+        if (ref != analytic_is_singular(configurations[i]))
+            mismatch++;
+        singular += ref;
+        max_det_error = max(max_det_error, fabs(ur5_jacobian(configurations[i]).determinant() - ur5_singularity(configurations[i]).det));
+    }
+
+    // Time the two tests
+    int rejected = 0;
+    auto time_check = [&](bool (*check)(const JointStateVector &)) -> double
+    {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < n; i++)
+            rejected += check(configurations[i]);
+        auto end = chrono::steady_clock::now();
+        return chrono::duration<double, nano>(end - start).count() / n;
+    };
+
+    double svd_ns = time_check(svd_is_singular);
+    double analytic_ns = time_check(analytic_is_singular);
+
+    cout << "configurations: " << n << ", singular: " << singular << endl;
+    cout << "determinant + SVD: " << svd_ns << " ns/check" << endl;
+    cout << "analytic:          " << analytic_ns << " ns/check" << endl;
+    cout << "speedup: " << svd_ns / analytic_ns << "x" << endl;
+    cout << "max determinant difference: " << max_det_error << ", decision mismatches: " << mismatch << endl;
+    cout << "(rejected " << rejected << ")" << endl;
+
+    return mismatch == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+/**
+* @file ur_model_bench.cpp
+* @brief Benchmark of the kinematics specialized on the constexpr UR5 model against run time DH parameters,
+* plus a direct/inverse round trip check for every supported arm
+*/
+
+#include "kinematics_lib/ur_kinematics.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+/**
+ * UR5 model whose DH parameters are read at run time (e.g. loaded from a configuration file)
+ */
+struct RuntimeUR5
+{
+    static double params[6];
+    static double d1() { return params[0]; }
+    static double a2() { return params[1]; }
+    static double a3() { return params[2]; }
+    static double d4() { return params[3]; }
+    static double d5() { return params[4]; }
+    static double d6() { return params[5]; }
+};
+
+double RuntimeUR5::params[6];
+
+template <typename F>
+double time_ns(int n, int repetitions, F f)
+{
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+        for (int i = 0; i < n; i++)
+            f(i);
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(end - start).count() / (n * repetitions);
+}
+
+/**
+ * Maximum position error of direct(inverse(direct(q))) over the exact IK solutions
+ */
+template <typename Model>
+double round_trip_error(const vector<JointStateVector> &joints)
+{
+    double max_error = 0;
+    for (const auto &q : joints)
+    {
+        RigidTransform t = ur_direct<Model>(q);
+        Eigen::Array<bool, 8, 1> exact;
+        Eigen::Matrix<double, 8, 6> ik = ur_inverse_complete<Model>(t.pos, t.rot, exact);
+        for (int b = 0; b < 8; b++)
+        {
+            if (!exact(b))
+                continue;
+            RigidTransform t_ik = ur_direct<Model>(ik.row(b).transpose());
+            max_error = max(max_error, (t_ik.pos - t.pos).norm() + (t_ik.rot - t.rot).norm());
+        }
+    }
+    return max_error;
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 10000;
+    int repetitions = 10;
+
+    double ur5e_params[6] = {UR5e::d1(), UR5e::a2(), UR5e::a3(), UR5e::d4(), UR5e::d5(), UR5e::d6()};
+    for (int i = 0; i < 6; i++)
+        RuntimeUR5::params[i] = ur5e_params[i];
+
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI, M_PI);
+    vector<JointStateVector> joints(n);
+    vector<RigidTransform> poses(n);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < 6; j++)
+            joints[i](j) = joint_dist(gen);
+        poses[i] = ur_direct<UR5e>(joints[i]);
+    }
+
+    double checksum = 0;
+    Eigen::Array<bool, 8, 1> exact;
+
+    double fk_chain = time_ns(n, repetitions, [&](int i) {
+        const JointStateVector &th = joints[i];
+        RigidTransform t = ur_t10<RuntimeUR5>(th(0)) * ur_t21<RuntimeUR5>(th(1)) * ur_t32<RuntimeUR5>(th(2)) *
+            ur_t43<RuntimeUR5>(th(3)) * ur_t54<RuntimeUR5>(th(4)) * ur_t65<RuntimeUR5>(th(5));
+        checksum += t.pos(0);
+    });
+    double fk_runtime = time_ns(n, repetitions, [&](int i) { checksum += ur_direct<RuntimeUR5>(joints[i]).pos(0); });
+    double fk_constexpr = time_ns(n, repetitions, [&](int i) { checksum += ur_direct<UR5e>(joints[i]).pos(0); });
+
+    double jac_runtime = time_ns(n, repetitions, [&](int i) { checksum += ur_jacobian<RuntimeUR5>(joints[i])(0, 0); });
+    double jac_constexpr = time_ns(n, repetitions, [&](int i) { checksum += ur_jacobian<UR5e>(joints[i])(0, 0); });
+
+    double ik_runtime = time_ns(n, repetitions, [&](int i) { checksum += ur_inverse_complete<RuntimeUR5>(poses[i].pos, poses[i].rot, exact)(0, 0); });
+    double ik_constexpr = time_ns(n, repetitions, [&](int i) { checksum += ur_inverse_complete<UR5e>(poses[i].pos, poses[i].rot, exact)(0, 0); });
+
+    cout << "configurations: " << n << ", repetitions: " << repetitions << endl;
+    cout << "direct, DH link chain (run time DH): " << fk_chain << " ns" << endl;
+    cout << "direct, closed form   (run time DH): " << fk_runtime << " ns, speedup over the link chain " << fk_chain / fk_runtime << "x" << endl;
+    cout << "direct, closed form   (UR5e model):  " << fk_constexpr << " ns, speedup " << fk_runtime / fk_constexpr << "x" << endl;
+    cout << "jacobian (run time DH): " << jac_runtime << " ns" << endl;
+    cout << "jacobian (UR5e model):  " << jac_constexpr << " ns, speedup " << jac_runtime / jac_constexpr << "x" << endl;
+    cout << "inverse complete (run time DH): " << ik_runtime << " ns" << endl;
+    cout << "inverse complete (UR5e model):  " << ik_constexpr << " ns, speedup " << ik_runtime / ik_constexpr << "x" << endl;
+
+    cout << "round trip error UR3:  " << round_trip_error<UR3>(joints) << endl;
+    cout << "round trip error UR5:  " << round_trip_error<UR5>(joints) << endl;
+    cout << "round trip error UR10: " << round_trip_error<UR10>(joints) << endl;
+    cout << "round trip error UR5e: " << round_trip_error<UR5e>(joints) << endl;
+    cout << "(checksum " << checksum << ")" << endl;
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+* @file ur_trig_bench.cpp
+* @brief Accuracy against throughput of the kinematics templates for every scalar type and trigonometric policy
+*
+* For each variant (double or float, libm or polynomial trigonometry) the benchmark measures the direct and the
+* complete inverse kinematics per second, and the errors against the double precision libm reference:
+* the trigonometric functions alone, the direct kinematics, and the round trip IK(FK(q)) checked with the reference FK
+* (pose error of the exact solutions, joint error of the solution closest to q). The joint error is only measured away
+* from the singular configurations, where the single precision joints are ill conditioned.
+* Build the package in Release mode (catkin_make -DCMAKE_BUILD_TYPE=Release) before running it.
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/ur_singularity.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+struct VariantResult
+{
+    double sincos_error; // maximum absolute error of sin and cos
+    double atan2_error;
+    double fk_rate; // direct kinematics per second
+    double ik_rate; // complete inverse kinematics per second
+    double fk_position_error; // maximum, m
+    double fk_rotation_error; // maximum, rad
+    double ik_position_error; // maximum over the exact solutions, m
+    double ik_rotation_error; // rad
+    double ik_joint_error; // maximum over the regular configurations of the closest exact solution, rad
+    long exact_rows;
+};
+
+/**
+ * Angle of the rotation between two rotation matrices (atan2 form, accurate for small angles)
+ */
+double rotation_error(const RotationMatrix &a, const RotationMatrix &b)
+{
+    RotationMatrix r = a.transpose() * b;
+    Coordinates axis(r(2, 1) - r(1, 2), r(0, 2) - r(2, 0), r(1, 0) - r(0, 1));
+    return atan2(axis.norm() / 2, (r.trace() - 1) / 2);
+}
+
+template <typename Scalar, typename Trig>
+VariantResult run_variant(const vector<JointStateVector> &joints, const vector<RigidTransform> &poses, int repetitions)
+{
+    int n = joints.size();
+    VariantResult result = {};
+
+    // Trigonometric functions over the range of the joints, against libm in double precision
+    mt19937 gen(7);
+    uniform_real_distribution<double> angle(-2 * M_PI, 2 * M_PI);
+    for (int i = 0; i < 1000000; i++)
+    {
+        Scalar x = angle(gen), y = angle(gen);
+        Scalar s, c;
+        Trig::sincos(x, s, c);
+        result.sincos_error = max(result.sincos_error, max(fabs(s - sin((double)x)), fabs(c - cos((double)x))));
+        result.atan2_error = max(result.atan2_error, fabs(Trig::atan2(y, x) - atan2((double)y, (double)x)));
+    }
+
+    vector<JointStateVectorT<Scalar>> joints_s(n);
+    vector<RigidTransformT<Scalar>> poses_s(n);
+    for (int i = 0; i < n; i++)
+    {
+        joints_s[i] = joints[i].cast<Scalar>();
+        poses_s[i] = poses[i].cast<Scalar>();
+    }
+
+    // Throughput
+    double checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+        for (int i = 0; i < n; i++)
+            checksum += ur_direct<UR5Model, Trig>(joints_s[i]).pos(0);
+    result.fk_rate = (double)n * repetitions / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    Eigen::Array<bool, 8, 1> exact;
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+        for (int i = 0; i < n; i++)
+            checksum += ur_inverse_complete<UR5Model, Trig>(poses_s[i].pos, poses_s[i].rot, exact)(0, 0);
+    result.ik_rate = (double)n * repetitions / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Accuracy
+    for (int i = 0; i < n; i++)
+    {
+        RigidTransform fk = ur_direct<UR5Model, Trig>(joints_s[i]).template cast<double>();
+        result.fk_position_error = max(result.fk_position_error, (fk.pos - poses[i].pos).norm());
+        result.fk_rotation_error = max(result.fk_rotation_error, rotation_error(fk.rot, poses[i].rot));
+
+        Eigen::Matrix<Scalar, 8, 6> ik = ur_inverse_complete<UR5Model, Trig>(poses_s[i].pos, poses_s[i].rot, exact);
+        UrSingularity sing = ur_singularity<UR5Model>(JointTrig(joints[i]));
+        bool regular = fabs(sing.shoulder) > 0.05 && fabs(sing.elbow) > 0.05 && fabs(sing.wrist) > 0.05;
+        double closest = -1;
+        for (int b = 0; b < 8; b++)
+        {
+            if (!exact(b))
+                continue;
+            result.exact_rows++;
+            JointStateVector q = ik.row(b).transpose().template cast<double>();
+            RigidTransform t = ur_direct<UR5Model>(q);
+            result.ik_position_error = max(result.ik_position_error, (t.pos - poses[i].pos).norm());
+            result.ik_rotation_error = max(result.ik_rotation_error, rotation_error(t.rot, poses[i].rot));
+
+            double joint_error = 0;
+            for (int j = 0; j < 6; j++)
+            {
+                double d = q(j) - joints[i](j);
+                joint_error = max(joint_error, fabs(atan2(sin(d), cos(d))));
+            }
+            closest = closest < 0 ? joint_error : min(closest, joint_error);
+        }
+        if (regular)
+            result.ik_joint_error = max(result.ik_joint_error, closest);
+    }
+
+    if (checksum == 42)
+        cout << "(checksum)" << endl;
+    return result;
+}
+
+void print_variant(const string &name, const VariantResult &r, const VariantResult &reference)
+{
+    cout << setw(14) << left << name << right << setprecision(3)
+         << setw(10) << r.sincos_error << setw(10) << r.atan2_error
+         << setw(9) << r.fk_rate / 1e6 << setw(8) << r.fk_rate / reference.fk_rate << "x"
+         << setw(9) << r.ik_rate / 1e6 << setw(8) << r.ik_rate / reference.ik_rate << "x"
+         << setw(10) << r.fk_position_error << setw(10) << r.fk_rotation_error
+         << setw(10) << r.ik_position_error << setw(10) << r.ik_rotation_error << setw(10) << r.ik_joint_error
+         << setw(8) << r.exact_rows - reference.exact_rows << endl;
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 10000;
+    int repetitions = argc > 2 ? atoi(argv[2]) : 10;
+
+    mt19937 gen(42);
+    uniform_real_distribution<double> joint_dist(-M_PI, M_PI);
+    vector<JointStateVector> joints(n);
+    vector<RigidTransform> poses(n);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < 6; j++)
+            joints[i](j) = joint_dist(gen);
+        poses[i] = ur_direct<UR5Model>(joints[i]);
+    }
+
+    VariantResult double_libm = run_variant<double, LibmTrig>(joints, poses, repetitions);
+    VariantResult double_poly = run_variant<double, PolyTrig>(joints, poses, repetitions);
+    VariantResult float_libm = run_variant<float, LibmTrig>(joints, poses, repetitions);
+    VariantResult float_poly = run_variant<float, PolyTrig>(joints, poses, repetitions);
+
+    cout << "configurations: " << n << ", repetitions: " << repetitions << endl;
+    cout << "errors against double/libm (m, rad); rates in M/s; ik errors of the exact solutions, joint error of the closest one" << endl;
+    cout << setw(14) << left << "variant" << right << setw(10) << "sincos" << setw(10) << "atan2"
+         << setw(18) << "fk rate" << setw(18) << "ik rate"
+         << setw(10) << "fk pos" << setw(10) << "fk rot" << setw(10) << "ik pos" << setw(10) << "ik rot" << setw(10) << "ik joint"
+         << setw(8) << "exact" << endl;
+    print_variant("double/libm", double_libm, double_libm);
+    print_variant("double/poly", double_poly, double_libm);
+    print_variant("float/libm", float_libm, double_libm);
+    print_variant("float/poly", float_poly, double_libm);
+    cout << "(exact: solutions gained or lost against double/libm, the near singular configurations change branch validity)" << endl;
+
+    return 0;
+}
\ No newline at end of file
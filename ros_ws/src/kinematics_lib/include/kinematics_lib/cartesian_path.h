@@ -0,0 +1,96 @@
+/**
+* @file cartesian_path.h
+* @brief Header file for the straight line paths of the end effector and the differential inverse kinematics of the ur5
+*
+* @date 17/10/2026
+*/
+
+#ifndef __CARTESIAN_PATH_H__
+#define __CARTESIAN_PATH_H__
+
+#include "kinematics_lib/kinematics_types.h"
+
+/**
+ * Velocity of the end effector: linear velocity (first three elements) and angular velocity, in the base frame
+ */
+typedef Eigen::Matrix<double, 6, 1> Twist;
+
+/**
+ * @brief Straight line of the end effector between two poses: the position moves along the segment and the rotation
+ * about the fixed axis of the relative rotation, with the same quintic time law (zero velocity and acceleration at the ends).
+ * The duration is the shortest one within the linear and angular velocity limits.
+ * @class CartesianPath
+ */
+class CartesianPath
+{
+private:
+    Coordinates start_pos;
+    Coordinates delta_pos;
+    RotationMatrix start_rot;
+    Coordinates axis; // of the relative rotation, in the base frame
+    double angle;
+    double duration;
+
+    /**
+     * Quintic time law, the path parameter from 0 to 1 and its time derivative
+     */
+    void time_law(double t, double &s, double &ds) const;
+
+public:
+    /**
+     * Constructor
+     * 
+     * @param start The initial pose of the end effector
+     * @param goal The final pose of the end effector
+     * @param max_linear_velocity Maximum speed of the end effector (m/s)
+     * @param max_angular_velocity Maximum angular speed of the end effector (rad/s)
+     */
+    CartesianPath(const RigidTransform &start, const RigidTransform &goal, double max_linear_velocity, double max_angular_velocity);
+
+    /**
+     * @return The duration of the motion (s)
+     */
+    double get_duration(void) const;
+
+    /**
+     * @param t The time from the start of the motion, clamped to [0, duration]
+     * @return The pose of the end effector at time t
+     */
+    RigidTransform pose(double t) const;
+
+    /**
+     * @param t The time from the start of the motion
+     * @return The velocity of the end effector at time t
+     */
+    Twist twist(double t) const;
+};
+
+/**
+ * Pose error between a desired pose and the current one: position difference and rotation vector (axis times angle)
+ * of the relative rotation, in the base frame
+ * 
+ * @param desired The desired pose
+ * @param current The current pose
+ * @return The error, zero if the poses coincide
+ */
+Twist pose_error(const RigidTransform &desired, const RigidTransform &current);
+
+/**
+ * One step of the damped least squares differential inverse kinematics of the ur5 with the analytic jacobian:
+ * the velocity of the desired pose plus a correction of the pose error is mapped to the joint velocities
+ * dq = J^T (J J^T + damping^2 I)^-1 (twist + gain * error), integrated over the step.
+ * The damping bounds the joint velocities near the singularities.
+ * 
+ * @param th The current joints configuration, the initial guess of the step
+ * @param desired The desired pose of the end effector at the end of the step
+ * @param twist The desired velocity of the end effector (feed-forward)
+ * @param dt The duration of the step (s)
+ * @param gain The gain of the pose error correction (1/s)
+ * @param damping The damping factor
+ * @param error output - optional, the pose error of the current configuration
+ * @return The joints configuration at the end of the step
+ */
+JointStateVector ur5_differential_ik(const JointStateVector &th, const RigidTransform &desired, const Twist &twist, double dt,
+    double gain, double damping, Twist *error = nullptr);
+
+#endif
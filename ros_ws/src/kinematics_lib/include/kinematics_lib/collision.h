@@ -0,0 +1,360 @@
+/**
+* @file collision.h
+* @brief Header file for the collision model of the UR5 (capsules of the links) and of the static scene of the workcell
+*
+* @date 17/10/2026
+*/
+
+#ifndef __COLLISION_H__
+#define __COLLISION_H__
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "kinematics_lib/kinematics_types.h"
+
+/**
+ * @brief Axis aligned bounding box
+ */
+struct AABB
+{
+    Coordinates min;
+    Coordinates max;
+
+    bool overlaps(const AABB &other) const
+    {
+        return (min.array() <= other.max.array()).all() && (other.min.array() <= max.array()).all();
+    }
+
+    AABB merge(const AABB &other) const
+    {
+        return {min.cwiseMin(other.min), max.cwiseMax(other.max)};
+    }
+};
+
+/**
+ * @brief Segment with a radius: the points closer than radius to the segment ab. A sphere has a == b.
+ */
+struct Capsule
+{
+    Coordinates a;
+    Coordinates b;
+    double radius;
+
+    AABB bounds(void) const
+    {
+        Coordinates r = Coordinates::Constant(radius);
+        return {a.cwiseMin(b) - r, a.cwiseMax(b) + r};
+    }
+};
+
+/**
+ * @brief Oriented box: center, axes (columns of rot) and half extents along the axes
+ */
+struct OrientedBox
+{
+    Coordinates center;
+    RotationMatrix rot;
+    Coordinates half_extents;
+
+    AABB bounds(void) const
+    {
+        Coordinates extent = rot.cwiseAbs() * half_extents;
+        return {center - extent, center + extent};
+    }
+};
+
+/**
+ * Minimum distance between two segments
+ *
+ * @return The distance between the closest points of p0p1 and q0q1
+ */
+double segment_distance(const Coordinates &p0, const Coordinates &p1, const Coordinates &q0, const Coordinates &q1);
+
+/**
+ * Minimum distance between a segment and a box, 0 if they intersect.
+ * The distance from the box is convex along the segment, its minimum is found by golden section search.
+ *
+ * @param tolerance If positive the search stops earlier, and the result is a lower bound within tolerance of the distance
+ * @return The distance between the closest points of p0p1 and the box
+ */
+double segment_box_distance(const Coordinates &p0, const Coordinates &p1, const OrientedBox &box, double tolerance = 0);
+
+/**
+ * @return true if the capsules intersect
+ */
+bool collide(const Capsule &first, const Capsule &second);
+
+/**
+ * @return true if the capsule and the box intersect
+ */
+bool collide(const Capsule &capsule, const OrientedBox &box);
+
+/**
+ * @brief Static bounding volume hierarchy of a set of boxes, built top down by splitting at the median center
+ * along the longest axis. The leaves are the indexes of the boxes.
+ * @class AABBTree
+ */
+class AABBTree
+{
+private:
+    /**
+     * Node of the tree: a leaf has item >= 0, an inner node has two children
+     */
+    struct TreeNode
+    {
+        AABB bounds;
+        int left, right;
+        int item;
+    };
+
+    std::vector<TreeNode> nodes;
+
+    int build(std::vector<std::pair<AABB, int>> &items, int first, int last);
+
+public:
+    /**
+     * Build the tree
+     *
+     * @param bounds The boxes, the index of a box is the item reported by the queries
+     */
+    void build(const std::vector<AABB> &bounds);
+
+    /**
+     * Visit the items whose box overlaps the query box, until the visitor returns true
+     *
+     * @param query The query box
+     * @param visit Called with the index of every overlapping item, returns true to stop the query
+     * @return true if the query was stopped by the visitor
+     */
+    template <typename Visitor>
+    bool query(const AABB &query, Visitor visit) const
+    {
+        if (nodes.empty())
+            return false;
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const TreeNode &node = nodes[stack[--top]];
+            if (!node.bounds.overlaps(query))
+                continue;
+            if (node.item >= 0)
+            {
+                if (visit(node.item))
+                    return true;
+            }
+            else
+            {
+                stack[top++] = node.left;
+                stack[top++] = node.right;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @return The number of nodes of the tree
+     */
+    int size(void) const;
+};
+
+/**
+ * Links of the UR5 as capsules: shoulder, upper arm, forearm, the three wrists and the gripper along the tool axis
+ */
+typedef std::array<Capsule, 7> UR5LinkCapsules;
+
+/**
+ * One distance for every link of the UR5, in the order of UR5LinkCapsules
+ */
+typedef std::array<double, 7> UR5LinkDistances;
+
+/**
+ * Clearance of a configuration for the continuous checks
+ *
+ * @param th The six joints values (angles)
+ * @param clearance output - distance of every link from the obstacles and the constraints, valid only if the configuration is
+ * @return false if the configuration is not valid
+ */
+typedef std::function<bool(const JointStateVector &th, UR5LinkDistances &clearance)> ClearanceFunction;
+
+/**
+ * Compute the capsules of the UR5 links from the DH chain of the direct kinematics
+ *
+ * @param th The six joints values (angles)
+ * @param gripper_length The length of the gripper capsule from the flange, along the tool axis
+ * @param gripper_radius The radius of the gripper capsule
+ * @return The capsules in the base frame
+ */
+UR5LinkCapsules ur5_link_capsules(const JointStateVector &th, double gripper_length, double gripper_radius);
+
+/**
+ * @brief Static obstacles of the UR5 workcell (boxes and capsules) with a broadphase on their bounding boxes.
+ * The scene is loaded from a text file, one obstacle per line (base frame of the UR5, meters and radians):
+ *
+ *     box <name> <x> <y> <z> <roll> <pitch> <yaw> <half x> <half y> <half z>
+ *     capsule <name> <ax> <ay> <az> <bx> <by> <bz> <radius>
+ *     sphere <name> <x> <y> <z> <radius>
+ *     gripper <length> <radius>
+ *     padding <distance>
+ *     grasp <name>
+ *
+ * Empty lines and lines starting with # are ignored. The padding inflates the links of the robot.
+ * The gripper may touch the grasp obstacles in the checks of the grasping motions, to reach the objects lying on them;
+ * the other links are always checked against every obstacle.
+ * @class CollisionScene
+ */
+class CollisionScene
+{
+private:
+    std::vector<OrientedBox> boxes;
+    std::vector<Capsule> capsules;
+    std::vector<std::string> names; // boxes first, then capsules
+    std::vector<std::string> grasp_names;
+    std::vector<bool> graspable; // items: boxes first, then capsules
+    AABBTree tree; // items: boxes first, then capsules
+    double gripper_length;
+    double gripper_radius;
+    double padding;
+
+    /**
+     * Narrow phase of an obstacle
+     */
+    bool collide_item(const Capsule &link, int item) const;
+
+    /**
+     * Distance between a link and an obstacle, negative or 0 if they intersect.
+     * Above max_distance only a lower bound is computed.
+     */
+    double distance_item(const Capsule &link, int item, double max_distance) const;
+
+    /**
+     * Distance from the axis of every joint (rows) of the points of every link (columns), bounded by the chain lengths
+     */
+    std::array<UR5LinkDistances, 6> sweep_radius;
+
+    /**
+     * Compute sweep_radius from the chain of the zero configuration, the gripper and the padding
+     */
+    void update_sweep_radius(void);
+
+public:
+    /**
+     * Constructor. Empty scene, no gripper capsule.
+     */
+    CollisionScene();
+
+    /**
+     * Read the obstacles and the robot from a scene file and build the broadphase, they replace the previous ones.
+     * The scene is unchanged if the file cannot be loaded.
+     *
+     * @param file The path of the scene file
+     * @return false if the file cannot be read or a line is not valid
+     */
+    bool load(const std::string &file);
+
+    /**
+     * Add obstacles, build() must be called before the next check
+     */
+    void add_box(const std::string &name, const OrientedBox &box);
+    void add_capsule(const std::string &name, const Capsule &capsule);
+
+    /**
+     * Let the gripper touch the obstacles with the given name in the grasping motions, build() must be called before the next check
+     */
+    void allow_grasp(const std::string &name);
+
+    /**
+     * Size of the gripper capsule and inflation of the robot links
+     */
+    void set_robot(double gripper_length, double gripper_radius, double padding);
+
+    /**
+     * Build the broadphase of the obstacles
+     */
+    void build(void);
+
+    /**
+     * @return true if the scene has no obstacles
+     */
+    bool empty(void) const;
+
+    /**
+     * @return The number of obstacles
+     */
+    int size(void) const;
+
+    /**
+     * Check the links against the obstacles
+     *
+     * @param links The capsules of the links, in the base frame
+     * @param broadphase If false every link is tested against every obstacle (reference for the benchmarks)
+     * @param grasping If true the gripper is not checked against the grasp obstacles
+     * @return The index of the first obstacle hit, -1 if there are no collisions
+     */
+    int first_collision(const UR5LinkCapsules &links, bool broadphase = true, bool grasping = false) const;
+
+    /**
+     * @param th The six joints values (angles)
+     * @return The capsules of the links of the UR5 with the gripper of the scene, in the base frame
+     */
+    UR5LinkCapsules robot_links(const JointStateVector &th) const;
+
+    /**
+     * Check a configuration of the UR5 against the obstacles
+     *
+     * @param th The six joints values (angles)
+     * @param grasping If true the gripper is not checked against the grasp obstacles
+     * @return true if a link or the gripper intersects an obstacle
+     */
+    bool in_collision(const JointStateVector &th, bool grasping = false) const;
+
+    /**
+     * Distance of every link (inflated by the padding) from the nearest obstacle.
+     * Only the obstacles within max_distance are visited, farther ones are reported as max_distance.
+     *
+     * @param th The six joints values (angles)
+     * @param max_distance The largest distance of interest
+     * @return The distances, negative or 0 if the link intersects an obstacle
+     */
+    UR5LinkDistances clearance(const JointStateVector &th, double max_distance) const;
+
+    /**
+     * Upper bound of the displacement of every point of the links (inflated by the padding) along a straight motion
+     * in the joints space. A joint moves a point by at most its distance from the joint axis times the joint change,
+     * and that distance is bounded by the lengths of the chain between the axis and the point.
+     *
+     * @param delta The change of the joints along the motion
+     * @return The displacement bound of every link
+     */
+    UR5LinkDistances motion_bound(const JointStateVector &delta) const;
+
+    /**
+     * Continuous check of the straight motion between two configurations, by conservative advancement:
+     * a segment is safe when, for every link, the clearances at its ends exceed the displacement bound of the link.
+     * Otherwise it is split at the middle configuration, so the configurations are evaluated only where the clearance
+     * is small. The segments are also split until they are shorter than max_step, for the constraints that are not distances.
+     *
+     * @param from The initial configuration
+     * @param to The final configuration
+     * @param clearance The validity and clearance of a configuration
+     * @param max_step Longest segment accepted without splitting (joints space infinity norm, rad)
+     * @param evaluations output - optional, number of configurations evaluated
+     * @param cancelled Optional flag checked before every configuration, the check stops when it is set
+     * @return true if the whole motion is valid, false if not, if the clearance is too small to prove it or if cancelled
+     */
+    bool check_motion(const JointStateVector &from, const JointStateVector &to, const ClearanceFunction &clearance, double max_step,
+        int *evaluations = nullptr, const std::atomic<bool> *cancelled = nullptr) const;
+
+    /**
+     * @param item The index of an obstacle, as returned by first_collision
+     * @return The name of the obstacle
+     */
+    std::string name(int item) const;
+};
+
+#endif
@@ -0,0 +1,150 @@
+/**
+* @file cubic_trajectory.h
+* @brief Header file for the joint space cubic trajectory, evaluated on demand
+*
+* @date 17/10/2026
+*/
+
+#ifndef __CUBIC_TRAJECTORY_H__
+#define __CUBIC_TRAJECTORY_H__
+
+#include <iterator>
+#include "kinematics_lib/kinematics_types.h"
+#include "kinematics_lib/joint_path.h"
+
+/**
+ * @brief Third degree polynomial between two joints configurations, with zero velocity at both ends.
+ * The trajectory does not store its samples: every configuration is computed when it is accessed.
+ * Sample i of n is the configuration at t = i / (n - 1), so the first sample is the initial configuration
+ * and the last one is the final configuration.
+ * As a geometric path, the path parameter is the normalized time t in [0, 1].
+ * @class CubicTrajectory
+ */
+class CubicTrajectory : public JointPath
+{
+private:
+    JointStateVector initial_joints;
+    JointStateVector delta_joints;
+    int n;
+
+public:
+    /**
+     * @brief Read-only random access iterator over the samples of a trajectory
+     * @class const_iterator
+     */
+    class const_iterator
+    {
+    private:
+        const CubicTrajectory *trajectory;
+        int index;
+
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef JointStateVector value_type;
+        typedef int difference_type;
+        typedef const JointStateVector *pointer;
+        typedef JointStateVector reference;
+
+        const_iterator() : trajectory(nullptr), index(0) {}
+        const_iterator(const CubicTrajectory *trajectory, int index) : trajectory(trajectory), index(index) {}
+
+        JointStateVector operator*() const { return (*trajectory)[index]; }
+        JointStateVector operator[](int i) const { return (*trajectory)[index + i]; }
+
+        const_iterator &operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; ++index; return it; }
+        const_iterator &operator--() { --index; return *this; }
+        const_iterator operator--(int) { const_iterator it = *this; --index; return it; }
+        const_iterator &operator+=(int i) { index += i; return *this; }
+        const_iterator &operator-=(int i) { index -= i; return *this; }
+        const_iterator operator+(int i) const { return const_iterator(trajectory, index + i); }
+        const_iterator operator-(int i) const { return const_iterator(trajectory, index - i); }
+        int operator-(const const_iterator &other) const { return index - other.index; }
+
+        bool operator==(const const_iterator &other) const { return index == other.index; }
+        bool operator!=(const const_iterator &other) const { return index != other.index; }
+        bool operator<(const const_iterator &other) const { return index < other.index; }
+        bool operator>(const const_iterator &other) const { return index > other.index; }
+        bool operator<=(const const_iterator &other) const { return index <= other.index; }
+        bool operator>=(const const_iterator &other) const { return index >= other.index; }
+    };
+
+    /**
+     * @brief Contiguous range of samples of a trajectory, it does not own the trajectory
+     * @class Span
+     */
+    class Span
+    {
+    private:
+        const CubicTrajectory *trajectory;
+        int first;
+        int count;
+
+    public:
+        Span(const CubicTrajectory *trajectory, int first, int count) : trajectory(trajectory), first(first), count(count) {}
+
+        JointStateVector operator[](int i) const { return (*trajectory)[first + i]; }
+        int size() const { return count; }
+        bool empty() const { return count == 0; }
+        const_iterator begin() const { return const_iterator(trajectory, first); }
+        const_iterator end() const { return const_iterator(trajectory, first + count); }
+    };
+
+    /**
+     * Constructor. Compute the coefficients of the third degree polynomial,
+     * q(t) = q0 + (q1 - q0) * (3t^2 - 2t^3) with t in [0, 1]
+     *
+     * @param initial_joints Starting joints configuration
+     * @param final_joints Final joints configuration
+     * @param n Number of configurations sampled along the path
+     */
+    CubicTrajectory(const JointStateVector &initial_joints, const JointStateVector &final_joints, int n)
+        : initial_joints(initial_joints), delta_joints(final_joints - initial_joints), n(n < 0 ? 0 : n) {}
+
+    /**
+     * Evaluate the trajectory
+     *
+     * @param t The normalized time, from 0 (initial configuration) to 1 (final configuration)
+     * @return The joints configuration at time t
+     */
+    JointStateVector at(double t) const
+    {
+        return initial_joints + delta_joints * (t * t * (3 - 2 * t));
+    }
+
+    double length(void) const { return 1.0; }
+    JointStateVector position(double t) const { return at(t); }
+    JointStateVector derivative(double t) const { return delta_joints * (6 * t * (1 - t)); }
+    JointStateVector second_derivative(double t) const { return delta_joints * (6 - 12 * t); }
+
+    /**
+     * @param i The index of the sample, between 0 and size() - 1
+     * @return The normalized time of the sample
+     */
+    double time(int i) const
+    {
+        return n > 1 ? (double)i / (n - 1) : 1.0;
+    }
+
+    /**
+     * @param i The index of the sample, between 0 and size() - 1
+     * @return The joints configuration of the sample
+     */
+    JointStateVector operator[](int i) const { return at(time(i)); }
+
+    int size() const { return n; }
+    bool empty() const { return n == 0; }
+    JointStateVector front() const { return initial_joints; }
+    JointStateVector back() const { return initial_joints + delta_joints; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, n); }
+
+    /**
+     * @param first The index of the first sample
+     * @param count The number of samples
+     * @return A view of count samples starting from first
+     */
+    Span span(int first, int count) const { return Span(this, first, count); }
+};
+
+#endif
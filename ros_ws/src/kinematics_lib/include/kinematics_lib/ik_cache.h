@@ -0,0 +1,111 @@
+/**
+* @file ik_cache.h
+* @brief Header file for the cache of the inverse kinematics solutions, by quantized pose
+*
+* @date 17/10/2026
+*/
+
+#ifndef __IK_CACHE_H__
+#define __IK_CACHE_H__
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "kinematics_lib/kinematics_types.h"
+
+/**
+ * @brief Counters of the cache lookups
+ */
+struct IKCacheStats
+{
+    long hits; // lookups of a cached pose
+    long misses; // lookups of a pose not in the cache
+    long evictions; // least recently used poses removed to make room for a new one
+    int size; // poses in the cache
+};
+
+/**
+ * @brief A cached pose and its inverse kinematics solutions
+ */
+struct IKCacheEntry
+{
+    Coordinates pos; // the pose solved, within the quantization of the requested one
+    RotationMatrix rot;
+    std::vector<JointStateVector> solutions;
+};
+
+/**
+ * @brief Least recently used cache of the inverse kinematics solutions. The key of a pose is its position and the unit
+ * quaternion of its rotation, quantized: poses closer than the resolution share the entry, whose exact pose is kept
+ * to refine the solutions. The cache is thread safe.
+ * @class IKCache
+ */
+class IKCache
+{
+private:
+    typedef std::array<int32_t, 7> Key;
+
+    /**
+     * Hash of the quantized pose
+     */
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    typedef std::list<std::pair<Key, IKCacheEntry>> EntryList;
+
+    int capacity;
+    double position_resolution;
+    double rotation_resolution;
+    EntryList entries; // most recently used first
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+    IKCacheStats stats;
+    mutable std::mutex mutex;
+
+    Key quantize(const Coordinates &pos, const RotationMatrix &rot) const;
+
+public:
+    /**
+     * Constructor
+     * 
+     * @param capacity The maximum number of cached poses
+     * @param position_resolution The quantization step of the position (m)
+     * @param rotation_resolution The quantization step of the quaternion components
+     */
+    IKCache(int capacity = 256, double position_resolution = 0.001, double rotation_resolution = 0.001);
+
+    /**
+     * Look up a pose, the entry found becomes the most recently used
+     * 
+     * @param pos The position of the end effector
+     * @param rot The rotation of the end effector
+     * @param entry output - the cached pose and solutions
+     * @return true if the pose is cached
+     */
+    bool find(const Coordinates &pos, const RotationMatrix &rot, IKCacheEntry &entry);
+
+    /**
+     * Add or replace the solutions of a pose, the least recently used pose is removed when the cache is full
+     * 
+     * @param pos The position of the end effector
+     * @param rot The rotation of the end effector
+     * @param solutions The inverse kinematics solutions
+     */
+    void insert(const Coordinates &pos, const RotationMatrix &rot, const std::vector<JointStateVector> &solutions);
+
+    /**
+     * Remove all the poses, the counters are kept
+     */
+    void clear(void);
+
+    /**
+     * @return The counters of the lookups
+     */
+    IKCacheStats get_stats(void) const;
+};
+
+#endif
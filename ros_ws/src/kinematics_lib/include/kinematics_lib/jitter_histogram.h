@@ -0,0 +1,81 @@
+/**
+* @file jitter_histogram.h
+* @brief Header file for the histogram of the wake-up latencies of a periodic real-time loop
+*
+* @date 17/10/2026
+*/
+
+#ifndef __JITTER_HISTOGRAM_H__
+#define __JITTER_HISTOGRAM_H__
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Summary of the latencies recorded by a JitterHistogram
+ */
+struct JitterStats
+{
+    long cycles; // cycles recorded
+    long overruns; // cycles that started one period or more after their deadline, their deadlines were skipped
+    double max_latency; // seconds
+    double p50_latency; // upper bound of the bin of the median, seconds
+    double p99_latency;
+    double p999_latency;
+};
+
+/**
+ * @brief Histogram of the latency of every cycle of a periodic loop: time between the deadline of the cycle and the
+ * instant the loop woke up. The bins have a fixed width, the last one collects the latencies beyond the range.
+ * A single thread records (wait-free, no allocations, safe in the real-time loop) and any thread reads the counts.
+ * @class JitterHistogram
+ */
+class JitterHistogram
+{
+private:
+    double bin_width;
+    int n_bins;
+    std::unique_ptr<std::atomic<long>[]> counts; // n_bins + 1, the last one is the overflow bin
+    std::atomic<long> overruns;
+    std::atomic<double> max_latency;
+
+    /**
+     * @return The upper bound of the bin reached by the fraction q of the counts, in seconds
+     */
+    double quantile(const std::vector<long> &bins, long total, double q) const;
+
+public:
+    /**
+     * Constructor. Every count is zero.
+     *
+     * @param bin_width The width of a bin, in seconds
+     * @param n_bins The number of bins, the range covered is [0, n_bins * bin_width)
+     */
+    JitterHistogram(double bin_width = 10e-6, int n_bins = 100);
+
+    JitterHistogram(const JitterHistogram &) = delete;
+    JitterHistogram &operator=(const JitterHistogram &) = delete;
+
+    /**
+     * Count the latency of a cycle, from the recording thread only
+     *
+     * @param latency Seconds between the deadline and the start of the cycle
+     * @param overrun The cycle was so late that the following deadlines have been skipped
+     */
+    void record(double latency, bool overrun = false);
+
+    /**
+     * @return The counts of the bins, the last element is the count of the latencies beyond the range
+     */
+    std::vector<long> bins(void) const;
+
+    /**
+     * @return The number of cycles, the overruns and the quantiles of the latency
+     */
+    JitterStats stats(void) const;
+
+    double get_bin_width(void) const;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/**
+* @file joint_path.h
+* @brief Header file for the geometric paths in the joints space
+*
+* @date 17/10/2026
+*/
+
+#ifndef __JOINT_PATH_H__
+#define __JOINT_PATH_H__
+
+#include <vector>
+#include "kinematics_lib/kinematics_types.h"
+
+/**
+ * @brief Geometric path in the joints space, q(s) with the path parameter s in [0, length()].
+ * The path is at least twice differentiable, the time law is defined separately (e.g. by time_parameterize).
+ * @class JointPath
+ */
+class JointPath
+{
+public:
+    virtual ~JointPath() {}
+
+    /**
+     * @return The final value of the path parameter
+     */
+    virtual double length(void) const = 0;
+
+    /**
+     * @param s The path parameter
+     * @return The joints configuration q(s)
+     */
+    virtual JointStateVector position(double s) const = 0;
+
+    /**
+     * @param s The path parameter
+     * @return The first derivative dq/ds
+     */
+    virtual JointStateVector derivative(double s) const = 0;
+
+    /**
+     * @param s The path parameter
+     * @return The second derivative d2q/ds2
+     */
+    virtual JointStateVector second_derivative(double s) const = 0;
+};
+
+/**
+ * @brief Natural cubic spline through a list of joints configurations, parameterized by the chord length in the joints space
+ * @class WaypointPath
+ */
+class WaypointPath : public JointPath
+{
+private:
+    std::vector<JointStateVector> waypoints;
+    std::vector<JointStateVector> second_derivatives; // at the knots
+    std::vector<double> knots; // cumulative chord length
+
+    /**
+     * @param s The path parameter, clamped to [0, length()]
+     * @return The index of the spline segment containing s
+     */
+    int segment(double &s) const;
+
+public:
+    /**
+     * Constructor. Compute the spline through the waypoints, consecutive duplicates are ignored.
+     *
+     * @param waypoints The joints configurations, at least one
+     */
+    explicit WaypointPath(const std::vector<JointStateVector> &waypoints);
+
+    double length(void) const;
+    JointStateVector position(double s) const;
+    JointStateVector derivative(double s) const;
+    JointStateVector second_derivative(double s) const;
+};
+
+/**
+ * @brief Polyline through joints configurations, parameterized by the length in the joints space, with the corners
+ * replaced by quadratic blends: the path does not stop at the via-points, it passes within the tolerance from them.
+ * The blends are tangent to the straight segments, so the path has a continuous first derivative.
+ * @class BlendedPath
+ */
+class BlendedPath : public JointPath
+{
+private:
+    /**
+     * Straight segment (a + (s - s0) * b) or quadratic Bezier blend with control points a, b, c
+     */
+    struct Segment
+    {
+        double s0;
+        double length;
+        bool blend;
+        JointStateVector a, b, c;
+    };
+
+    std::vector<Segment> segments;
+
+    /**
+     * @param s The path parameter, clamped to [0, length()]
+     * @return The segment containing s
+     */
+    const Segment &segment(double &s) const;
+
+public:
+    /**
+     * Constructor. Compute the segments and the blends, consecutive duplicates are ignored.
+     * The blend at a via-point starts and ends at most 2 * tolerance away from it along the adjacent segments,
+     * and never beyond their midpoints, so the path passes at most tolerance away from the via-point.
+     *
+     * @param waypoints The joints configurations, at least one
+     * @param tolerance The maximum distance (joints space norm) between the path and the via-points, greater than 0
+     */
+    BlendedPath(const std::vector<JointStateVector> &waypoints, double tolerance);
+
+    double length(void) const;
+    JointStateVector position(double s) const;
+    JointStateVector derivative(double s) const;
+    JointStateVector second_derivative(double s) const;
+};
+
+#endif
@@ -40,4 +40,107 @@ typedef Eigen::Matrix<double, 3, 3> RotationMatrix;
  */
 typedef Eigen::Matrix<double, 4, 4> HomoTrMatrix;
 
+/* Types parameterized on the scalar, for the single precision batch computations */
+
+template <typename Scalar>
+using JointStateVectorT = Eigen::Matrix<Scalar, 6, 1>;
+
+template <typename Scalar>
+using CoordinatesT = Eigen::Matrix<Scalar, 3, 1>;
+
+template <typename Scalar>
+using RotationMatrixT = Eigen::Matrix<Scalar, 3, 3>;
+
+/**
+ * Rigid body transformation (element of SE(3)), stored as rotation and translation.
+ * Composition and inverse are computed in closed form: the inverse of [R p] is [R^T -R^T*p],
+ * no general 4x4 matrix product or inversion is needed.
+ */
+template <typename Scalar>
+struct RigidTransformT
+{
+    RotationMatrixT<Scalar> rot;
+    CoordinatesT<Scalar> pos;
+
+    RigidTransformT() {}
+    RigidTransformT(const RotationMatrixT<Scalar> &rot, const CoordinatesT<Scalar> &pos) : rot(rot), pos(pos) {}
+
+    /**
+     * @return The identity transformation
+     */
+    static RigidTransformT identity(void)
+    {
+        return RigidTransformT(RotationMatrixT<Scalar>::Identity(), CoordinatesT<Scalar>::Zero());
+    }
+
+    /**
+     * @param m A homogeneous transformation matrix, the last row is ignored
+     * @return The same transformation as rotation and translation
+     */
+    static RigidTransformT from_matrix(const Eigen::Matrix<Scalar, 4, 4> &m)
+    {
+        return RigidTransformT(m.template topLeftCorner<3, 3>(), m.template topRightCorner<3, 1>());
+    }
+
+    /**
+     * @return The homogeneous transformation matrix
+     */
+    Eigen::Matrix<Scalar, 4, 4> matrix(void) const
+    {
+        Eigen::Matrix<Scalar, 4, 4> m;
+        m << rot, pos,
+            0, 0, 0, 1;
+        return m;
+    }
+
+    /**
+     * @return The inverse transformation
+     */
+    RigidTransformT inverse(void) const
+    {
+        RotationMatrixT<Scalar> rot_t = rot.transpose();
+        return RigidTransformT(rot_t, -(rot_t * pos));
+    }
+
+    /**
+     * Compose two transformations, same as the product of the homogeneous matrices
+     */
+    RigidTransformT operator*(const RigidTransformT &other) const
+    {
+        return RigidTransformT(rot * other.rot, rot * other.pos + pos);
+    }
+
+    /**
+     * Apply the transformation to a point
+     */
+    CoordinatesT<Scalar> operator*(const CoordinatesT<Scalar> &point) const
+    {
+        return rot * point + pos;
+    }
+
+    /**
+     * @return The same transformation with another scalar type
+     */
+    template <typename Other>
+    RigidTransformT<Other> cast(void) const
+    {
+        return RigidTransformT<Other>(rot.template cast<Other>(), pos.template cast<Other>());
+    }
+};
+
+/**
+ * Rigid body transformation in double precision, used by the whole library
+ */
+typedef RigidTransformT<double> RigidTransform;
+
+/**
+ * Kinematic limits of the six joints: maximum absolute velocity [rad/s], acceleration [rad/s^2] and jerk [rad/s^3]
+ */
+struct JointLimits
+{
+    JointStateVector velocity;
+    JointStateVector acceleration;
+    JointStateVector jerk;
+};
+
 #endif
\ No newline at end of file
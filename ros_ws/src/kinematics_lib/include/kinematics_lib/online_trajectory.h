@@ -0,0 +1,209 @@
+/**
+* @file online_trajectory.h
+* @brief Header file for the jerk limited online trajectory generator of the joints
+*
+* @date 17/10/2026
+*/
+
+#ifndef __ONLINE_TRAJECTORY_H__
+#define __ONLINE_TRAJECTORY_H__
+
+#include "kinematics_lib/kinematics_types.h"
+
+/**
+ * @brief Rest to rest double S (seven segments) velocity profile of a scalar displacement:
+ * jerk limited acceleration, constant acceleration, jerk limited deceleration of the acceleration,
+ * constant velocity, and the symmetric deceleration phases.
+ * @class DoubleSProfile
+ */
+class DoubleSProfile
+{
+private:
+    double h; // displacement
+    double jerk; // jerk of the profile
+    double a_lim; // reached acceleration
+    double v_lim; // reached velocity
+    double t_j; // duration of the jerk phases
+    double t_a; // duration of the acceleration (and deceleration) phase
+    double t_v; // duration of the constant velocity phase
+
+    /**
+     * Position during the acceleration phase, 0 <= t <= t_a
+     */
+    double acceleration_position(double t) const;
+
+    /**
+     * Velocity during the acceleration phase, 0 <= t <= t_a
+     */
+    double acceleration_velocity(double t) const;
+
+public:
+    /**
+     * Constructor. Plan a zero length profile.
+     */
+    DoubleSProfile();
+
+    /**
+     * Constructor. Plan the fastest profile that satisfies the limits.
+     *
+     * @param h The displacement, non negative
+     * @param v_max The maximum velocity
+     * @param a_max The maximum acceleration
+     * @param j_max The maximum jerk
+     */
+    DoubleSProfile(double h, double v_max, double a_max, double j_max);
+
+    /**
+     * @return The total duration of the profile
+     */
+    double duration(void) const;
+
+    /**
+     * @param t The time from the beginning of the profile, clamped to [0, duration()]
+     * @return The position at time t, from 0 to the displacement
+     */
+    double position(double t) const;
+
+    /**
+     * @param t The time from the beginning of the profile, clamped to [0, duration()]
+     * @return The velocity at time t
+     */
+    double velocity(double t) const;
+};
+
+/**
+ * @brief Jerk limited stop of a scalar motion, from its current velocity and acceleration to rest as soon as the limits allow:
+ * the acceleration is brought to the maximum deceleration (or to the one that is needed), held, and brought back to 0 when
+ * the velocity reaches 0. A motion already decelerating too fast to stop without reversing first brings its acceleration
+ * to 0, then stops the short reverse motion.
+ * @class StopProfile
+ */
+class StopProfile
+{
+private:
+    double v0; // initial velocity
+    double a0; // initial acceleration
+    int segments; // number of constant jerk segments
+    double segment_duration[6];
+    double segment_jerk[6];
+
+    /**
+     * Append a constant jerk segment
+     */
+    void add_segment(double duration, double jerk);
+
+    /**
+     * Displacement, velocity and acceleration at time t, clamped to [0, duration()]
+     */
+    void state(double t, double &p, double &v, double &a) const;
+
+public:
+    /**
+     * Constructor. A motion already at rest.
+     */
+    StopProfile();
+
+    /**
+     * Constructor. Plan the fastest stop that satisfies the limits.
+     *
+     * @param v0 The current velocity
+     * @param a0 The current acceleration
+     * @param a_max The maximum acceleration
+     * @param j_max The maximum jerk
+     */
+    StopProfile(double v0, double a0, double a_max, double j_max);
+
+    /**
+     * @return The duration of the stop
+     */
+    double duration(void) const;
+
+    /**
+     * @param t The time from the beginning of the stop, clamped to [0, duration()]
+     * @return The displacement at time t
+     */
+    double position(double t) const;
+
+    /**
+     * @param t The time from the beginning of the stop, clamped to [0, duration()]
+     * @return The velocity at time t
+     */
+    double velocity(double t) const;
+};
+
+/**
+ * @brief Online trajectory generator of the joints: the motion towards the target follows a straight line in the joints space,
+ * timed with a double S profile so that velocity, acceleration and jerk of every joint stay within the limits.
+ * The setpoints are computed one cycle at a time, the motion state belongs to the generator.
+ * @class OnlineTrajectoryGenerator
+ */
+class OnlineTrajectoryGenerator
+{
+private:
+    JointLimits limits;
+    double cycle_time;
+
+    JointStateVector initial_joints;
+    JointStateVector delta_joints;
+    DoubleSProfile profile;
+    bool stopping; // the joints follow the stop profiles instead of the straight line
+    StopProfile stops[6];
+    double t;
+
+public:
+    /**
+     * Constructor. The generator starts at rest, with no motion to execute.
+     *
+     * @param limits The limits of the joints
+     * @param cycle_time The time between two consecutive setpoints, i.e. 1 / loop frequency
+     */
+    OnlineTrajectoryGenerator(const JointLimits &limits, double cycle_time);
+
+    /**
+     * Plan the motion from rest at the initial configuration to rest at the target configuration.
+     * All the joints start and stop together, the slowest joint sets the duration.
+     *
+     * @param initial_joints The current configuration of the joints
+     * @param target_joints The target configuration of the joints
+     */
+    void set_target(const JointStateVector &initial_joints, const JointStateVector &target_joints);
+
+    /**
+     * Plan the stop of a moving robot, it replaces the current motion. Every joint stops from its velocity and
+     * acceleration as soon as its limits allow, so the joints stop at different times, close to the path they were following.
+     *
+     * @param joints The current configuration of the joints
+     * @param velocity The current velocity of the joints
+     * @param acceleration The current acceleration of the joints
+     */
+    void set_stop(const JointStateVector &joints, const JointStateVector &velocity, const JointStateVector &acceleration);
+
+    /**
+     * Advance the motion by one cycle
+     *
+     * @return The setpoint of the joints for the new cycle
+     */
+    JointStateVector next(void);
+
+    /**
+     * @return The setpoint of the joints at the current time
+     */
+    JointStateVector position(void) const;
+
+    /**
+     * @return The velocity of the joints at the current time
+     */
+    JointStateVector velocity(void) const;
+
+    /**
+     * @return true if the last setpoint is the target
+     */
+    bool finished(void) const;
+
+    /**
+     * @return The duration of the planned motion (or stop)
+     */
+    double duration(void) const;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+* @file reachability_map.h
+* @brief Header file for the voxelized reachability map of the UR5 end effector, for a fixed rotation
+*
+* @date 17/10/2026
+*/
+
+#ifndef __REACHABILITY_MAP_H__
+#define __REACHABILITY_MAP_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "kinematics_lib/kinematics_types.h"
+#include "kinematics_lib/rrt_connect.h"
+
+/**
+ * @brief Regular grid of end effector positions, for a fixed rotation. Every gridpoint stores the number of valid
+ * ik solutions (0 to 8) of the pose, a measure of the dexterity: 0 means the pose cannot be reached.
+ * The map is computed offline; a query reads the gridpoints around a position, in constant time.
+ * @class ReachabilityMap
+ */
+class ReachabilityMap
+{
+private:
+    Coordinates origin; // position of the first gridpoint
+    double voxel_size;
+    int nx, ny, nz;
+    RotationMatrix rotation;
+    std::vector<uint8_t> solutions;
+
+    int index(int i, int j, int k) const { return (k * ny + j) * nx + i; }
+
+public:
+    /**
+     * Constructor. Empty map.
+     */
+    ReachabilityMap();
+
+    /**
+     * Compute the map: inverse kinematics of every gridpoint, the solutions are checked with the state checker
+     *
+     * @param rotation The rotation of the end effector
+     * @param lower_corner The lower corner of the box covered by the map
+     * @param upper_corner The upper corner of the box covered by the map
+     * @param voxel_size The distance between two gridpoints
+     * @param is_valid The state checker of the ik solutions
+     */
+    void build(const RotationMatrix &rotation, const Coordinates &lower_corner, const Coordinates &upper_corner,
+        double voxel_size, const StateValidityChecker &is_valid);
+
+    /**
+     * Write the map to a binary file
+     *
+     * @param file The path of the file
+     * @return false if the file cannot be written
+     */
+    bool write(const std::string &file) const;
+
+    /**
+     * Read a map written by write()
+     *
+     * @param file The path of the file
+     * @return false if the file cannot be read or it is not a reachability map
+     */
+    bool load(const std::string &file);
+
+    /**
+     * @return true if the map contains some gridpoints
+     */
+    bool loaded(void) const;
+
+    /**
+     * @param rot A rotation of the end effector
+     * @param tolerance The maximum difference between the rotation matrices (max norm)
+     * @return true if the map has been computed for the rotation
+     */
+    bool covers(const RotationMatrix &rot, double tolerance = 1e-6) const;
+
+    /**
+     * Dexterity of a position: the maximum number of valid ik solutions of the gridpoints around it.
+     * The maximum makes the query optimistic, a position is rejected only if none of its neighbours is reachable.
+     *
+     * @param pos The position of the end effector
+     * @return The number of valid ik solutions (0 if unreachable), -1 if the position is outside the map
+     */
+    int dexterity(const Coordinates &pos) const;
+
+    /**
+     * @return The number of gridpoints with at least one valid ik solution
+     */
+    int reachable_points(void) const;
+
+    /**
+     * @return The number of gridpoints
+     */
+    int size(void) const;
+};
+
+#endif
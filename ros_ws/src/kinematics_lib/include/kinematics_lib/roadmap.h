@@ -0,0 +1,180 @@
+/**
+* @file roadmap.h
+* @brief Header file for the probabilistic roadmap (PRM) of the joints space, built offline and memory-mapped at startup
+*
+* @date 17/10/2026
+*/
+
+#ifndef __ROADMAP_H__
+#define __ROADMAP_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "kinematics_lib/kinematics_types.h"
+#include "kinematics_lib/rrt_connect.h"
+
+/**
+ * Binary file of the roadmap, native byte order:
+ * header, nodes (6 doubles each), offsets of the adjacency lists (n_nodes + 1), edges.
+ * The edges of node i are edges[offsets[i]] ... edges[offsets[i + 1] - 1], every edge is stored in both directions.
+ */
+struct RoadmapHeader
+{
+    char magic[8]; // "UR5PRM"
+    uint32_t version;
+    uint32_t n_nodes;
+    uint32_t n_edges;
+    uint32_t reserved;
+    double resolution; // resolution of the motion checks of the edges
+};
+
+struct RoadmapEdge
+{
+    uint32_t target;
+    float cost; // length of the motion, joints space norm
+};
+
+/**
+ * @brief Offline construction of a roadmap: valid configurations joined by valid straight motions
+ * @class RoadmapBuilder
+ */
+class RoadmapBuilder
+{
+private:
+    StateValidityChecker is_valid;
+    double resolution;
+    std::vector<JointStateVector> nodes;
+    std::vector<std::vector<RoadmapEdge>> adjacency;
+
+public:
+    /**
+     * Constructor. Empty roadmap.
+     *
+     * @param is_valid The state checker
+     * @param resolution The maximum distance (joints space norm, rad) between two configurations checked along a motion
+     */
+    RoadmapBuilder(const StateValidityChecker &is_valid, double resolution = 0.02);
+
+    /**
+     * Add a configuration to the roadmap, if it is valid
+     *
+     * @param q The configuration
+     * @return The index of the new node, -1 if the configuration is not valid
+     */
+    int add_node(const JointStateVector &q);
+
+    /**
+     * Add random valid configurations, drawn uniformly between the limits
+     *
+     * @param n The number of configurations to add
+     * @param lower_bounds The lower limits of the joints
+     * @param upper_bounds The upper limits of the joints
+     * @param seed The seed of the random samples
+     */
+    void sample(int n, const JointStateVector &lower_bounds, const JointStateVector &upper_bounds, unsigned int seed = 42);
+
+    /**
+     * Join every node to its k nearest nodes, within max_distance, when the straight motion is valid
+     *
+     * @param k The number of neighbours
+     * @param max_distance The maximum length of an edge (joints space norm, rad)
+     */
+    void connect(int k, double max_distance);
+
+    /**
+     * @return The number of nodes
+     */
+    int size(void) const;
+
+    /**
+     * @return The number of edges, each direction counted once
+     */
+    int edges(void) const;
+
+    /**
+     * @param node The index of a node
+     * @return The index of the first node of its connected component
+     */
+    int component(int node) const;
+
+    /**
+     * Write the roadmap to a binary file
+     *
+     * @param file The path of the file
+     * @return false if the file cannot be written
+     */
+    bool write(const std::string &file) const;
+};
+
+/**
+ * @brief Read-only roadmap, memory-mapped from the file written by RoadmapBuilder.
+ * A query connects start and goal to the nearest nodes, then searches the graph (A*).
+ * @class Roadmap
+ */
+class Roadmap
+{
+private:
+    void *data;
+    size_t bytes;
+    const RoadmapHeader *header;
+    const double *nodes;
+    const uint32_t *offsets;
+    const RoadmapEdge *edges;
+
+    /**
+     * @return The nodes reachable with a valid straight motion from q, at most k, the nearest first
+     */
+    std::vector<int> connections(const JointStateVector &q, const StateValidityChecker &is_valid, int k) const;
+
+public:
+    Roadmap();
+    ~Roadmap();
+
+    Roadmap(const Roadmap &) = delete;
+    Roadmap &operator=(const Roadmap &) = delete;
+
+    /**
+     * Map a roadmap file in memory, the previous one is unmapped
+     *
+     * @param file The path of the file
+     * @return false if the file cannot be mapped, it is not a roadmap or its adjacency lists are not consistent
+     */
+    bool load(const std::string &file);
+
+    /**
+     * Unmap the roadmap
+     */
+    void unload(void);
+
+    /**
+     * @return true if a roadmap is mapped
+     */
+    bool loaded(void) const;
+
+    /**
+     * @return The number of nodes, 0 if no roadmap is mapped
+     */
+    int size(void) const;
+
+    /**
+     * @param i The index of the node
+     * @return The configuration of the node
+     */
+    JointStateVector node(int i) const;
+
+    /**
+     * Find the shortest path in the roadmap between two configurations
+     *
+     * @param start The initial configuration, valid
+     * @param goal The final configuration, valid
+     * @param is_valid The state checker of the motions from start and to goal
+     * @param path output - the configurations of the path, start and goal included, joined by valid straight motions
+     * @param k The maximum number of nodes start and goal are connected to
+     * @return false if start or goal cannot be connected, or they are not in the same component
+     */
+    bool query(const JointStateVector &start, const JointStateVector &goal, const StateValidityChecker &is_valid,
+        std::vector<JointStateVector> &path, int k = 10) const;
+};
+
+#endif
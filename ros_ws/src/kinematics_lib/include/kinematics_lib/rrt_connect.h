@@ -0,0 +1,144 @@
+/**
+* @file rrt_connect.h
+* @brief Header file for the sampling based planner (RRT-Connect) in the joints space
+*
+* @date 17/10/2026
+*/
+
+#ifndef __RRT_CONNECT_H__
+#define __RRT_CONNECT_H__
+
+#include <functional>
+#include <random>
+#include <vector>
+#include "kinematics_lib/kinematics_types.h"
+
+/**
+ * State checker of the planner: true if the joints configuration is valid (no collisions, no singularities)
+ */
+typedef std::function<bool(const JointStateVector &)> StateValidityChecker;
+
+/**
+ * Check the straight motion between two configurations in the joints space, the first one is assumed to be valid
+ *
+ * @param is_valid The state checker
+ * @param from The initial configuration
+ * @param to The final configuration
+ * @param resolution The maximum distance (joints space norm, rad) between two checked configurations
+ * @return true if every configuration along the motion is valid
+ */
+bool check_motion(const StateValidityChecker &is_valid, const JointStateVector &from, const JointStateVector &to, double resolution);
+
+/**
+ * @brief Outcome of the last query of the planner
+ */
+struct RRTStats
+{
+    double planning_time; // seconds spent growing the trees
+    double smoothing_time; // seconds spent shortcutting the path
+    int iterations; // number of samples drawn
+    int tree_size; // number of nodes of both trees
+    int waypoints; // number of configurations of the returned path
+};
+
+/**
+ * @brief RRT-Connect planner: two trees grow from the start and the goal configurations towards random samples,
+ * and each tree tries to connect to the last node added to the other one. The motions between the nodes are
+ * straight lines in the joints space, checked at a fixed resolution with the state checker.
+ * The path found is shortened by removing the waypoints that can be skipped with a valid straight motion.
+ * @class RRTConnect
+ */
+class RRTConnect
+{
+private:
+    /**
+     * Node of a tree, the parent of the root is -1
+     */
+    struct Node
+    {
+        JointStateVector q;
+        int parent;
+    };
+
+    typedef std::vector<Node> Tree;
+
+    enum ExtendResult { TRAPPED, ADVANCED, REACHED };
+
+    StateValidityChecker is_valid;
+    JointStateVector lower_bounds;
+    JointStateVector upper_bounds;
+    double max_step;
+    double resolution;
+    std::mt19937 gen;
+    RRTStats stats;
+
+    /**
+     * @return The index of the node of the tree closest to q
+     */
+    int nearest(const Tree &tree, const JointStateVector &q) const;
+
+    /**
+     * Move from the nearest node of the tree towards target, at most max_step away, and add the new node if the motion is valid
+     */
+    ExtendResult extend(Tree &tree, const JointStateVector &target);
+
+    /**
+     * Extend the tree towards target until it is reached or the motion is not valid
+     */
+    ExtendResult connect(Tree &tree, const JointStateVector &target);
+
+    /**
+     * @return The configurations from the root of the tree to the node, root first
+     */
+    std::vector<JointStateVector> branch(const Tree &tree, int node) const;
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param is_valid The state checker
+     * @param lower_bounds The lower limits of the joints, the samples are drawn between the limits
+     * @param upper_bounds The upper limits of the joints
+     * @param max_step The maximum distance (joints space norm, rad) between a node and its parent
+     * @param resolution The maximum distance between two configurations checked along a motion
+     * @param seed The seed of the random samples, the planner is deterministic for a given seed and time budget
+     */
+    RRTConnect(const StateValidityChecker &is_valid, const JointStateVector &lower_bounds, const JointStateVector &upper_bounds,
+        double max_step = 0.3, double resolution = 0.02, unsigned int seed = 42);
+
+    /**
+     * Check the straight motion between two configurations, the first one is assumed to be valid
+     *
+     * @param from The initial configuration
+     * @param to The final configuration
+     * @return true if every configuration along the motion is valid
+     */
+    bool check_motion(const JointStateVector &from, const JointStateVector &to) const;
+
+    /**
+     * Plan a path between two valid configurations, within a time budget.
+     *
+     * @param start The initial configuration
+     * @param goal The final configuration
+     * @param max_time The time budget, in seconds
+     * @param path output - the configurations of the path, start and goal included, joined by valid straight motions
+     * @return false if no path was found within the time budget, or start or goal are not valid
+     */
+    bool plan(const JointStateVector &start, const JointStateVector &goal, double max_time, std::vector<JointStateVector> &path);
+
+    /**
+     * Shorten a path: random pairs of waypoints are joined by a straight motion, when it is valid,
+     * then every waypoint is joined to the farthest one it can reach directly.
+     *
+     * @param path input/output - the path to shorten, start and goal do not change
+     * @param iterations The number of random pairs
+     */
+    void shortcut(std::vector<JointStateVector> &path, int iterations = 100);
+
+    /**
+     * @return The statistics of the last plan
+     */
+    RRTStats get_stats(void) const;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/**
+* @file seqlock.h
+* @brief Header file for a sequence lock protecting a snapshot written by one thread and read by many
+*
+* @date 17/10/2026
+*/
+
+#ifndef __SEQLOCK_H__
+#define __SEQLOCK_H__
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Snapshot of a trivially copyable value with a single writer and any number of readers.
+ * The writer never waits; a reader copies the value and retries if a write overlapped the copy
+ * (odd sequence number, or a sequence number changed during the copy), so it never sees a torn value.
+ * @class SeqLock
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "The value of a seqlock must be trivially copyable");
+
+private:
+    std::atomic<unsigned> sequence;
+    T value;
+
+public:
+    SeqLock() : sequence(0), value() {}
+
+    explicit SeqLock(const T &initial) : sequence(0), value(initial) {}
+
+    SeqLock(const SeqLock &) = delete;
+    SeqLock &operator=(const SeqLock &) = delete;
+
+    /**
+     * Replace the value, from the writer thread only
+     *
+     * @param new_value The new value
+     */
+    void store(const T &new_value)
+    {
+        unsigned s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&value, &new_value, sizeof(T));
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @return A consistent copy of the last value stored, from any thread
+     */
+    T load(void) const
+    {
+        T copy;
+        unsigned before, after;
+        do
+        {
+            before = sequence.load(std::memory_order_acquire);
+            std::memcpy(&copy, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return copy;
+    }
+
+    /**
+     * @return The number of values stored so far
+     */
+    unsigned version(void) const
+    {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+};
+
+#endif
@@ -0,0 +1,99 @@
+/**
+* @file spsc_ring.h
+* @brief Header file for a lock-free single producer single consumer ring buffer
+*
+* @date 17/10/2026
+*/
+
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Bounded FIFO queue shared by exactly one producer thread and one consumer thread, with no locks and no allocations:
+ * push and pop never block, they fail when the ring is full or empty. The capacity must be a power of two.
+ * The two indexes are on separate cache lines, so the producer and the consumer do not invalidate each other's line
+ * at every operation.
+ * @class SpscRing
+ */
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity of the ring must be a power of two");
+
+private:
+    static constexpr size_t mask = Capacity - 1;
+
+    // Free running indexes, the slot is the index modulo the capacity
+    alignas(64) std::atomic<size_t> head; // next slot to be read, written by the consumer
+    alignas(64) std::atomic<size_t> tail; // next slot to be written, written by the producer
+    alignas(64) T slots[Capacity];
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * Append an element, producer thread only
+     *
+     * @param value The element
+     * @return false if the ring is full, the element is not added
+     */
+    bool try_push(const T &value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove the oldest element, consumer thread only
+     *
+     * @param value output - the element
+     * @return false if the ring is empty
+     */
+    bool try_pop(T &value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Discard every element, consumer thread only
+     */
+    void clear(void)
+    {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @return The number of elements, exact only when called by the producer or the consumer
+     */
+    size_t size(void) const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty(void) const
+    {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity(void)
+    {
+        return Capacity;
+    }
+};
+
+#endif
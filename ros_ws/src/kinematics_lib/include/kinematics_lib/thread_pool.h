@@ -0,0 +1,78 @@
+/** 
+* @file thread_pool.h 
+* @brief Header file for a fixed size pool of worker threads
+*
+* @date 17/10/2026
+*/
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed size pool of worker threads executing the submitted tasks in FIFO order
+ * @class ThreadPool
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void(void)>> tasks;
+    std::mutex tasks_mutex;
+    std::condition_variable task_available;
+    bool stopping;
+
+    /**
+     * Body of the worker threads: pop tasks from the queue until the pool is destroyed
+     */
+    void worker_loop(void);
+
+public:
+    /**
+     * Constructor. Start the worker threads.
+     * 
+     * @param n_threads Number of worker threads, 0 to use one thread per hardware core
+     */
+    explicit ThreadPool(int n_threads = 0);
+
+    /**
+     * Destructor. Complete the queued tasks and join the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @return The number of worker threads
+     */
+    int size(void) const;
+
+    /**
+     * Queue a task for execution on the worker threads
+     * 
+     * @param task The function to be executed
+     * @return A future that becomes ready when the task is completed
+     */
+    std::future<void> submit(const std::function<void(void)> &task);
+
+    /**
+     * Split the range [0, n) in chunks and execute body(begin, end) on every chunk.
+     * The calling thread executes one of the chunks and waits for the others.
+     * Do not call it from a task running on the same pool.
+     * 
+     * @param n The size of the range
+     * @param body The function to be executed on every chunk [begin, end)
+     * @param min_chunk The minimum number of elements of a chunk
+     */
+    void parallel_for(int n, const std::function<void(int, int)> &body, int min_chunk = 1);
+};
+
+#endif
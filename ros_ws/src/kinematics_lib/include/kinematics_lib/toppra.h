@@ -0,0 +1,69 @@
+/**
+* @file toppra.h
+* @brief Header file for the time optimal path parameterization (TOPP-RA) of the joint paths
+*
+* @date 17/10/2026
+*/
+
+#ifndef __TOPPRA_H__
+#define __TOPPRA_H__
+
+#include <vector>
+#include "kinematics_lib/joint_path.h"
+
+/**
+ * @brief Time law s(t) of a geometric path, piecewise constant path acceleration between the gridpoints
+ * @class PathTiming
+ */
+class PathTiming
+{
+private:
+    std::vector<double> s; // path parameter of the gridpoints
+    std::vector<double> sd; // path velocity ds/dt at the gridpoints
+    std::vector<double> t; // time at the gridpoints
+
+public:
+    PathTiming() {}
+
+    /**
+     * Constructor. Integrate the time of the gridpoints.
+     *
+     * @param s The path parameter of the gridpoints, increasing
+     * @param x The squared path velocity (ds/dt)^2 at the gridpoints
+     */
+    PathTiming(const std::vector<double> &s, const std::vector<double> &x);
+
+    /**
+     * @return The total duration of the motion
+     */
+    double duration(void) const;
+
+    /**
+     * @param time The time from the beginning of the motion, clamped to [0, duration()]
+     * @param s_dot optional output - the path velocity ds/dt at the given time
+     * @return The path parameter at the given time
+     */
+    double path_parameter(double time, double *s_dot = nullptr) const;
+
+    /**
+     * @return The number of gridpoints
+     */
+    int size(void) const;
+};
+
+/**
+ * Compute the fastest time law of a path from rest to rest, with per joint velocity and acceleration limits.
+ * The path is sampled on a uniform grid; the reachability analysis of TOPP-RA computes backwards the set of the
+ * path velocities that can still stop at the end of the path, then the forward pass picks the maximum
+ * path acceleration that keeps the velocity inside those sets. Every step is a two variables linear program,
+ * solved in closed form by eliminating the path acceleration.
+ *
+ * @param path The geometric path
+ * @param limits The joints limits, jerk is not used
+ * @param timing output - the time law of the path
+ * @param n_gridpoints The number of gridpoints, at least 2
+ * @return false if the path cannot be followed within the limits
+ */
+bool time_parameterize(const JointPath &path, const JointLimits &limits, PathTiming &timing, int n_gridpoints = 100);
+
+#endif
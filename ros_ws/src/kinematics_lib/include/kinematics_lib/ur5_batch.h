@@ -0,0 +1,102 @@
+/** 
+* @file ur5_batch.h 
+* @brief Header file for the batched direct and inverse kinematics of UR5 over arrays of poses
+*
+* @date 17/10/2026
+*/
+
+#ifndef __UR5_BATCH_H__
+#define __UR5_BATCH_H__
+
+#include "kinematics_lib/kinematics_types.h"
+#include "kinematics_lib/thread_pool.h"
+#include <vector>
+
+/**
+ * Array of end effector poses in structure of arrays layout.
+ * The rotation entry (row, col) of the i-th pose is stored in rot[3 * col + row][i]
+ */
+struct PoseBatch
+{
+    std::vector<double> x, y, z;
+    std::vector<double> rot[9];
+
+    /**
+     * @return The number of poses
+     */
+    int size(void) const { return x.size(); }
+
+    /**
+     * Change the number of poses
+     */
+    void resize(int n);
+
+    /**
+     * Store the i-th pose
+     */
+    void set(int i, const Coordinates &pe, const RotationMatrix &re);
+
+    /**
+     * Read the i-th pose
+     */
+    void get(int i, Coordinates &pe, RotationMatrix &re) const;
+};
+
+/**
+ * Array of joint configurations in structure of arrays layout: th[j][i] is the joint j of the i-th configuration
+ */
+struct JointBatch
+{
+    std::vector<double> th[6];
+
+    /**
+     * @return The number of configurations
+     */
+    int size(void) const { return th[0].size(); }
+
+    /**
+     * Change the number of configurations
+     */
+    void resize(int n);
+
+    /**
+     * Store the i-th configuration
+     */
+    void set(int i, const JointStateVector &joints);
+
+    /**
+     * Read the i-th configuration
+     */
+    JointStateVector get(int i) const;
+};
+
+/**
+ * Solutions of the batched inverse kinematics.
+ * The 8 solutions of the i-th pose are stored at indexes 8 * i ... 8 * i + 7, 
+ * in the same order of the rows returned by ur5_inverse_complete
+ */
+struct IkBatchResult
+{
+    JointBatch solutions;
+    std::vector<unsigned char> valid; // 1 if the solution reaches the desired pose
+};
+
+/**
+ * Compute the complete inverse kinematics of UR5 for every pose of the batch
+ * 
+ * @param poses The desired poses of the end effector
+ * @param result output - the 8 solutions of every pose and their validity flags
+ * @param pool The worker threads used to split the batch, nullptr to run on the calling thread
+ */
+void ur5_inverse_batch(const PoseBatch &poses, IkBatchResult &result, ThreadPool *pool = nullptr);
+
+/**
+ * Compute the direct kinematics of UR5 for every configuration of the batch
+ * 
+ * @param joints The joints configurations
+ * @param poses output - the poses of the end effector
+ * @param pool The worker threads used to split the batch, nullptr to run on the calling thread
+ */
+void ur5_direct_batch(const JointBatch &joints, PoseBatch &poses, ThreadPool *pool = nullptr);
+
+#endif
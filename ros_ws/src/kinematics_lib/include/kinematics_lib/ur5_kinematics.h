@@ -12,22 +12,44 @@
 
 #include <math.h>
 #include "kinematics_types.h"
+#include "ur_kinematics.h"
+#include "ur_singularity.h"
+#include "cubic_trajectory.h"
+#include "online_trajectory.h"
 
-/* UR5 DH parameters */
+/* UR5 DH parameters: the UR5 of the project (lab and locosim) has the e-series parameters */
 
-static const double dh_a[] = {0, -0.425, -0.3922, 0, 0, 0};
-static const double dh_d[] = {0.1625, 0, 0, 0.1333, 0.0997, 0.0996};
+typedef UR5e UR5Model;
+
+static const double dh_a[] = {0, UR5Model::a2(), UR5Model::a3(), 0, 0, 0};
+static const double dh_d[] = {UR5Model::d1(), 0, 0, UR5Model::d4(), UR5Model::d5(), UR5Model::d6()};
 
 /* Functions */
 
 /**
  * Compute direct kinematics of UR5
- * 
+ *
  * @param th input - six joints values (angles)
  * @param pe output - cartesian position of the end effector
  * @param re output - rotation matrix of the end effector
  */
-void ur5_direct(JointStateVector &th, Coordinates &pe, RotationMatrix &re);
+void ur5_direct(const JointStateVector &th, Coordinates &pe, RotationMatrix &re);
+
+/**
+ * Compute direct kinematics of UR5
+ *
+ * @param th The six joints values (angles)
+ * @return The pose of the end effector with respect to the base frame
+ */
+RigidTransform ur5_direct(const JointStateVector &th);
+
+/**
+ * Compute direct kinematics of UR5 from the precomputed trigonometry of the joints
+ *
+ * @param t The sines and cosines of the joints configuration
+ * @return The pose of the end effector with respect to the base frame
+ */
+RigidTransform ur5_direct(const JointTrig &t);
 
 /**
  * Compute inverse kinematics of UR5, return the first solution only
@@ -47,6 +69,46 @@ JointStateVector ur5_inverse(const Coordinates &pe, const RotationMatrix &re);
  */
 Eigen::Matrix<double, 8, 6> ur5_inverse_complete(const Coordinates &pe, const RotationMatrix &re);
 
+/**
+ * Compute inverse kinematics of UR5, return all the 8 solutions in a 8x6 matrix.
+ * Same solutions (and same row order) of ur5_inverse_complete, but the branches are laid out
+ * across SIMD lanes and the closed-form subexpressions are computed only once,
+ * without building and inverting the 4x4 DH matrices.
+ *
+ * @param pe The desired cartesian position of the end effector
+ * @param re The desired rotation matrix of the end effector
+ * @return An 8x6 matrix containing the 8 solutions of the inverse kinematics
+ */
+Eigen::Matrix<double, 8, 6> ur5_inverse_complete_simd(const Coordinates &pe, const RotationMatrix &re);
+
+/**
+ * Same as ur5_inverse_complete_simd, also report which solutions reach the desired pose.
+ * Out of reach branches are not NaN: the wrist and elbow angles are clamped to the closest configuration.
+ *
+ * @param pe The desired cartesian position of the end effector
+ * @param re The desired rotation matrix of the end effector
+ * @param exact output - true for the rows that are exact solutions of the inverse kinematics
+ * @return An 8x6 matrix containing the 8 solutions of the inverse kinematics
+ */
+Eigen::Matrix<double, 8, 6> ur5_inverse_complete_simd(const Coordinates &pe, const RotationMatrix &re, Eigen::Array<bool, 8, 1> &exact);
+
+/**
+ * Iterative inverse kinematics of UR5: damped Levenberg-Marquardt iterations on the pose error, with the analytic jacobian,
+ * warm-started from a known configuration. The damping grows when a step does not reduce the error and shrinks when it does,
+ * so the iterations converge to the closest reachable pose when the desired one is out of reach.
+ * 
+ * @param pe The desired cartesian position of the end effector
+ * @param re The desired rotation matrix of the end effector
+ * @param initial The initial guess, e.g. the current joints
+ * @param th output - the six joints values (angles) with the smallest error found
+ * @param tolerance Largest accepted pose error (norm of position error and rotation vector)
+ * @param max_iterations Maximum number of iterations
+ * @param iterations output - optional, the number of iterations
+ * @return true if the pose error of th is within the tolerance
+ */
+bool ur5_inverse_lm(const Coordinates &pe, const RotationMatrix &re, const JointStateVector &initial, JointStateVector &th,
+    double tolerance, int max_iterations, int *iterations = nullptr);
+
 /**
  * Compute the jacobian matrix of the ur5 for the given configuration
  * 
@@ -55,6 +117,43 @@ Eigen::Matrix<double, 8, 6> ur5_inverse_complete(const Coordinates &pe, const Ro
 */
 Eigen::Matrix<double, 6, 6> ur5_jacobian(const JointStateVector &th);
 
+/**
+ * Compute direct kinematics and jacobian of the ur5 with a single evaluation of the joints trigonometry,
+ * used when both are needed for the same configuration (e.g. path validation)
+ *
+ * @param th input - the joints configuration
+ * @param pe output - cartesian position of the end effector
+ * @param re output - rotation matrix of the end effector
+ * @param jac output - the 6x6 Jacobian matrix
+ */
+void ur5_direct_and_jacobian(const JointStateVector &th, Coordinates &pe, RotationMatrix &re, Eigen::Matrix<double, 6, 6> &jac);
+
+/**
+ * Compute the singularity factors (shoulder, elbow, wrist) and the jacobian determinant of the ur5, in closed form
+ *
+ * @param th The joints configuration
+ * @return The singularity factors
+ */
+UrSingularity ur5_singularity(const JointStateVector &th);
+
+/**
+ * Compute the manipulability measure of the ur5, |det(J)|
+ *
+ * @param th The joints configuration
+ * @return The manipulability of the configuration
+ */
+double ur5_manipulability(const JointStateVector &th);
+
+/**
+ * Check whether a configuration of the ur5 is singular, i.e. the jacobian determinant
+ * or the smallest singular value of the jacobian is below the threshold
+ *
+ * @param t The sines and cosines of the joints configuration
+ * @param threshold The rejection threshold
+ * @return True if the configuration is singular
+ */
+bool ur5_is_singular(const JointTrig &t, double threshold);
+
 /**
  * Compute rotation matrix from euler angles
  * 
@@ -67,12 +166,38 @@ RotationMatrix euler_to_rot(double roll, double pitch, double yaw);
 
 /**
  * Compute the joints values to follow a path between initial and final positions by finding the coefficients of a third degree system.
+ * The configurations are not stored, they are evaluated when the trajectory is accessed.
  * 
  * @param initial_joints Starting joints configuration  
  * @param final_joints Final joints configuration
- * @param n Number of configurations to compute in between the path
- * @return Pointer to a vector of n * 6 elements, representing the computed configurations 
+ * @param n Number of configurations in the path, including the initial and final ones
+ * @return The trajectory, a sequence of n configurations
+ */
+CubicTrajectory ur5_trajectory_plan(const JointStateVector &initial_joints, const JointStateVector &final_joints, int n);
+
+/**
+ * Signed distance of the end effector from the workbench region (z > 0.74 and y > -0.4)
+ * 
+ * @param pos The position of the end effector
+ * @return The distance from the region, negative inside it
+ */
+double ur5_workbench_distance(const Coordinates &pos);
+
+/**
+ * Check a configuration of the ur5 in the workcell:
+ * 1. Compute direct kinematics and check if the position collides with the workbench
+ * 2. Check the singularities with the analytic jacobian determinant and singular values
+ * 
+ * @param th The six joints values (angles)
+ * @return true if the configuration is valid
+ */
+bool ur5_check_configuration(const JointStateVector &th);
+
+/**
+ * Operating limits of the ur5 joints, below the maximum joint speed of the datasheet (pi rad/s)
+ * 
+ * @return The velocity, acceleration and jerk limits of the six joints
  */
-double *ur5_trajectory_plan(const JointStateVector &initial_joints, const JointStateVector &final_joints, int n);
+JointLimits ur5_joint_limits(void);
 
 #endif
\ No newline at end of file
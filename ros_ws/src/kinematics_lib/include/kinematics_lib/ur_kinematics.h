@@ -0,0 +1,387 @@
+/**
+* @file ur_kinematics.h
+* @brief Header file for the kinematics templates of the Universal Robots arms, parameterized on the robot model,
+* on the scalar type and on the trigonometric policy (see ur_trig.h). The defaults, double and LibmTrig,
+* are the kinematics used by the controllers; float and PolyTrig are meant for the batch computations.
+*
+* @date 17/10/2026
+*/
+
+#ifndef __UR_KINEMATICS_H__
+#define __UR_KINEMATICS_H__
+
+#include <math.h>
+#include "kinematics_lib/kinematics_types.h"
+#include "kinematics_lib/ur_models.h"
+#include "kinematics_lib/ur_trig.h"
+
+/* Lane types of the branch-parallel inverse kinematics */
+
+typedef Eigen::Array<double, 4, 1> UrLanes4;
+typedef Eigen::Array<double, 8, 1> UrLanes8;
+
+/**
+ * Real part of the complex acos/asin used by ur5_inverse_complete,
+ * the argument is clamped into [-1, 1] while NaN values are propagated
+ */
+template <typename Scalar>
+inline Scalar ur_clamp_unit(Scalar x)
+{
+    return x > Scalar(1) ? Scalar(1) : (x < Scalar(-1) ? Scalar(-1) : x);
+}
+
+/**
+ * Sines and cosines of a joints configuration, computed once and shared by the direct kinematics,
+ * the jacobian and the path validation. The partial sums are the angles of the parallel joints 2, 3 and 4.
+ */
+template <typename Scalar>
+struct JointTrigT
+{
+    Scalar c[6], s[6]; // th(i)
+    Scalar c23, s23; // th(1) + th(2)
+    Scalar c234, s234; // th(1) + th(2) + th(3)
+
+    JointTrigT() {}
+
+    template <typename Trig = LibmTrig>
+    explicit JointTrigT(const JointStateVectorT<Scalar> &th, Trig = Trig())
+    {
+        for (int i = 0; i < 6; i++)
+            Trig::sincos(th(i), s[i], c[i]);
+        // Angle addition formulas, no further trigonometric calls
+        c23 = c[1] * c[2] - s[1] * s[2];
+        s23 = s[1] * c[2] + c[1] * s[2];
+        c234 = c23 * c[3] - s23 * s[3];
+        s234 = s23 * c[3] + c23 * s[3];
+    }
+};
+
+typedef JointTrigT<double> JointTrig;
+
+/* DH link transformations: pose of frame i with respect to frame i-1, given the joint angle */
+
+template <typename Model, typename Scalar>
+inline RigidTransformT<Scalar> ur_t10(Scalar th)
+{
+    Scalar c = std::cos(th), s = std::sin(th);
+    RigidTransformT<Scalar> t;
+    t.rot << c, -s, 0,
+        s, c, 0,
+        0, 0, 1;
+    t.pos << 0, 0, Scalar(Model::d1());
+    return t;
+}
+
+template <typename Model, typename Scalar>
+inline RigidTransformT<Scalar> ur_t21(Scalar th)
+{
+    Scalar c = std::cos(th), s = std::sin(th);
+    RigidTransformT<Scalar> t;
+    t.rot << c, -s, 0,
+        0, 0, -1,
+        s, c, 0;
+    t.pos << 0, 0, 0;
+    return t;
+}
+
+template <typename Model, typename Scalar>
+inline RigidTransformT<Scalar> ur_t32(Scalar th)
+{
+    Scalar c = std::cos(th), s = std::sin(th);
+    RigidTransformT<Scalar> t;
+    t.rot << c, -s, 0,
+        s, c, 0,
+        0, 0, 1;
+    t.pos << Scalar(Model::a2()), 0, 0;
+    return t;
+}
+
+template <typename Model, typename Scalar>
+inline RigidTransformT<Scalar> ur_t43(Scalar th)
+{
+    Scalar c = std::cos(th), s = std::sin(th);
+    RigidTransformT<Scalar> t;
+    t.rot << c, -s, 0,
+        s, c, 0,
+        0, 0, 1;
+    t.pos << Scalar(Model::a3()), 0, Scalar(Model::d4());
+    return t;
+}
+
+template <typename Model, typename Scalar>
+inline RigidTransformT<Scalar> ur_t54(Scalar th)
+{
+    Scalar c = std::cos(th), s = std::sin(th);
+    RigidTransformT<Scalar> t;
+    t.rot << c, -s, 0,
+        0, 0, -1,
+        s, c, 0;
+    t.pos << 0, Scalar(-Model::d5()), 0;
+    return t;
+}
+
+template <typename Model, typename Scalar>
+inline RigidTransformT<Scalar> ur_t65(Scalar th)
+{
+    Scalar c = std::cos(th), s = std::sin(th);
+    RigidTransformT<Scalar> t;
+    t.rot << c, -s, 0,
+        0, 0, 1,
+        -s, -c, 0;
+    t.pos << 0, Scalar(Model::d6()), 0;
+    return t;
+}
+
+/* Kinematics */
+
+/**
+ * Compute direct kinematics of a UR arm in closed form (same result of the product of the six DH link transformations)
+ *
+ * @param t The sines and cosines of the joints configuration
+ * @return The pose of the end effector with respect to the base frame
+ */
+template <typename Model, typename Scalar>
+RigidTransformT<Scalar> ur_direct(const JointTrigT<Scalar> &t)
+{
+    const Scalar d1 = Model::d1(), a2 = Model::a2(), a3 = Model::a3();
+    const Scalar d4 = Model::d4(), d5 = Model::d5(), d6 = Model::d6();
+    Scalar c1 = t.c[0], s1 = t.s[0];
+    Scalar c5 = t.c[4], s5 = t.s[4];
+    Scalar c6 = t.c[5], s6 = t.s[5];
+
+    // Axes of frame 5
+    CoordinatesT<Scalar> x5, y5, z5;
+    x5 << c1 * t.c234 * c5 + s1 * s5, s1 * t.c234 * c5 - c1 * s5, t.s234 * c5;
+    y5 << s1 * c5 - c1 * t.c234 * s5, -c1 * c5 - s1 * t.c234 * s5, -t.s234 * s5;
+    z5 << c1 * t.s234, s1 * t.s234, -t.c234;
+
+    // Distance of the wrist from the shoulder axis, in the arm plane
+    Scalar r = a2 * t.c[1] + a3 * t.c23 + d5 * t.s234;
+
+    RigidTransformT<Scalar> t06;
+    t06.rot << c6 * x5 - s6 * z5, -s6 * x5 - c6 * z5, y5;
+    t06.pos << c1 * r + d4 * s1 + d6 * y5(0),
+        s1 * r - d4 * c1 + d6 * y5(1),
+        d1 + a2 * t.s[1] + a3 * t.s23 - d5 * t.c234 + d6 * y5(2);
+    return t06;
+}
+
+/**
+ * Compute direct kinematics of a UR arm
+ *
+ * @param th The six joints values (angles), the scalar type of the computation
+ * @return The pose of the end effector with respect to the base frame
+ */
+template <typename Model, typename Trig = LibmTrig, typename Derived>
+RigidTransformT<typename Derived::Scalar> ur_direct(const Eigen::MatrixBase<Derived> &th)
+{
+    return ur_direct<Model>(JointTrigT<typename Derived::Scalar>(th, Trig()));
+}
+
+/**
+ * Compute the jacobian matrix of a UR arm for the given configuration
+ *
+ * @param t The sines and cosines of the joints configuration
+ * @return The 6x6 Jacobian matrix
+ */
+template <typename Model, typename Scalar>
+Eigen::Matrix<Scalar, 6, 6> ur_jacobian(const JointTrigT<Scalar> &t)
+{
+    const Scalar a2 = Model::a2(), a3 = Model::a3();
+    const Scalar d4 = Model::d4(), d5 = Model::d5();
+    Scalar c1 = t.c[0], s1 = t.s[0];
+    Scalar c5 = t.c[4], s5 = t.s[4];
+
+    // Terms shared by the columns of the parallel joints 2, 3 and 4
+    Scalar k2 = a2 * t.s[1] + a3 * t.s23 - d5 * (t.c234 + t.s234 * s5);
+    Scalar k3 = d5 * (t.c234 + t.s234 * s5) - a3 * t.s23;
+    Scalar k4 = d5 * (t.c234 + t.s234 * s5);
+    Scalar z4 = d5 * (t.s234 - t.c234 * s5);
+
+    Eigen::Matrix<Scalar, 6, 6> jac;
+
+    jac(0, 0) = d5 * (c1 * c5 + t.c234 * s1 * s5) + d4 * c1 - a3 * t.c23 * s1 - a2 * t.c[1] * s1 - d5 * t.s234 * s1;
+    jac(1, 0) = d5 * (c5 * s1 - t.c234 * c1 * s5) + d4 * s1 + a3 * t.c23 * c1 + a2 * c1 * t.c[1] + d5 * t.s234 * c1;
+    jac(2, 0) = 0;
+    jac(3, 0) = 0;
+    jac(4, 0) = 0;
+    jac(5, 0) = 1;
+
+    jac(0, 1) = -c1 * k2;
+    jac(1, 1) = -s1 * k2;
+    jac(2, 1) = a3 * t.c23 + a2 * t.c[1] + z4;
+    jac(3, 1) = s1;
+    jac(4, 1) = -c1;
+    jac(5, 1) = 0;
+
+    jac(0, 2) = c1 * k3;
+    jac(1, 2) = s1 * k3;
+    jac(2, 2) = a3 * t.c23 + z4;
+    jac(3, 2) = s1;
+    jac(4, 2) = -c1;
+    jac(5, 2) = 0;
+
+    jac(0, 3) = c1 * k4;
+    jac(1, 3) = s1 * k4;
+    jac(2, 3) = z4;
+    jac(3, 3) = s1;
+    jac(4, 3) = -c1;
+    jac(5, 3) = 0;
+
+    jac(0, 4) = -d5 * s1 * s5 - d5 * t.c234 * c1 * c5;
+    jac(1, 4) = d5 * c1 * s5 - d5 * t.c234 * c5 * s1;
+    jac(2, 4) = -d5 * t.s234 * c5;
+    jac(3, 4) = t.s234 * c1;
+    jac(4, 4) = t.s234 * s1;
+    jac(5, 4) = -t.c234;
+
+    jac(0, 5) = 0;
+    jac(1, 5) = 0;
+    jac(2, 5) = 0;
+    jac(3, 5) = c5 * s1 - t.c234 * c1 * s5;
+    jac(4, 5) = -c1 * c5 - t.c234 * s1 * s5;
+    jac(5, 5) = -t.s234 * s5;
+
+    return jac;
+}
+
+/**
+ * Compute the jacobian matrix of a UR arm for the given configuration
+ *
+ * @param th The joints configuration, the scalar type of the computation
+ * @return The 6x6 Jacobian matrix
+ */
+template <typename Model, typename Trig = LibmTrig, typename Derived>
+Eigen::Matrix<typename Derived::Scalar, 6, 6> ur_jacobian(const Eigen::MatrixBase<Derived> &th)
+{
+    return ur_jacobian<Model>(JointTrigT<typename Derived::Scalar>(th, Trig()));
+}
+
+/**
+ * Compute direct kinematics and jacobian of a UR arm, sharing the trigonometry of the joints configuration
+ *
+ * @param th The joints configuration
+ * @param jac output - the 6x6 Jacobian matrix
+ * @return The pose of the end effector with respect to the base frame
+ */
+template <typename Model, typename Trig = LibmTrig, typename Scalar>
+RigidTransformT<Scalar> ur_direct_and_jacobian(const JointStateVectorT<Scalar> &th, Eigen::Matrix<Scalar, 6, 6> &jac)
+{
+    JointTrigT<Scalar> t(th, Trig());
+    jac = ur_jacobian<Model>(t);
+    return ur_direct<Model>(t);
+}
+
+/**
+ * Compute the complete inverse kinematics of a UR arm, with the 8 branches laid out across SIMD lanes.
+ * The rows are in the same order of ur5_inverse_complete.
+ *
+ * @param pe The desired cartesian position of the end effector
+ * @param re The desired rotation matrix of the end effector
+ * @param exact output - true for the rows that are exact solutions (the out of reach branches are clamped, not NaN)
+ * @return An 8x6 matrix containing the 8 solutions of the inverse kinematics
+ */
+template <typename Model, typename Trig = LibmTrig, typename Scalar>
+Eigen::Matrix<Scalar, 8, 6> ur_inverse_complete(const CoordinatesT<Scalar> &pe, const RotationMatrixT<Scalar> &re, Eigen::Array<bool, 8, 1> &exact)
+{
+    typedef Eigen::Array<Scalar, 4, 1> Lanes4;
+    typedef Eigen::Array<Scalar, 8, 1> Lanes8;
+    const Scalar d1 = Model::d1(), a2 = Model::a2(), a3 = Model::a3();
+    const Scalar d4 = Model::d4(), d5 = Model::d5(), d6 = Model::d6();
+
+    /* Finding th1: lanes (th1_1, th1_1, th1_2, th1_2) */
+    Scalar p50x = pe(0) - d6 * re(0, 2);
+    Scalar p50y = pe(1) - d6 * re(1, 2);
+    Scalar phi = Trig::atan2(p50y, p50x);
+    Scalar psi = Trig::acos(d4 / std::sqrt(p50x * p50x + p50y * p50y));
+
+    Scalar th1_1 = phi + psi + Scalar(M_PI_2);
+    Scalar th1_2 = phi - psi + Scalar(M_PI_2);
+    Scalar s1_1, c1_1, s1_2, c1_2;
+    Trig::sincos(th1_1, s1_1, c1_1);
+    Trig::sincos(th1_2, s1_2, c1_2);
+
+    Lanes4 th1, s1, c1;
+    th1 << th1_1, th1_1, th1_2, th1_2;
+    s1 << s1_1, s1_1, s1_2, s1_2;
+    c1 << c1_1, c1_1, c1_2, c1_2;
+
+    /* Finding th5: lanes (th5_1, th5_2 = -th5_1, th5_3, th5_4 = -th5_3) */
+    Scalar cos_th5_1 = (pe(0) * s1_1 - pe(1) * c1_1 - d4) / d6;
+    Scalar cos_th5_3 = (pe(0) * s1_2 - pe(1) * c1_2 - d4) / d6;
+    Scalar th5_1 = Trig::acos(ur_clamp_unit(cos_th5_1));
+    Scalar th5_3 = Trig::acos(ur_clamp_unit(cos_th5_3));
+    Scalar s5_1, c5_1, s5_3, c5_3;
+    Trig::sincos(th5_1, s5_1, c5_1);
+    Trig::sincos(th5_3, s5_3, c5_3);
+
+    Lanes4 th5, s5, c5;
+    th5 << th5_1, -th5_1, th5_3, -th5_3;
+    s5 << s5_1, -s5_1, s5_3, -s5_3;
+    c5 << c5_1, c5_1, c5_3, c5_3;
+
+    /* Finding th6: x_hat and y_hat are the first two rows of re (columns of the inverse rotation) */
+    Lanes4 th6 = Trig::lanes_atan2(Lanes4((-re(0, 1) * s1 + re(1, 1) * c1) / s5), Lanes4((re(0, 0) * s1 - re(1, 0) * c1) / s5));
+    Lanes4 s6, c6;
+    Trig::lanes_sincos(th6, s6, c6);
+
+    /* Finding th3: p41 is the origin of frame 4 expressed in frame 1 */
+    Lanes4 p40x = pe(0) + d5 * (re(0, 0) * s6 + re(0, 1) * c6) - d6 * re(0, 2);
+    Lanes4 p40y = pe(1) + d5 * (re(1, 0) * s6 + re(1, 1) * c6) - d6 * re(1, 2);
+    Lanes4 p40z = pe(2) + d5 * (re(2, 0) * s6 + re(2, 1) * c6) - d6 * re(2, 2);
+
+    Lanes4 p41x = c1 * p40x + s1 * p40y;
+    Lanes4 p41z = p40z - d1;
+    Lanes4 p41xz = (p41x * p41x + p41z * p41z).sqrt();
+
+    Lanes4 cos_th3 = (p41xz * p41xz - a2 * a2 - a3 * a3) / (2 * a2 * a3);
+    Lanes4 th3_h = Trig::lanes_acos(Lanes4(cos_th3.unaryExpr(&ur_clamp_unit<Scalar>)));
+    Lanes4 s3_h, c3_h;
+    Trig::lanes_sincos(th3_h, s3_h, c3_h);
+
+    /* Finding th2: the elbow-down half mirrors th3 and the asin term */
+    Lanes4 gamma = Trig::lanes_atan2(Lanes4(-p41z), Lanes4(-p41x));
+    Lanes4 delta = Trig::lanes_asin(Lanes4((-a3 * s3_h / p41xz).unaryExpr(&ur_clamp_unit<Scalar>)));
+
+    Lanes8 th2, th3, s3, c3;
+    th2 << gamma - delta, gamma + delta;
+    th3 << th3_h, -th3_h;
+    s3 << s3_h, -s3_h;
+    c3 << c3_h, c3_h;
+    Lanes8 s2, c2;
+    Trig::lanes_sincos(th2, s2, c2);
+
+    /* Finding th4: x axis of frame 4 rotated back into frame 3 */
+    Lanes4 v0 = c5 * (re(0, 0) * c6 - re(0, 1) * s6) - re(0, 2) * s5;
+    Lanes4 v1 = c5 * (re(1, 0) * c6 - re(1, 1) * s6) - re(1, 2) * s5;
+    Lanes4 v2 = c5 * (re(2, 0) * c6 - re(2, 1) * s6) - re(2, 2) * s5;
+
+    Lanes8 w0, w2;
+    w0 << c1 * v0 + s1 * v1, c1 * v0 + s1 * v1;
+    w2 << v2, v2;
+
+    Lanes8 u0 = c2 * w0 + s2 * w2;
+    Lanes8 u1 = c2 * w2 - s2 * w0;
+    Lanes8 th4 = Trig::lanes_atan2(Lanes8(c3 * u1 - s3 * u0), Lanes8(c3 * u0 + s3 * u1));
+
+    // The clamped arguments give finite angles that do not reach the desired pose (wrist or elbow out of reach)
+    bool wrist_1 = std::abs(cos_th5_1) <= 1;
+    bool wrist_2 = std::abs(cos_th5_3) <= 1;
+    Eigen::Array<bool, 4, 1> exact_h;
+    exact_h << wrist_1, wrist_1, wrist_2, wrist_2;
+    exact_h = exact_h && (cos_th3.abs() <= Scalar(1)) && (s5 != Scalar(0));
+    exact << exact_h, exact_h;
+    exact = exact && th2.isFinite() && th4.isFinite() && th6.template replicate<2, 1>().isFinite();
+
+    Eigen::Matrix<Scalar, 8, 6> th;
+    th.col(0) << th1, th1;
+    th.col(1) = th2;
+    th.col(2) = th3;
+    th.col(3) = th4;
+    th.col(4) << th5, th5;
+    th.col(5) << th6, th6;
+
+    return th;
+}
+
+#endif
@@ -0,0 +1,70 @@
+/**
+* @file ur_models.h
+* @brief Header file for the compile time models (DH parameters) of the Universal Robots arms
+*
+* @date 17/10/2026
+*/
+
+#ifndef __UR_MODELS_H__
+#define __UR_MODELS_H__
+
+/*
+ * All the UR arms share the same kinematic structure:
+ * a = {0, a2, a3, 0, 0, 0}, d = {d1, 0, 0, d4, d5, d6}, alpha = {pi/2, 0, 0, pi/2, -pi/2, 0}.
+ * A model only defines the non-zero parameters as constexpr functions, so the kinematics templates
+ * fold them as constants and the zero terms do not appear in the computations.
+ */
+
+/**
+ * @brief UR3 (CB3 series)
+ */
+struct UR3
+{
+    static constexpr double d1() { return 0.1519; }
+    static constexpr double a2() { return -0.24365; }
+    static constexpr double a3() { return -0.21325; }
+    static constexpr double d4() { return 0.11235; }
+    static constexpr double d5() { return 0.08535; }
+    static constexpr double d6() { return 0.0819; }
+};
+
+/**
+ * @brief UR5 (CB3 series)
+ */
+struct UR5
+{
+    static constexpr double d1() { return 0.089159; }
+    static constexpr double a2() { return -0.425; }
+    static constexpr double a3() { return -0.39225; }
+    static constexpr double d4() { return 0.10915; }
+    static constexpr double d5() { return 0.09465; }
+    static constexpr double d6() { return 0.0823; }
+};
+
+/**
+ * @brief UR10 (CB3 series)
+ */
+struct UR10
+{
+    static constexpr double d1() { return 0.1273; }
+    static constexpr double a2() { return -0.612; }
+    static constexpr double a3() { return -0.5723; }
+    static constexpr double d4() { return 0.163941; }
+    static constexpr double d5() { return 0.1157; }
+    static constexpr double d6() { return 0.0922; }
+};
+
+/**
+ * @brief UR5e (e-Series). The UR5 used in the lab and in locosim has these parameters.
+ */
+struct UR5e
+{
+    static constexpr double d1() { return 0.1625; }
+    static constexpr double a2() { return -0.425; }
+    static constexpr double a3() { return -0.3922; }
+    static constexpr double d4() { return 0.1333; }
+    static constexpr double d5() { return 0.0997; }
+    static constexpr double d6() { return 0.0996; }
+};
+
+#endif
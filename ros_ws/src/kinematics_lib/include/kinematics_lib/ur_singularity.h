@@ -0,0 +1,89 @@
+/**
+* @file ur_singularity.h
+* @brief Header file for the analytic singularity and manipulability measures of the Universal Robots arms
+*
+* @date 17/10/2026
+*/
+
+#ifndef __UR_SINGULARITY_H__
+#define __UR_SINGULARITY_H__
+
+#include <math.h>
+#include <Eigen/Eigenvalues>
+#include "kinematics_lib/ur_kinematics.h"
+
+/*
+ * The jacobian determinant of a UR arm factors in closed form:
+ * det(J) = a2 * a3 * sin(th(2)) * sin(th(4)) * (a2 c(1) + a3 c(1+2) + d5 s(1+2+3)),
+ * one factor for each of the three singular configurations of the arm.
+ */
+
+/**
+ * @brief Singularity factors of a joints configuration
+ */
+struct UrSingularity
+{
+    double shoulder; // distance of the wrist from the axis of joint 1
+    double elbow; // sin(th(2)), zero when the arm is fully stretched or folded
+    double wrist; // sin(th(4)), zero when the axes of joints 4 and 6 are aligned
+    double det; // determinant of the jacobian
+};
+
+/**
+ * Compute the singularity factors and the jacobian determinant of a UR arm, without building the jacobian
+ *
+ * @param t The sines and cosines of the joints configuration
+ * @return The singularity factors
+ */
+template <typename Model>
+UrSingularity ur_singularity(const JointTrig &t)
+{
+    UrSingularity sing;
+    sing.shoulder = Model::a2() * t.c[1] + Model::a3() * t.c23 + Model::d5() * t.s234;
+    sing.elbow = t.s[2];
+    sing.wrist = t.s[4];
+    sing.det = Model::a2() * Model::a3() * sing.elbow * sing.wrist * sing.shoulder;
+    return sing;
+}
+
+/**
+ * Compute the manipulability measure (Yoshikawa) of a UR arm: sqrt(det(J J^T)), i.e. |det(J)| for the square jacobian
+ *
+ * @param t The sines and cosines of the joints configuration
+ * @return The manipulability of the configuration
+ */
+template <typename Model>
+double ur_manipulability(const JointTrig &t)
+{
+    return fabs(ur_singularity<Model>(t).det);
+}
+
+/**
+ * Check whether a configuration is singular: the jacobian determinant or its smallest singular value is below the threshold.
+ * The determinant is computed analytically. The smallest singular value satisfies
+ * sigma_min >= |det| / (||J||_F^2 / 5)^(5/2) (AM-GM on the other five singular values),
+ * so the smallest eigenvalue of J^T J is only checked (Cholesky factorization of J^T J - threshold^2 I) when this bound is not conclusive.
+ *
+ * @param t The sines and cosines of the joints configuration
+ * @param threshold The rejection threshold of both the determinant and the smallest singular value
+ * @return True if the configuration is singular
+ */
+template <typename Model>
+bool ur_is_singular(const JointTrig &t, double threshold)
+{
+    double det = fabs(ur_singularity<Model>(t).det);
+    if (det < threshold)
+        return true;
+
+    Eigen::Matrix<double, 6, 6> jac = ur_jacobian<Model>(t);
+    double mean_sq = jac.squaredNorm() / 5;
+    if (det >= threshold * mean_sq * mean_sq * sqrt(mean_sq))
+        return false;
+
+    // The smallest eigenvalue of J^T J is below threshold^2 if J^T J - threshold^2 I is not positive definite
+    Eigen::Matrix<double, 6, 6> shifted = jac.transpose() * jac;
+    shifted.diagonal().array() -= threshold * threshold;
+    return Eigen::LLT<Eigen::Matrix<double, 6, 6>>(shifted).info() != Eigen::Success;
+}
+
+#endif
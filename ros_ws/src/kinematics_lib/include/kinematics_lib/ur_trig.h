@@ -0,0 +1,297 @@
+/**
+* @file ur_trig.h
+* @brief Header file for the trigonometric policies of the kinematics templates: the C math library,
+* or branch-free polynomial approximations that the compiler can vectorize across the IK lanes
+*
+* @date 17/10/2026
+*/
+
+#ifndef __UR_TRIG_H__
+#define __UR_TRIG_H__
+
+#include <math.h>
+#include <cmath>
+#include <limits>
+#include <Eigen/Dense>
+
+/**
+ * @brief Trigonometry of the C math library (correctly rounded up to 1 ulp), the reference policy
+ */
+struct LibmTrig
+{
+    template <typename Scalar>
+    static Scalar sin(Scalar x) { return std::sin(x); }
+
+    template <typename Scalar>
+    static Scalar cos(Scalar x) { return std::cos(x); }
+
+    template <typename Scalar>
+    static void sincos(Scalar x, Scalar &s, Scalar &c)
+    {
+        s = std::sin(x);
+        c = std::cos(x);
+    }
+
+    template <typename Scalar>
+    static Scalar atan2(Scalar y, Scalar x) { return std::atan2(y, x); }
+
+    template <typename Scalar>
+    static Scalar acos(Scalar x) { return std::acos(x); }
+
+    template <typename Scalar>
+    static Scalar asin(Scalar x) { return std::asin(x); }
+
+    /* Element-wise versions on the lane arrays */
+
+    template <typename Lanes>
+    static void lanes_sincos(const Lanes &x, Lanes &s, Lanes &c)
+    {
+        s = x.sin();
+        c = x.cos();
+    }
+
+    template <typename Lanes>
+    static Lanes lanes_atan2(const Lanes &y, const Lanes &x)
+    {
+        typedef typename Lanes::Scalar Scalar;
+        return y.binaryExpr(x, [](Scalar a, Scalar b) { return std::atan2(a, b); });
+    }
+
+    template <typename Lanes>
+    static Lanes lanes_acos(const Lanes &x) { return x.acos(); }
+
+    template <typename Lanes>
+    static Lanes lanes_asin(const Lanes &x) { return x.asin(); }
+};
+
+/**
+ * Coefficients of the polynomial approximations, for every supported scalar type
+ */
+template <typename Scalar>
+struct PolyTrigCoefficients;
+
+/**
+ * Double precision: minimax kernels of fdlibm (sin and cos on [-pi/4, pi/4]) and of cephes (atan on [0, tan(pi/8)]).
+ * Maximum error about 1e-16 on the reduced arguments.
+ */
+template <>
+struct PolyTrigCoefficients<double>
+{
+    // pi/2 split in three parts for the exact argument reduction (Cody-Waite)
+    static constexpr double pio2_hi = 1.57079632673412561417e+00;
+    static constexpr double pio2_mid = 6.07710050630396597660e-11;
+    static constexpr double pio2_lo = 2.02226624879595063154e-21;
+    // 1.5 * 2^52: adding and subtracting it rounds to the nearest integer
+    static constexpr double round_magic = 6755399441055744.0;
+
+    static double sin_poly(double r, double z)
+    {
+        double p = 1.58969099521155010221e-10;
+        p = p * z - 2.50507602534068634195e-08;
+        p = p * z + 2.75573137070700676789e-06;
+        p = p * z - 1.98412698298579493134e-04;
+        p = p * z + 8.33333333332248946124e-03;
+        p = p * z - 1.66666666666666324348e-01;
+        return r + r * z * p;
+    }
+
+    static double cos_poly(double z)
+    {
+        double p = -1.13596475577881948265e-11;
+        p = p * z + 2.08757232129817482790e-09;
+        p = p * z - 2.75573143513906633035e-07;
+        p = p * z + 2.48015872894767294178e-05;
+        p = p * z - 1.38888888888741095749e-03;
+        p = p * z + 4.16666666666666019037e-02;
+        return 1.0 - 0.5 * z + z * z * p;
+    }
+
+    static double atan_poly(double t, double z)
+    {
+        double p = -8.750608600031904122785e-01;
+        p = p * z - 1.615753718733365076637e+01;
+        p = p * z - 7.500855792314704667340e+01;
+        p = p * z - 1.228866684490136173410e+02;
+        p = p * z - 6.485021904942025371773e+01;
+        double q = z + 2.485846490142306297962e+01;
+        q = q * z + 1.650270098316988542046e+02;
+        q = q * z + 4.328810604912902668951e+02;
+        q = q * z + 4.853903996359136964868e+02;
+        q = q * z + 1.945506571482613964425e+02;
+        return t + t * z * p / q;
+    }
+};
+
+/**
+ * Single precision: minimax kernels of cephes (sinf, cosf, atanf). Maximum error about 1e-7 on the reduced arguments.
+ */
+template <>
+struct PolyTrigCoefficients<float>
+{
+    static constexpr float pio2_hi = 1.5703125f;
+    static constexpr float pio2_mid = 4.837512969970703125e-4f;
+    static constexpr float pio2_lo = 7.54978995489188216e-8f;
+    // 1.5 * 2^23
+    static constexpr float round_magic = 12582912.0f;
+
+    static float sin_poly(float r, float z)
+    {
+        float p = -1.9515295891e-4f;
+        p = p * z + 8.3321608736e-3f;
+        p = p * z - 1.6666654611e-1f;
+        return r + r * z * p;
+    }
+
+    static float cos_poly(float z)
+    {
+        float p = 2.443315711809948e-5f;
+        p = p * z - 1.388731625493765e-3f;
+        p = p * z + 4.166664568298827e-2f;
+        return 1.0f - 0.5f * z + z * z * p;
+    }
+
+    static float atan_poly(float t, float z)
+    {
+        float p = 8.05374449538e-2f;
+        p = p * z - 1.38776856032e-1f;
+        p = p * z + 1.99777106478e-1f;
+        p = p * z - 3.33329491539e-1f;
+        return t + t * z * p;
+    }
+};
+
+/**
+ * @brief Polynomial trigonometry: argument reduction, minimax polynomial and selection of the quadrant,
+ * with no branches and no calls, so the loops over the lanes of the IK are vectorized by the compiler.
+ * The arguments of sin and cos are reduced exactly up to |x| ~ 1e5, far beyond the joint angles.
+ * The maximum error is a few ulp (about 4e-16 in double and 4e-7 in float, see ur_trig_bench).
+ */
+struct PolyTrig
+{
+    /**
+     * Round to the nearest integer, with no calls and no conversions (|x| < 2^51 in double, 2^22 in float)
+     */
+    template <typename Scalar>
+    static Scalar round(Scalar x)
+    {
+        typedef PolyTrigCoefficients<Scalar> K;
+        return (x + K::round_magic) - K::round_magic;
+    }
+
+    template <typename Scalar>
+    static void sincos(Scalar x, Scalar &s, Scalar &c)
+    {
+        typedef PolyTrigCoefficients<Scalar> K;
+
+        // x = k pi/2 + r, with r in [-pi/4, pi/4]
+        Scalar k = round(x * Scalar(M_2_PI));
+        Scalar r = ((x - k * K::pio2_hi) - k * K::pio2_mid) - k * K::pio2_lo;
+        Scalar z = r * r;
+        Scalar sr = K::sin_poly(r, z);
+        Scalar cr = K::cos_poly(z);
+
+        // Quadrant m = k mod 4, and its bits as 0/1 values: sin(r + m pi/2) is sin(r), cos(r), -sin(r), -cos(r).
+        // The selection is arithmetic, the random quadrants of the IK lanes would mispredict the branches.
+        Scalar m = k - 4 * round(k * Scalar(0.25) - Scalar(0.375));
+        Scalar high = round(m * Scalar(0.5) - Scalar(0.25));
+        Scalar odd = m - 2 * high;
+        Scalar ss = (1 - odd) * sr + odd * cr;
+        Scalar cc = (1 - odd) * cr + odd * sr;
+        s = ss * (1 - 2 * high);
+        c = cc * (1 - 2 * (odd - high) * (odd - high));
+    }
+
+    template <typename Scalar>
+    static Scalar sin(Scalar x)
+    {
+        Scalar s, c;
+        sincos(x, s, c);
+        return s;
+    }
+
+    template <typename Scalar>
+    static Scalar cos(Scalar x)
+    {
+        Scalar s, c;
+        sincos(x, s, c);
+        return c;
+    }
+
+    template <typename Scalar>
+    static Scalar atan2(Scalar y, Scalar x)
+    {
+        typedef PolyTrigCoefficients<Scalar> K;
+        const Scalar pi = Scalar(M_PI);
+        const Scalar tan_pi_8 = Scalar(0.41421356237309504880);
+
+        // atan of the ratio in [0, 1], reduced to [-tan(pi/8), tan(pi/8)] by atan(a) = pi/4 + atan((a - 1) / (a + 1)).
+        // The octants are selected with 0/1 values taken from the signs, as the quadrants of sincos:
+        // the compiler does not vectorize the loops with comparisons that guard a division.
+        const Scalar tiny = std::numeric_limits<Scalar>::min();
+        Scalar ax = std::abs(x), ay = std::abs(y);
+        Scalar mn = std::min(ax, ay);
+        Scalar mx = ax + ay - mn; // propagates NaN, unlike max
+        Scalar a = mn / std::max(mx, tiny);
+        Scalar upper = Scalar(0.5) + Scalar(0.5) * std::copysign(Scalar(1), a - tan_pi_8); // a >= tan(pi/8)
+        Scalar t = (a - upper) / (1 + upper * a);
+        Scalar r = K::atan_poly(t, t * t) + upper * Scalar(M_PI_4);
+
+        // Octant and sign, the signed zeros follow the C library
+        Scalar swap = Scalar(0.5) - Scalar(0.5) * std::copysign(Scalar(1), ax - ay); // ay > ax
+        r += swap * (Scalar(M_PI_2) - 2 * r);
+        Scalar negative_x = Scalar(0.5) - Scalar(0.5) * std::copysign(Scalar(1), x);
+        r += negative_x * (pi - 2 * r);
+        return std::copysign(r, y);
+    }
+
+    template <typename Scalar>
+    static Scalar acos(Scalar x)
+    {
+        // NaN for |x| > 1, as the C library
+        return atan2(std::sqrt((1 - x) * (1 + x)), x);
+    }
+
+    template <typename Scalar>
+    static Scalar asin(Scalar x)
+    {
+        return atan2(x, std::sqrt((1 - x) * (1 + x)));
+    }
+
+    /* Element-wise versions on the lane arrays: plain loops over the lanes, vectorized by the compiler (-O3) */
+
+    template <typename Lanes>
+    static void lanes_sincos(const Lanes &x, Lanes &s, Lanes &c)
+    {
+        for (int i = 0; i < Lanes::SizeAtCompileTime; i++)
+            sincos(x(i), s(i), c(i));
+    }
+
+    template <typename Lanes>
+    static Lanes lanes_atan2(const Lanes &y, const Lanes &x)
+    {
+        Lanes r;
+        for (int i = 0; i < Lanes::SizeAtCompileTime; i++)
+            r(i) = atan2(y(i), x(i));
+        return r;
+    }
+
+    template <typename Lanes>
+    static Lanes lanes_acos(const Lanes &x)
+    {
+        Lanes r;
+        for (int i = 0; i < Lanes::SizeAtCompileTime; i++)
+            r(i) = acos(x(i));
+        return r;
+    }
+
+    template <typename Lanes>
+    static Lanes lanes_asin(const Lanes &x)
+    {
+        Lanes r;
+        for (int i = 0; i < Lanes::SizeAtCompileTime; i++)
+            r(i) = asin(x(i));
+        return r;
+    }
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "kinematics_lib/cartesian_path.h"
+#include "kinematics_lib/ur5_kinematics.h"
+
+/* Peak of the derivative of the quintic time law 10 t^3 - 15 t^4 + 6 t^5 */
+static const double quintic_peak = 1.875;
+
+/* Public functions */
+
+CartesianPath::CartesianPath(const RigidTransform &start, const RigidTransform &goal, double max_linear_velocity, double max_angular_velocity)
+    : start_pos(start.pos), delta_pos(goal.pos - start.pos), start_rot(start.rot)
+{
+    // The relative rotation in the base frame: goal.rot = R(axis, angle) * start.rot
+    Eigen::AngleAxisd relative(goal.rot * start.rot.transpose());
+    axis = relative.axis();
+    angle = relative.angle();
+
+    // Slowest of the two motions at the peak velocity of the time law
+    duration = std::max(quintic_peak * delta_pos.norm() / max_linear_velocity, quintic_peak * angle / max_angular_velocity);
+}
+
+double CartesianPath::get_duration(void) const
+{
+    return duration;
+}
+
+RigidTransform CartesianPath::pose(double t) const
+{
+    double s, ds;
+    time_law(t, s, ds);
+    return RigidTransform(Eigen::AngleAxisd(s * angle, axis).toRotationMatrix() * start_rot, start_pos + s * delta_pos);
+}
+
+Twist CartesianPath::twist(double t) const
+{
+    double s, ds;
+    time_law(t, s, ds);
+    Twist v;
+    v << ds * delta_pos, ds * angle * axis;
+    return v;
+}
+
+Twist pose_error(const RigidTransform &desired, const RigidTransform &current)
+{
+    Eigen::AngleAxisd rotation_error(desired.rot * current.rot.transpose());
+    Twist error;
+    error << desired.pos - current.pos, rotation_error.angle() * rotation_error.axis();
+    return error;
+}
+
+JointStateVector ur5_differential_ik(const JointStateVector &th, const RigidTransform &desired, const Twist &twist, double dt,
+    double gain, double damping, Twist *error)
+{
+    RigidTransform current;
+    Eigen::Matrix<double, 6, 6> jac;
+    ur5_direct_and_jacobian(th, current.pos, current.rot, jac);
+
+    Twist e = pose_error(desired, current);
+    if (error)
+        *error = e;
+
+    // Damped least squares: the 6x6 system is symmetric positive definite
+    Twist v = twist + gain * e;
+    Eigen::Matrix<double, 6, 6> a = jac * jac.transpose() + damping * damping * Eigen::Matrix<double, 6, 6>::Identity();
+    JointStateVector dq = jac.transpose() * a.ldlt().solve(v);
+    return th + dq * dt;
+}
+
+/* Private functions */
+
+void CartesianPath::time_law(double t, double &s, double &ds) const
+{
+    if (duration <= 0)
+    {
+        s = 1;
+        ds = 0;
+        return;
+    }
+    double tau = std::min(std::max(t / duration, 0.0), 1.0);
+    double tau2 = tau * tau;
+    s = tau2 * tau * (10 - 15 * tau + 6 * tau2);
+    ds = 30 * tau2 * (1 - 2 * tau + tau2) / duration;
+}
\ No newline at end of file
@@ -0,0 +1,522 @@
+#include "kinematics_lib/collision.h"
+#include "kinematics_lib/ur5_kinematics.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+/* Accuracy of the clearance of the links from the boxes, the distances are rounded down */
+static const double clearance_tolerance = 0.001;
+
+/* Link radii of the UR5, including a small margin on the datasheet dimensions */
+static const double shoulder_radius = 0.075;
+static const double upper_arm_radius = 0.06;
+static const double forearm_radius = 0.05;
+static const double wrist_radius = 0.045;
+
+/**
+ * Golden section search of the minimum distance between a segment and a box, on [0, 1] (the distance is convex).
+ * The search stops as soon as a distance below the threshold is found, or when the bracket of the minimum
+ * is shorter than the tolerance: then the result is lowered by the tolerance, a lower bound of the distance.
+ */
+static double segment_box_search(const Coordinates &p0, const Coordinates &p1, const OrientedBox &box, double threshold, double tolerance)
+{
+    // Segment in the frame of the box
+    Coordinates a = box.rot.transpose() * (p0 - box.center);
+    Coordinates b = box.rot.transpose() * (p1 - box.center);
+    auto distance = [&](double t)
+    {
+        Coordinates p = a + (b - a) * t;
+        return (p.cwiseAbs() - box.half_extents).cwiseMax(0.0).norm();
+    };
+
+    double f0 = distance(0), f3 = distance(1);
+    if (std::min(f0, f3) <= threshold)
+        return std::min(f0, f3);
+
+    const double ratio = 0.618033988749895;
+    double low = 0, high = 1;
+    double t1 = high - ratio * (high - low), t2 = low + ratio * (high - low);
+    double f1 = distance(t1), f2 = distance(t2);
+    // The distance changes at most by the length of the segment over the bracket
+    double length = (b - a).norm();
+    for (int i = 0; i < 40 && std::min(f1, f2) > threshold && (high - low) * length > tolerance; i++)
+    {
+        if (f1 < f2)
+        {
+            high = t2;
+            t2 = t1;
+            f2 = f1;
+            t1 = high - ratio * (high - low);
+            f1 = distance(t1);
+        }
+        else
+        {
+            low = t1;
+            t1 = t2;
+            f1 = f2;
+            t2 = low + ratio * (high - low);
+            f2 = distance(t2);
+        }
+    }
+    double result = std::min(std::min(f1, f2), std::min(f0, f3));
+    if (tolerance > 0 && result > threshold && (high - low) * length <= tolerance)
+        return std::max(result - tolerance, 0.0);
+    return result;
+}
+
+/* Public functions */
+
+double segment_distance(const Coordinates &p0, const Coordinates &p1, const Coordinates &q0, const Coordinates &q1)
+{
+    // Closest points of the two lines, clamped to the segments
+    Coordinates d1 = p1 - p0, d2 = q1 - q0, r = p0 - q0;
+    double a = d1.squaredNorm(), e = d2.squaredNorm(), f = d2.dot(r);
+    double s, t;
+    const double eps = 1e-12;
+
+    if (a <= eps && e <= eps)
+        return r.norm();
+    if (a <= eps)
+    {
+        s = 0;
+        t = std::min(std::max(f / e, 0.0), 1.0);
+    }
+    else
+    {
+        double c = d1.dot(r);
+        if (e <= eps)
+        {
+            t = 0;
+            s = std::min(std::max(-c / a, 0.0), 1.0);
+        }
+        else
+        {
+            double b = d1.dot(d2), denom = a * e - b * b;
+            s = denom > eps ? std::min(std::max((b * f - c * e) / denom, 0.0), 1.0) : 0;
+            t = (b * s + f) / e;
+            if (t < 0)
+            {
+                t = 0;
+                s = std::min(std::max(-c / a, 0.0), 1.0);
+            }
+            else if (t > 1)
+            {
+                t = 1;
+                s = std::min(std::max((b - c) / a, 0.0), 1.0);
+            }
+        }
+    }
+    return ((p0 + d1 * s) - (q0 + d2 * t)).norm();
+}
+
+double segment_box_distance(const Coordinates &p0, const Coordinates &p1, const OrientedBox &box, double tolerance)
+{
+    return segment_box_search(p0, p1, box, 0, tolerance);
+}
+
+bool collide(const Capsule &first, const Capsule &second)
+{
+    return segment_distance(first.a, first.b, second.a, second.b) <= first.radius + second.radius;
+}
+
+bool collide(const Capsule &capsule, const OrientedBox &box)
+{
+    // The bounding sphere of the box is a cheap rejection test
+    double box_radius = box.half_extents.norm();
+    if (segment_distance(capsule.a, capsule.b, box.center, box.center) > capsule.radius + box_radius)
+        return false;
+    return segment_box_search(capsule.a, capsule.b, box, capsule.radius, 0) <= capsule.radius;
+}
+
+void AABBTree::build(const std::vector<AABB> &bounds)
+{
+    nodes.clear();
+    std::vector<std::pair<AABB, int>> items;
+    for (int i = 0; i < (int)bounds.size(); i++)
+        items.push_back(std::make_pair(bounds[i], i));
+    if (!items.empty())
+        build(items, 0, items.size());
+}
+
+int AABBTree::size(void) const
+{
+    return nodes.size();
+}
+
+UR5LinkCapsules ur5_link_capsules(const JointStateVector &th, double gripper_length, double gripper_radius)
+{
+    // Frames of the DH chain
+    RigidTransform t1 = ur_t10<UR5Model>(th(0));
+    RigidTransform t2 = t1 * ur_t21<UR5Model>(th(1));
+    RigidTransform t3 = t2 * ur_t32<UR5Model>(th(2));
+    RigidTransform t4 = t3 * ur_t43<UR5Model>(th(3));
+    RigidTransform t5 = t4 * ur_t54<UR5Model>(th(4));
+    RigidTransform t6 = t5 * ur_t65<UR5Model>(th(5));
+
+    // The forearm ends at the elbow offset a3, the first wrist is the d4 offset
+    Coordinates wrist_1 = t3 * Coordinates(UR5Model::a3(), 0, 0);
+
+    UR5LinkCapsules links;
+    links[0] = {Coordinates::Zero(), t1.pos, shoulder_radius};
+    links[1] = {t2.pos, t3.pos, upper_arm_radius};
+    links[2] = {t3.pos, wrist_1, forearm_radius};
+    links[3] = {wrist_1, t4.pos, wrist_radius};
+    links[4] = {t4.pos, t5.pos, wrist_radius};
+    links[5] = {t5.pos, t6.pos, wrist_radius};
+    links[6] = {t6.pos, t6.pos + gripper_length * t6.rot.col(2), gripper_radius};
+    return links;
+}
+
+CollisionScene::CollisionScene() : gripper_length(0), gripper_radius(0), padding(0)
+{
+    update_sweep_radius();
+}
+
+bool CollisionScene::load(const std::string &file)
+{
+    std::ifstream in(file);
+    if (!in)
+        return false;
+
+    // Parsed into a new scene, which replaces this one only if the whole file is valid
+    CollisionScene scene;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string type, name;
+        if (!(fields >> type) || type[0] == '#')
+            continue;
+
+        if (type == "box")
+        {
+            double x, y, z, roll, pitch, yaw, hx, hy, hz;
+            if (!(fields >> name >> x >> y >> z >> roll >> pitch >> yaw >> hx >> hy >> hz))
+                return false;
+            scene.add_box(name, {Coordinates(x, y, z), euler_to_rot(roll, pitch, yaw), Coordinates(hx, hy, hz)});
+        }
+        else if (type == "capsule")
+        {
+            double ax, ay, az, bx, by, bz, r;
+            if (!(fields >> name >> ax >> ay >> az >> bx >> by >> bz >> r))
+                return false;
+            scene.add_capsule(name, {Coordinates(ax, ay, az), Coordinates(bx, by, bz), r});
+        }
+        else if (type == "sphere")
+        {
+            double x, y, z, r;
+            if (!(fields >> name >> x >> y >> z >> r))
+                return false;
+            scene.add_capsule(name, {Coordinates(x, y, z), Coordinates(x, y, z), r});
+        }
+        else if (type == "gripper")
+        {
+            if (!(fields >> scene.gripper_length >> scene.gripper_radius))
+                return false;
+        }
+        else if (type == "padding")
+        {
+            if (!(fields >> scene.padding))
+                return false;
+        }
+        else if (type == "grasp")
+        {
+            if (!(fields >> name))
+                return false;
+            scene.allow_grasp(name);
+        }
+        else
+            return false;
+    }
+
+    // The grasp obstacles must be in the scene
+    for (const std::string &grasp : scene.grasp_names)
+        if (std::find(scene.names.begin(), scene.names.end(), grasp) == scene.names.end())
+            return false;
+
+    scene.update_sweep_radius();
+    scene.build();
+    *this = std::move(scene);
+    return true;
+}
+
+void CollisionScene::add_box(const std::string &name, const OrientedBox &box)
+{
+    names.insert(names.begin() + boxes.size(), name);
+    boxes.push_back(box);
+}
+
+void CollisionScene::add_capsule(const std::string &name, const Capsule &capsule)
+{
+    names.push_back(name);
+    capsules.push_back(capsule);
+}
+
+void CollisionScene::allow_grasp(const std::string &name)
+{
+    grasp_names.push_back(name);
+}
+
+void CollisionScene::set_robot(double gripper_length, double gripper_radius, double padding)
+{
+    this->gripper_length = gripper_length;
+    this->gripper_radius = gripper_radius;
+    this->padding = padding;
+    update_sweep_radius();
+}
+
+void CollisionScene::build(void)
+{
+    std::vector<AABB> bounds;
+    for (const OrientedBox &box : boxes)
+        bounds.push_back(box.bounds());
+    for (const Capsule &capsule : capsules)
+        bounds.push_back(capsule.bounds());
+    tree.build(bounds);
+
+    graspable.clear();
+    for (const std::string &name : names)
+        graspable.push_back(std::find(grasp_names.begin(), grasp_names.end(), name) != grasp_names.end());
+}
+
+bool CollisionScene::empty(void) const
+{
+    return boxes.empty() && capsules.empty();
+}
+
+int CollisionScene::size(void) const
+{
+    return boxes.size() + capsules.size();
+}
+
+int CollisionScene::first_collision(const UR5LinkCapsules &links, bool broadphase, bool grasping) const
+{
+    int hit = -1;
+    for (int i = 0; i < 7; i++)
+    {
+        Capsule link = links[i];
+        link.radius += padding;
+        // The gripper is the last link
+        bool skip_grasp = grasping && i == 6;
+        if (broadphase)
+        {
+            tree.query(link.bounds(), [&](int item)
+            {
+                if (!(skip_grasp && graspable[item]) && collide_item(link, item))
+                    hit = item;
+                return hit >= 0;
+            });
+        }
+        else
+        {
+            for (int item = 0; item < size() && hit < 0; item++)
+                if (!(skip_grasp && graspable[item]) && collide_item(link, item))
+                    hit = item;
+        }
+        if (hit >= 0)
+            return hit;
+    }
+    return -1;
+}
+
+UR5LinkCapsules CollisionScene::robot_links(const JointStateVector &th) const
+{
+    return ur5_link_capsules(th, gripper_length, gripper_radius);
+}
+
+bool CollisionScene::in_collision(const JointStateVector &th, bool grasping) const
+{
+    if (empty())
+        return false;
+    return first_collision(robot_links(th), true, grasping) >= 0;
+}
+
+UR5LinkDistances CollisionScene::clearance(const JointStateVector &th, double max_distance) const
+{
+    UR5LinkDistances distances;
+    UR5LinkCapsules links = robot_links(th);
+    for (int i = 0; i < 7; i++)
+    {
+        Capsule link = links[i];
+        link.radius += padding;
+
+        // Only the obstacles overlapping the bounds inflated by the current distance can be closer
+        double distance = max_distance;
+        AABB bounds = link.bounds();
+        bounds.min.array() -= max_distance;
+        bounds.max.array() += max_distance;
+        tree.query(bounds, [&](int item)
+        {
+            distance = std::min(distance, distance_item(link, item, distance));
+            return distance <= 0;
+        });
+        distances[i] = distance;
+    }
+    return distances;
+}
+
+UR5LinkDistances CollisionScene::motion_bound(const JointStateVector &delta) const
+{
+    UR5LinkDistances bound;
+    for (int i = 0; i < 7; i++)
+    {
+        bound[i] = 0;
+        for (int j = 0; j < 6; j++)
+            bound[i] += std::abs(delta(j)) * sweep_radius[j][i];
+    }
+    return bound;
+}
+
+bool CollisionScene::check_motion(const JointStateVector &from, const JointStateVector &to, const ClearanceFunction &clearance, double max_step,
+    int *evaluations, const std::atomic<bool> *cancelled) const
+{
+    // Segment of the motion with the clearances at its ends
+    struct Segment
+    {
+        JointStateVector from, to;
+        UR5LinkDistances from_clearance, to_clearance;
+    };
+
+    // Below this length the clearance is considered too small to prove the segment safe
+    const double min_step = 1e-4;
+    int count = 2;
+    Segment first;
+    first.from = from;
+    first.to = to;
+    bool valid = clearance(from, first.from_clearance) && clearance(to, first.to_clearance);
+
+    std::vector<Segment> stack;
+    if (valid)
+        stack.push_back(first);
+    while (valid && !stack.empty())
+    {
+        if (cancelled && *cancelled)
+        {
+            valid = false;
+            break;
+        }
+
+        Segment segment = stack.back();
+        stack.pop_back();
+
+        JointStateVector delta = segment.to - segment.from;
+        double step = delta.cwiseAbs().maxCoeff();
+        UR5LinkDistances bound = motion_bound(delta);
+        bool safe = step <= max_step;
+        for (int i = 0; i < 7 && safe; i++)
+            safe = segment.from_clearance[i] + segment.to_clearance[i] > bound[i];
+        if (safe)
+            continue;
+
+        if (step < min_step)
+        {
+            valid = false;
+            break;
+        }
+
+        // Split at the middle configuration, the first half is checked first
+        Segment second = segment;
+        segment.to = second.from = (segment.from + segment.to) / 2;
+        count++;
+        if (!clearance(second.from, second.from_clearance))
+        {
+            valid = false;
+            break;
+        }
+        segment.to_clearance = second.from_clearance;
+        stack.push_back(second);
+        stack.push_back(segment);
+    }
+
+    if (evaluations)
+        *evaluations = count;
+    return valid;
+}
+
+std::string CollisionScene::name(int item) const
+{
+    return item >= 0 && item < (int)names.size() ? names[item] : "";
+}
+
+/* Private functions */
+
+int AABBTree::build(std::vector<std::pair<AABB, int>> &items, int first, int last)
+{
+    AABB bounds = items[first].first;
+    for (int i = first + 1; i < last; i++)
+        bounds = bounds.merge(items[i].first);
+
+    // The node is stored before its children, the root is the first node
+    int index = nodes.size();
+    TreeNode node = {bounds, -1, -1, last - first == 1 ? items[first].second : -1};
+    nodes.push_back(node);
+    if (last - first == 1)
+        return index;
+
+    // Split at the median center along the longest axis
+    int axis;
+    (bounds.max - bounds.min).maxCoeff(&axis);
+    int middle = (first + last) / 2;
+    std::nth_element(items.begin() + first, items.begin() + middle, items.begin() + last,
+        [axis](const std::pair<AABB, int> &u, const std::pair<AABB, int> &v)
+        {
+            return u.first.min(axis) + u.first.max(axis) < v.first.min(axis) + v.first.max(axis);
+        });
+
+    int left = build(items, first, middle);
+    int right = build(items, middle, last);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+bool CollisionScene::collide_item(const Capsule &link, int item) const
+{
+    if (item < (int)boxes.size())
+        return collide(link, boxes[item]);
+    return collide(link, capsules[item - boxes.size()]);
+}
+
+double CollisionScene::distance_item(const Capsule &link, int item, double max_distance) const
+{
+    if (item < (int)boxes.size())
+    {
+        // The bounding sphere of the box gives a lower bound, the exact distance is needed only below max_distance
+        const OrientedBox &box = boxes[item];
+        double lower = segment_distance(link.a, link.b, box.center, box.center) - box.half_extents.norm() - link.radius;
+        if (lower >= max_distance)
+            return lower;
+        double distance = segment_box_distance(link.a, link.b, box, clearance_tolerance) - link.radius;
+        return distance > 0 ? distance : segment_box_distance(link.a, link.b, box) - link.radius;
+    }
+    const Capsule &obstacle = capsules[item - boxes.size()];
+    return segment_distance(link.a, link.b, obstacle.a, obstacle.b) - link.radius - obstacle.radius;
+}
+
+void CollisionScene::update_sweep_radius(void)
+{
+    // Points of the chain: the links go from point i to point i + 1
+    UR5LinkCapsules links = ur5_link_capsules(JointStateVector::Zero(), gripper_length, gripper_radius);
+    UR5LinkDistances lengths;
+    for (int i = 0; i < 7; i++)
+        lengths[i] = (links[i].b - links[i].a).norm();
+
+    // First point of the chain on the axis of every joint: the links before it are not moved by the joint
+    const int axis_point[6] = {1, 1, 2, 4, 5, 6};
+    for (int j = 0; j < 6; j++)
+    {
+        double chain = 0;
+        for (int i = 0; i < 7; i++)
+        {
+            if (i < axis_point[j])
+            {
+                sweep_radius[j][i] = 0;
+                continue;
+            }
+            chain += lengths[i];
+            sweep_radius[j][i] = chain + links[i].radius + padding;
+        }
+    }
+}
\ No newline at end of file
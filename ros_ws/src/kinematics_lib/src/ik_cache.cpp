@@ -0,0 +1,92 @@
+#include "kinematics_lib/ik_cache.h"
+
+/* Public functions */
+
+size_t IKCache::KeyHash::operator()(const Key &key) const
+{
+    // FNV-1a over the quantized components
+    size_t hash = 14695981039346656037ULL;
+    for (int32_t value : key)
+    {
+        hash ^= (uint32_t)value;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+IKCache::IKCache(int capacity, double position_resolution, double rotation_resolution)
+    : capacity(capacity), position_resolution(position_resolution), rotation_resolution(rotation_resolution)
+{
+    stats = IKCacheStats();
+}
+
+bool IKCache::find(const Coordinates &pos, const RotationMatrix &rot, IKCacheEntry &entry)
+{
+    Key key = quantize(pos, rot);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end())
+    {
+        stats.misses++;
+        return false;
+    }
+
+    // Move the entry to the front of the list
+    entries.splice(entries.begin(), entries, it->second);
+    entry = it->second->second;
+    stats.hits++;
+    return true;
+}
+
+void IKCache::insert(const Coordinates &pos, const RotationMatrix &rot, const std::vector<JointStateVector> &solutions)
+{
+    Key key = quantize(pos, rot);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    else if ((int)entries.size() >= capacity && !entries.empty())
+    {
+        index.erase(entries.back().first);
+        entries.pop_back();
+        stats.evictions++;
+    }
+
+    entries.push_front(std::make_pair(key, IKCacheEntry{pos, rot, solutions}));
+    index[key] = entries.begin();
+}
+
+void IKCache::clear(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+IKCacheStats IKCache::get_stats(void) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    IKCacheStats current = stats;
+    current.size = entries.size();
+    return current;
+}
+
+/* Private functions */
+
+IKCache::Key IKCache::quantize(const Coordinates &pos, const RotationMatrix &rot) const
+{
+    // q and -q are the same rotation: the scalar part is made positive
+    Eigen::Quaterniond q(rot);
+    if (q.w() < 0)
+        q.coeffs() = -q.coeffs();
+
+    Key key;
+    for (int i = 0; i < 3; i++)
+        key[i] = (int32_t)std::lround(pos(i) / position_resolution);
+    for (int i = 0; i < 4; i++)
+        key[3 + i] = (int32_t)std::lround(q.coeffs()(i) / rotation_resolution);
+    return key;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "kinematics_lib/jitter_histogram.h"
+
+/* Public functions */
+
+JitterHistogram::JitterHistogram(double bin_width, int n_bins)
+    : bin_width(bin_width), n_bins(n_bins), counts(new std::atomic<long>[n_bins + 1]), overruns(0), max_latency(0)
+{
+    for (int i = 0; i <= n_bins; i++)
+        counts[i].store(0, std::memory_order_relaxed);
+}
+
+void JitterHistogram::record(double latency, bool overrun)
+{
+    // Single writer: plain loads and stores of the atomics, no read-modify-write
+    int bin = latency < 0 ? 0 : (int)(latency / bin_width);
+    if (bin > n_bins)
+        bin = n_bins;
+    counts[bin].store(counts[bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (overrun)
+        overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (latency > max_latency.load(std::memory_order_relaxed))
+        max_latency.store(latency, std::memory_order_relaxed);
+}
+
+std::vector<long> JitterHistogram::bins(void) const
+{
+    std::vector<long> result(n_bins + 1);
+    for (int i = 0; i <= n_bins; i++)
+        result[i] = counts[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+JitterStats JitterHistogram::stats(void) const
+{
+    std::vector<long> b = bins();
+    JitterStats result = JitterStats();
+    for (long count : b)
+        result.cycles += count;
+    result.overruns = overruns.load(std::memory_order_relaxed);
+    result.max_latency = max_latency.load(std::memory_order_relaxed);
+    result.p50_latency = quantile(b, result.cycles, 0.5);
+    result.p99_latency = quantile(b, result.cycles, 0.99);
+    result.p999_latency = quantile(b, result.cycles, 0.999);
+    return result;
+}
+
+double JitterHistogram::get_bin_width(void) const
+{
+    return bin_width;
+}
+
+/* Private functions */
+
+double JitterHistogram::quantile(const std::vector<long> &bins, long total, double q) const
+{
+    if (total == 0)
+        return 0;
+
+    // The overflow bin has no upper bound, the maximum is used instead
+    long cumulative = 0;
+    for (int i = 0; i < n_bins; i++)
+    {
+        cumulative += bins[i];
+        if (cumulative >= q * total)
+            return (i + 1) * bin_width;
+    }
+    return max_latency.load(std::memory_order_relaxed);
+}
\ No newline at end of file
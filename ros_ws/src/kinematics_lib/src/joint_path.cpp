@@ -0,0 +1,175 @@
+#include "kinematics_lib/joint_path.h"
+#include <algorithm>
+
+/* Public functions */
+
+WaypointPath::WaypointPath(const std::vector<JointStateVector> &waypoints)
+{
+    for (const JointStateVector &q : waypoints)
+    {
+        if (this->waypoints.empty())
+            knots.push_back(0);
+        else if ((q - this->waypoints.back()).norm() > 0)
+            knots.push_back(knots.back() + (q - this->waypoints.back()).norm());
+        else
+            continue;
+        this->waypoints.push_back(q);
+    }
+
+    // Natural spline: M(0) = M(n) = 0, tridiagonal system for the inner second derivatives (Thomas algorithm)
+    int n = this->waypoints.size() - 1;
+    second_derivatives.assign(n + 1, JointStateVector::Zero());
+    if (n < 2)
+        return;
+
+    std::vector<double> c(n + 1, 0);
+    std::vector<JointStateVector> d(n + 1, JointStateVector::Zero());
+    for (int k = 1; k < n; k++)
+    {
+        double h0 = knots[k] - knots[k - 1], h1 = knots[k + 1] - knots[k];
+        JointStateVector rhs = 6 * ((this->waypoints[k + 1] - this->waypoints[k]) / h1 - (this->waypoints[k] - this->waypoints[k - 1]) / h0);
+        double diag = 2 * (h0 + h1) - h0 * c[k - 1];
+        c[k] = h1 / diag;
+        d[k] = (rhs - h0 * d[k - 1]) / diag;
+    }
+    for (int k = n - 1; k > 0; k--)
+        second_derivatives[k] = d[k] - c[k] * second_derivatives[k + 1];
+}
+
+double WaypointPath::length(void) const
+{
+    return knots.empty() ? 0 : knots.back();
+}
+
+JointStateVector WaypointPath::position(double s) const
+{
+    int k = segment(s);
+    if (k < 0)
+        return waypoints[0];
+
+    double h = knots[k + 1] - knots[k];
+    double a = (knots[k + 1] - s) / h, b = (s - knots[k]) / h;
+    return a * waypoints[k] + b * waypoints[k + 1] +
+        ((a * a * a - a) * second_derivatives[k] + (b * b * b - b) * second_derivatives[k + 1]) * (h * h) / 6;
+}
+
+JointStateVector WaypointPath::derivative(double s) const
+{
+    int k = segment(s);
+    if (k < 0)
+        return JointStateVector::Zero();
+
+    double h = knots[k + 1] - knots[k];
+    double a = (knots[k + 1] - s) / h, b = (s - knots[k]) / h;
+    return (waypoints[k + 1] - waypoints[k]) / h +
+        (-(3 * a * a - 1) * second_derivatives[k] + (3 * b * b - 1) * second_derivatives[k + 1]) * h / 6;
+}
+
+JointStateVector WaypointPath::second_derivative(double s) const
+{
+    int k = segment(s);
+    if (k < 0)
+        return JointStateVector::Zero();
+
+    double h = knots[k + 1] - knots[k];
+    double a = (knots[k + 1] - s) / h, b = (s - knots[k]) / h;
+    return a * second_derivatives[k] + b * second_derivatives[k + 1];
+}
+
+BlendedPath::BlendedPath(const std::vector<JointStateVector> &waypoints, double tolerance)
+{
+    std::vector<JointStateVector> points;
+    for (const JointStateVector &q : waypoints)
+        if (points.empty() || (q - points.back()).norm() > 0)
+            points.push_back(q);
+
+    double s = 0;
+    JointStateVector line_start = points.front();
+    for (int k = 1; k < (int)points.size(); k++)
+    {
+        JointStateVector direction = (points[k] - points[k - 1]).normalized();
+
+        // Blend around the via-point k: from d before it to d after it
+        double d = 0;
+        JointStateVector next_direction = JointStateVector::Zero();
+        if (k + 1 < (int)points.size())
+        {
+            next_direction = (points[k + 1] - points[k]).normalized();
+            d = std::min(2 * tolerance, std::min((points[k] - points[k - 1]).norm(), (points[k + 1] - points[k]).norm()) / 2);
+        }
+
+        JointStateVector line_end = points[k] - d * direction;
+        double line_length = (line_end - line_start).norm();
+        if (line_length > 0)
+        {
+            segments.push_back({s, line_length, false, line_start, direction, JointStateVector::Zero()});
+            s += line_length;
+        }
+
+        if (d > 0)
+        {
+            // Control points: the tangent at both ends matches the straight segments (unit speed)
+            segments.push_back({s, 2 * d, true, line_end, points[k], points[k] + d * next_direction});
+            s += 2 * d;
+        }
+        line_start = points[k] + d * next_direction;
+    }
+
+    if (segments.empty())
+        segments.push_back({0, 0, false, points.front(), JointStateVector::Zero(), JointStateVector::Zero()});
+}
+
+double BlendedPath::length(void) const
+{
+    return segments.back().s0 + segments.back().length;
+}
+
+JointStateVector BlendedPath::position(double s) const
+{
+    const Segment &seg = segment(s);
+    if (!seg.blend)
+        return seg.a + (s - seg.s0) * seg.b;
+
+    double t = (s - seg.s0) / seg.length;
+    return (1 - t) * (1 - t) * seg.a + 2 * t * (1 - t) * seg.b + t * t * seg.c;
+}
+
+JointStateVector BlendedPath::derivative(double s) const
+{
+    const Segment &seg = segment(s);
+    if (!seg.blend)
+        return seg.b;
+
+    double t = (s - seg.s0) / seg.length;
+    return (2 * (1 - t) * (seg.b - seg.a) + 2 * t * (seg.c - seg.b)) / seg.length;
+}
+
+JointStateVector BlendedPath::second_derivative(double s) const
+{
+    const Segment &seg = segment(s);
+    if (!seg.blend)
+        return JointStateVector::Zero();
+
+    return 2 * (seg.a - 2 * seg.b + seg.c) / (seg.length * seg.length);
+}
+
+/* Private functions */
+
+int WaypointPath::segment(double &s) const
+{
+    if (knots.size() < 2)
+        return -1;
+
+    s = std::min(std::max(s, 0.0), knots.back());
+    int k = std::upper_bound(knots.begin(), knots.end(), s) - knots.begin() - 1;
+    return std::min(k, (int)knots.size() - 2);
+}
+
+const BlendedPath::Segment &BlendedPath::segment(double &s) const
+{
+    s = std::min(std::max(s, 0.0), length());
+    int k = segments.size() - 1;
+    while (k > 0 && segments[k].s0 > s)
+        k--;
+    return segments[k];
+}
\ No newline at end of file
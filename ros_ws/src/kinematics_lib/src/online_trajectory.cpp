@@ -0,0 +1,296 @@
+#include "kinematics_lib/online_trajectory.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+/* Public functions */
+
+DoubleSProfile::DoubleSProfile() : h(0), jerk(0), a_lim(0), v_lim(0), t_j(0), t_a(0), t_v(0)
+{
+}
+
+DoubleSProfile::DoubleSProfile(double h, double v_max, double a_max, double j_max) : DoubleSProfile()
+{
+    this->h = h;
+    jerk = j_max;
+    if (h <= 0)
+        return;
+
+    // Acceleration phase that reaches v_max, with or without a constant acceleration segment
+    if (v_max * j_max < a_max * a_max)
+    {
+        t_j = sqrt(v_max / j_max);
+        t_a = 2 * t_j;
+    }
+    else
+    {
+        t_j = a_max / j_max;
+        t_a = t_j + v_max / a_max;
+    }
+    t_v = h / v_max - t_a;
+
+    // The displacement is too short to reach v_max: no constant velocity phase
+    if (t_v < 0)
+    {
+        t_v = 0;
+        t_j = a_max / j_max;
+        t_a = (a_max * a_max / j_max + sqrt(pow(a_max, 4) / (j_max * j_max) + 4 * h * a_max)) / (2 * a_max);
+
+        // Too short to reach a_max either
+        if (t_a < 2 * t_j)
+        {
+            t_j = cbrt(h / (2 * j_max));
+            t_a = 2 * t_j;
+        }
+    }
+
+    a_lim = j_max * t_j;
+    v_lim = a_lim * (t_a - t_j);
+}
+
+double DoubleSProfile::duration(void) const
+{
+    return 2 * t_a + t_v;
+}
+
+double DoubleSProfile::position(double t) const
+{
+    double t_end = duration();
+    if (t <= 0 || t_end <= 0)
+        return 0;
+    if (t >= t_end)
+        return h;
+
+    if (t < t_a)
+        return acceleration_position(t);
+    if (t < t_a + t_v)
+        return v_lim * t_a / 2 + v_lim * (t - t_a);
+
+    // The deceleration phase is the acceleration phase reversed in time
+    return h - acceleration_position(t_end - t);
+}
+
+double DoubleSProfile::velocity(double t) const
+{
+    double t_end = duration();
+    if (t <= 0 || t >= t_end)
+        return 0;
+
+    if (t < t_a)
+        return acceleration_velocity(t);
+    if (t < t_a + t_v)
+        return v_lim;
+    return acceleration_velocity(t_end - t);
+}
+
+StopProfile::StopProfile() : v0(0), a0(0), segments(0)
+{
+}
+
+StopProfile::StopProfile(double v0, double a0, double a_max, double j_max) : StopProfile()
+{
+    this->v0 = v0;
+    this->a0 = a0;
+
+    double v = v0, a = a0;
+    for (int pass = 0; pass < 2 && (v != 0 || a != 0); pass++)
+    {
+        // Direction of the motion to stop, the profile is computed for a positive velocity
+        double sign = (v > 0 || (v == 0 && a > 0)) ? 1 : -1;
+        double vs = sign * v, as = sign * a;
+
+        // Decelerating too fast: the velocity crosses 0 while the acceleration returns to 0, then the reverse motion stops
+        if (as < 0 && vs < as * as / (2 * j_max))
+        {
+            add_segment(-as / j_max, sign * j_max);
+            v = sign * (vs - as * as / (2 * j_max));
+            a = 0;
+            continue;
+        }
+
+        // Ramp to the deceleration, hold it, ramp back to 0: the velocity changes by -vs
+        double a_peak = -a_max;
+        double hold = (vs + (as * as - 2 * a_max * a_max) / (2 * j_max)) / a_max;
+        if (hold < 0)
+        {
+            hold = 0;
+            a_peak = -sqrt(as * as / 2 + j_max * vs);
+        }
+        add_segment((as - a_peak) / j_max, -sign * j_max);
+        add_segment(hold, 0);
+        add_segment(-a_peak / j_max, sign * j_max);
+        v = 0;
+        a = 0;
+    }
+}
+
+double StopProfile::duration(void) const
+{
+    double total = 0;
+    for (int i = 0; i < segments; i++)
+        total += segment_duration[i];
+    return total;
+}
+
+double StopProfile::position(double t) const
+{
+    double p, v, a;
+    state(t, p, v, a);
+    return p;
+}
+
+double StopProfile::velocity(double t) const
+{
+    double p, v, a;
+    state(t, p, v, a);
+    return v;
+}
+
+OnlineTrajectoryGenerator::OnlineTrajectoryGenerator(const JointLimits &limits, double cycle_time)
+{
+    this->limits = limits;
+    this->cycle_time = cycle_time;
+    initial_joints = JointStateVector::Zero();
+    delta_joints = JointStateVector::Zero();
+    stopping = false;
+    t = 0;
+}
+
+void OnlineTrajectoryGenerator::set_target(const JointStateVector &initial_joints, const JointStateVector &target_joints)
+{
+    this->initial_joints = initial_joints;
+    delta_joints = target_joints - initial_joints;
+    stopping = false;
+    t = 0;
+
+    // Limits of the path parameter s in [0, 1]: joint i moves by delta(i) * s
+    double v_max = std::numeric_limits<double>::infinity();
+    double a_max = v_max, j_max = v_max;
+    for (int i = 0; i < 6; i++)
+    {
+        double d = fabs(delta_joints(i));
+        if (d == 0)
+            continue;
+        v_max = std::min(v_max, limits.velocity(i) / d);
+        a_max = std::min(a_max, limits.acceleration(i) / d);
+        j_max = std::min(j_max, limits.jerk(i) / d);
+    }
+
+    if (std::isinf(v_max))
+        profile = DoubleSProfile();
+    else
+        profile = DoubleSProfile(1.0, v_max, a_max, j_max);
+}
+
+void OnlineTrajectoryGenerator::set_stop(const JointStateVector &joints, const JointStateVector &velocity, const JointStateVector &acceleration)
+{
+    initial_joints = joints;
+    delta_joints = JointStateVector::Zero();
+    stopping = true;
+    t = 0;
+
+    for (int i = 0; i < 6; i++)
+        stops[i] = StopProfile(velocity(i), acceleration(i), limits.acceleration(i), limits.jerk(i));
+}
+
+JointStateVector OnlineTrajectoryGenerator::next(void)
+{
+    t = std::min(t + cycle_time, duration());
+    return position();
+}
+
+JointStateVector OnlineTrajectoryGenerator::position(void) const
+{
+    if (stopping)
+    {
+        JointStateVector joints;
+        for (int i = 0; i < 6; i++)
+            joints(i) = initial_joints(i) + stops[i].position(t);
+        return joints;
+    }
+
+    if (finished())
+        return initial_joints + delta_joints;
+    return initial_joints + delta_joints * profile.position(t);
+}
+
+JointStateVector OnlineTrajectoryGenerator::velocity(void) const
+{
+    if (stopping)
+    {
+        JointStateVector joints_velocity;
+        for (int i = 0; i < 6; i++)
+            joints_velocity(i) = stops[i].velocity(t);
+        return joints_velocity;
+    }
+    return delta_joints * profile.velocity(t);
+}
+
+bool OnlineTrajectoryGenerator::finished(void) const
+{
+    return t >= duration();
+}
+
+double OnlineTrajectoryGenerator::duration(void) const
+{
+    if (!stopping)
+        return profile.duration();
+
+    double longest = 0;
+    for (int i = 0; i < 6; i++)
+        longest = std::max(longest, stops[i].duration());
+    return longest;
+}
+
+/* Private functions */
+
+double DoubleSProfile::acceleration_position(double t) const
+{
+    if (t < t_j)
+        return jerk * t * t * t / 6;
+    if (t < t_a - t_j)
+        return a_lim / 6 * (3 * t * t - 3 * t_j * t + t_j * t_j);
+    double r = t_a - t;
+    return v_lim * t_a / 2 - v_lim * r + jerk * r * r * r / 6;
+}
+
+double DoubleSProfile::acceleration_velocity(double t) const
+{
+    if (t < t_j)
+        return jerk * t * t / 2;
+    if (t < t_a - t_j)
+        return a_lim * (t - t_j / 2);
+    double r = t_a - t;
+    return v_lim - jerk * r * r / 2;
+}
+
+void StopProfile::add_segment(double duration, double jerk)
+{
+    if (duration <= 0)
+        return;
+    segment_duration[segments] = duration;
+    segment_jerk[segments] = jerk;
+    segments++;
+}
+
+void StopProfile::state(double t, double &p, double &v, double &a) const
+{
+    p = 0;
+    v = v0;
+    a = a0;
+    for (int i = 0; i < segments && t > 0; i++)
+    {
+        double dt = std::min(t, segment_duration[i]), j = segment_jerk[i];
+        p += v * dt + a * dt * dt / 2 + j * dt * dt * dt / 6;
+        v += a * dt + j * dt * dt / 2;
+        a += j * dt;
+        t -= dt;
+    }
+
+    // At rest after the last segment
+    if (t > 0 || segments == 0)
+    {
+        v = 0;
+        a = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "kinematics_lib/reachability_map.h"
+#include "kinematics_lib/ur5_kinematics.h"
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+/**
+ * Header of the binary file, followed by the solutions of the gridpoints (one byte each, x fastest)
+ */
+struct ReachabilityHeader
+{
+    char magic[8]; // "UR5RMAP"
+    uint32_t version;
+    int32_t nx, ny, nz;
+    double origin[3];
+    double voxel_size;
+    double rotation[9]; // column major
+};
+
+static const char reachability_magic[8] = "UR5RMAP";
+static const uint32_t reachability_version = 1;
+
+/* Public functions */
+
+ReachabilityMap::ReachabilityMap() : origin(Coordinates::Zero()), voxel_size(1), nx(0), ny(0), nz(0), rotation(RotationMatrix::Identity())
+{
+}
+
+void ReachabilityMap::build(const RotationMatrix &rotation, const Coordinates &lower_corner, const Coordinates &upper_corner,
+    double voxel_size, const StateValidityChecker &is_valid)
+{
+    this->rotation = rotation;
+    this->voxel_size = voxel_size;
+    origin = lower_corner;
+    nx = floor((upper_corner(0) - lower_corner(0)) / voxel_size) + 1;
+    ny = floor((upper_corner(1) - lower_corner(1)) / voxel_size) + 1;
+    nz = floor((upper_corner(2) - lower_corner(2)) / voxel_size) + 1;
+    solutions.assign(nx * ny * nz, 0);
+
+    for (int k = 0; k < nz; k++)
+    {
+        for (int j = 0; j < ny; j++)
+        {
+            for (int i = 0; i < nx; i++)
+            {
+                Coordinates pos = origin + voxel_size * Coordinates(i, j, k);
+                Eigen::Matrix<double, 8, 6> ik_result = ur5_inverse_complete_simd(pos, rotation);
+
+                int count = 0;
+                for (int r = 0; r < 8; r++)
+                {
+                    JointStateVector q = ik_result.row(r).transpose();
+                    count += q.allFinite() && is_valid(q);
+                }
+                solutions[index(i, j, k)] = count;
+            }
+        }
+    }
+}
+
+bool ReachabilityMap::write(const std::string &file) const
+{
+    std::ofstream out(file, std::ios::binary);
+    if (!out)
+        return false;
+
+    ReachabilityHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, reachability_magic, sizeof(header.magic));
+    header.version = reachability_version;
+    header.nx = nx;
+    header.ny = ny;
+    header.nz = nz;
+    for (int a = 0; a < 3; a++)
+        header.origin[a] = origin(a);
+    header.voxel_size = voxel_size;
+    memcpy(header.rotation, rotation.data(), sizeof(header.rotation));
+
+    out.write((const char *)&header, sizeof(header));
+    out.write((const char *)solutions.data(), solutions.size());
+    return (bool)out;
+}
+
+bool ReachabilityMap::load(const std::string &file)
+{
+    std::ifstream in(file, std::ios::binary);
+    ReachabilityHeader header;
+    if (!in.read((char *)&header, sizeof(header)) || memcmp(header.magic, reachability_magic, sizeof(header.magic)) != 0 ||
+        header.version != reachability_version || header.nx <= 0 || header.ny <= 0 || header.nz <= 0 || header.voxel_size <= 0)
+        return false;
+
+    std::vector<uint8_t> data((size_t)header.nx * header.ny * header.nz);
+    if (!in.read((char *)data.data(), data.size()))
+        return false;
+
+    nx = header.nx;
+    ny = header.ny;
+    nz = header.nz;
+    origin << header.origin[0], header.origin[1], header.origin[2];
+    voxel_size = header.voxel_size;
+    rotation = Eigen::Map<const RotationMatrix>(header.rotation);
+    solutions.swap(data);
+    return true;
+}
+
+bool ReachabilityMap::loaded(void) const
+{
+    return !solutions.empty();
+}
+
+bool ReachabilityMap::covers(const RotationMatrix &rot, double tolerance) const
+{
+    return loaded() && (rot - rotation).cwiseAbs().maxCoeff() <= tolerance;
+}
+
+int ReachabilityMap::dexterity(const Coordinates &pos) const
+{
+    Coordinates cell = (pos - origin) / voxel_size;
+    int i = floor(cell(0)), j = floor(cell(1)), k = floor(cell(2));
+    if (!loaded() || i < 0 || j < 0 || k < 0 || i >= nx || j >= ny || k >= nz)
+        return -1;
+
+    // The gridpoints at the corners of the voxel, on the last gridpoint the voxel is degenerate
+    int i1 = std::min(i + 1, nx - 1), j1 = std::min(j + 1, ny - 1), k1 = std::min(k + 1, nz - 1);
+    int best = 0;
+    for (int c : {index(i, j, k), index(i1, j, k), index(i, j1, k), index(i1, j1, k),
+                  index(i, j, k1), index(i1, j, k1), index(i, j1, k1), index(i1, j1, k1)})
+        best = std::max(best, (int)solutions[c]);
+    return best;
+}
+
+int ReachabilityMap::reachable_points(void) const
+{
+    return solutions.size() - std::count(solutions.begin(), solutions.end(), 0);
+}
+
+int ReachabilityMap::size(void) const
+{
+    return solutions.size();
+}
\ No newline at end of file
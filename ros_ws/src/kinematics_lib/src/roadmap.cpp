@@ -0,0 +1,322 @@
+#include "kinematics_lib/roadmap.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char roadmap_magic[8] = "UR5PRM";
+static const uint32_t roadmap_version = 1;
+
+/* Private functions */
+
+/**
+ * @return The indexes of the k configurations closest to q, the nearest first
+ */
+static std::vector<int> k_nearest(const double *nodes, int n, const JointStateVector &q, int k)
+{
+    std::vector<std::pair<double, int>> distances(n);
+    for (int i = 0; i < n; i++)
+        distances[i] = std::make_pair((Eigen::Map<const JointStateVector>(nodes + 6 * i) - q).squaredNorm(), i);
+
+    k = std::min(k, n);
+    std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+
+    std::vector<int> nearest(k);
+    for (int i = 0; i < k; i++)
+        nearest[i] = distances[i].second;
+    return nearest;
+}
+
+std::vector<int> Roadmap::connections(const JointStateVector &q, const StateValidityChecker &is_valid, int k) const
+{
+    // The nearest nodes are checked first, far nodes are rarely reachable
+    std::vector<int> candidates = k_nearest(nodes, size(), q, 4 * k);
+    std::vector<int> reachable;
+    for (int i = 0; i < (int)candidates.size() && (int)reachable.size() < k; i++)
+        if (check_motion(is_valid, q, node(candidates[i]), header->resolution))
+            reachable.push_back(candidates[i]);
+    return reachable;
+}
+
+/* Public functions */
+
+RoadmapBuilder::RoadmapBuilder(const StateValidityChecker &is_valid, double resolution) : is_valid(is_valid), resolution(resolution)
+{
+}
+
+int RoadmapBuilder::add_node(const JointStateVector &q)
+{
+    if (!is_valid(q))
+        return -1;
+
+    nodes.push_back(q);
+    adjacency.push_back(std::vector<RoadmapEdge>());
+    return nodes.size() - 1;
+}
+
+void RoadmapBuilder::sample(int n, const JointStateVector &lower_bounds, const JointStateVector &upper_bounds, unsigned int seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    for (int added = 0; added < n;)
+    {
+        JointStateVector q;
+        for (int j = 0; j < 6; j++)
+            q(j) = lower_bounds(j) + (upper_bounds(j) - lower_bounds(j)) * unit(gen);
+        added += add_node(q) >= 0;
+    }
+}
+
+void RoadmapBuilder::connect(int k, double max_distance)
+{
+    for (int i = 0; i < (int)nodes.size(); i++)
+    {
+        // The first neighbour is the node itself
+        for (int j : k_nearest(nodes[0].data(), nodes.size(), nodes[i], k + 1))
+        {
+            double cost = (nodes[j] - nodes[i]).norm();
+            if (j == i || cost > max_distance)
+                continue;
+
+            bool known = false;
+            for (const RoadmapEdge &edge : adjacency[i])
+                known = known || (int)edge.target == j;
+            if (known || !check_motion(is_valid, nodes[i], nodes[j], resolution))
+                continue;
+
+            adjacency[i].push_back({(uint32_t)j, (float)cost});
+            adjacency[j].push_back({(uint32_t)i, (float)cost});
+        }
+    }
+}
+
+int RoadmapBuilder::size(void) const
+{
+    return nodes.size();
+}
+
+int RoadmapBuilder::edges(void) const
+{
+    int n_edges = 0;
+    for (const std::vector<RoadmapEdge> &list : adjacency)
+        n_edges += list.size();
+    return n_edges / 2;
+}
+
+int RoadmapBuilder::component(int node) const
+{
+    // Breadth first visit, the component is named after its smallest node
+    std::vector<bool> visited(nodes.size(), false);
+    std::queue<int> open;
+    open.push(node);
+    visited[node] = true;
+    int first = node;
+    while (!open.empty())
+    {
+        int i = open.front();
+        open.pop();
+        first = std::min(first, i);
+        for (const RoadmapEdge &edge : adjacency[i])
+        {
+            if (!visited[edge.target])
+            {
+                visited[edge.target] = true;
+                open.push(edge.target);
+            }
+        }
+    }
+    return first;
+}
+
+bool RoadmapBuilder::write(const std::string &file) const
+{
+    std::ofstream out(file, std::ios::binary);
+    if (!out)
+        return false;
+
+    RoadmapHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, roadmap_magic, sizeof(header.magic));
+    header.version = roadmap_version;
+    header.n_nodes = nodes.size();
+    header.n_edges = 2 * edges();
+    header.resolution = resolution;
+    out.write((const char *)&header, sizeof(header));
+
+    for (const JointStateVector &q : nodes)
+        out.write((const char *)q.data(), 6 * sizeof(double));
+
+    uint32_t offset = 0;
+    for (const std::vector<RoadmapEdge> &list : adjacency)
+    {
+        out.write((const char *)&offset, sizeof(offset));
+        offset += list.size();
+    }
+    out.write((const char *)&offset, sizeof(offset));
+
+    for (const std::vector<RoadmapEdge> &list : adjacency)
+        out.write((const char *)list.data(), list.size() * sizeof(RoadmapEdge));
+
+    return (bool)out;
+}
+
+Roadmap::Roadmap() : data(nullptr), bytes(0), header(nullptr), nodes(nullptr), offsets(nullptr), edges(nullptr)
+{
+}
+
+Roadmap::~Roadmap()
+{
+    unload();
+}
+
+bool Roadmap::load(const std::string &file)
+{
+    unload();
+
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size < (off_t)sizeof(RoadmapHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the file is closed
+    void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return false;
+
+    data = mapped;
+    bytes = info.st_size;
+    header = (const RoadmapHeader *)data;
+
+    size_t expected = sizeof(RoadmapHeader) + header->n_nodes * 6 * sizeof(double) +
+        (header->n_nodes + 1) * sizeof(uint32_t) + header->n_edges * sizeof(RoadmapEdge);
+    if (memcmp(header->magic, roadmap_magic, sizeof(roadmap_magic)) != 0 || header->version != roadmap_version ||
+        header->n_nodes == 0 || bytes != expected)
+    {
+        unload();
+        return false;
+    }
+
+    nodes = (const double *)((const char *)data + sizeof(RoadmapHeader));
+    offsets = (const uint32_t *)(nodes + 6 * header->n_nodes);
+    edges = (const RoadmapEdge *)(offsets + header->n_nodes + 1);
+
+    // The queries trust the adjacency lists: reject a truncated or stale file before any of them reads out of bounds
+    bool valid = offsets[0] == 0 && offsets[header->n_nodes] == header->n_edges;
+    for (uint32_t i = 0; valid && i < header->n_nodes; i++)
+        valid = offsets[i] <= offsets[i + 1];
+    for (uint32_t e = 0; valid && e < header->n_edges; e++)
+        valid = edges[e].target < header->n_nodes && edges[e].cost >= 0;
+    if (!valid)
+    {
+        unload();
+        return false;
+    }
+    return true;
+}
+
+void Roadmap::unload(void)
+{
+    if (data)
+        munmap(data, bytes);
+    data = nullptr;
+    bytes = 0;
+    header = nullptr;
+    nodes = nullptr;
+    offsets = nullptr;
+    edges = nullptr;
+}
+
+bool Roadmap::loaded(void) const
+{
+    return data != nullptr;
+}
+
+int Roadmap::size(void) const
+{
+    return header ? header->n_nodes : 0;
+}
+
+JointStateVector Roadmap::node(int i) const
+{
+    return Eigen::Map<const JointStateVector>(nodes + 6 * i);
+}
+
+bool Roadmap::query(const JointStateVector &start, const JointStateVector &goal, const StateValidityChecker &is_valid,
+    std::vector<JointStateVector> &path, int k) const
+{
+    path.clear();
+    if (!loaded())
+        return false;
+
+    std::vector<int> start_nodes = connections(start, is_valid, k);
+    std::vector<int> goal_nodes = connections(goal, is_valid, k);
+    if (start_nodes.empty() || goal_nodes.empty())
+        return false;
+
+    // A* from start to goal, the goal is the virtual node n. The heuristic is the distance to the goal
+    int n = size();
+    std::vector<double> cost(n + 1, INFINITY);
+    std::vector<int> parent(n + 1, -1);
+    std::vector<double> goal_cost(n, INFINITY);
+    for (int i : goal_nodes)
+        goal_cost[i] = (goal - node(i)).norm();
+
+    typedef std::pair<double, int> Entry; // estimated total cost, node
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    for (int i : start_nodes)
+    {
+        cost[i] = (node(i) - start).norm();
+        open.push(Entry(cost[i] + (goal - node(i)).norm(), i));
+    }
+
+    while (!open.empty() && open.top().second != n)
+    {
+        Entry entry = open.top();
+        open.pop();
+        int i = entry.second;
+        double h = (goal - node(i)).norm();
+        if (entry.first > cost[i] + h + 1e-9)
+            continue; // stale entry
+
+        if (cost[i] + goal_cost[i] < cost[n])
+        {
+            cost[n] = cost[i] + goal_cost[i];
+            parent[n] = i;
+            open.push(Entry(cost[n], n));
+        }
+
+        for (uint32_t e = offsets[i]; e < offsets[i + 1]; e++)
+        {
+            int j = edges[e].target;
+            double c = cost[i] + edges[e].cost;
+            if (c < cost[j])
+            {
+                cost[j] = c;
+                parent[j] = i;
+                open.push(Entry(c + (goal - node(j)).norm(), j));
+            }
+        }
+    }
+    if (parent[n] < 0)
+        return false;
+
+    path.push_back(goal);
+    for (int i = parent[n]; i >= 0; i = parent[i])
+        path.push_back(node(i));
+    path.push_back(start);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
\ No newline at end of file
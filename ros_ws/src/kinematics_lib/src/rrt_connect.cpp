@@ -0,0 +1,162 @@
+#include "kinematics_lib/rrt_connect.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+/* Public functions */
+
+bool check_motion(const StateValidityChecker &is_valid, const JointStateVector &from, const JointStateVector &to, double resolution)
+{
+    int n = ceil((to - from).norm() / resolution);
+    for (int i = 1; i <= n; i++)
+    {
+        if (!is_valid(from + (to - from) * ((double)i / n)))
+            return false;
+    }
+    return true;
+}
+
+RRTConnect::RRTConnect(const StateValidityChecker &is_valid, const JointStateVector &lower_bounds, const JointStateVector &upper_bounds,
+    double max_step, double resolution, unsigned int seed)
+    : is_valid(is_valid), lower_bounds(lower_bounds), upper_bounds(upper_bounds), max_step(max_step), resolution(resolution), gen(seed)
+{
+    stats = RRTStats();
+}
+
+bool RRTConnect::check_motion(const JointStateVector &from, const JointStateVector &to) const
+{
+    return ::check_motion(is_valid, from, to, resolution);
+}
+
+bool RRTConnect::plan(const JointStateVector &start, const JointStateVector &goal, double max_time, std::vector<JointStateVector> &path)
+{
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    stats = RRTStats();
+    path.clear();
+
+    if (!is_valid(start) || !is_valid(goal))
+        return false;
+
+    // The samples are drawn in the joints limits, extended to contain start and goal
+    JointStateVector lower = lower_bounds.cwiseMin(start).cwiseMin(goal);
+    JointStateVector upper = upper_bounds.cwiseMax(start).cwiseMax(goal);
+    std::uniform_real_distribution<double> unit(0, 1);
+
+    Tree start_tree(1, {start, -1}), goal_tree(1, {goal, -1});
+    Tree *a = &start_tree, *b = &goal_tree;
+    bool found = check_motion(start, goal);
+    if (found)
+        path = {start, goal};
+
+    while (!found && std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() < max_time)
+    {
+        stats.iterations++;
+        JointStateVector sample;
+        for (int j = 0; j < 6; j++)
+            sample(j) = lower(j) + (upper(j) - lower(j)) * unit(gen);
+
+        // Grow one tree towards the sample, then the other tree towards the new node
+        if (extend(*a, sample) != TRAPPED && connect(*b, a->back().q) == REACHED)
+        {
+            std::vector<JointStateVector> first = branch(start_tree, start_tree.size() - 1);
+            std::vector<JointStateVector> second = branch(goal_tree, goal_tree.size() - 1);
+
+            // Both branches end at the same configuration
+            path = first;
+            path.insert(path.end(), second.rbegin() + 1, second.rend());
+            found = true;
+        }
+        std::swap(a, b);
+    }
+
+    stats.tree_size = start_tree.size() + goal_tree.size();
+    stats.planning_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    stats.waypoints = path.size();
+    return found;
+}
+
+void RRTConnect::shortcut(std::vector<JointStateVector> &path, int iterations)
+{
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    // Random shortcuts
+    for (int k = 0; k < iterations && path.size() > 2; k++)
+    {
+        std::uniform_int_distribution<int> index(0, path.size() - 1);
+        int i = index(gen), j = index(gen);
+        if (i > j)
+            std::swap(i, j);
+        if (j - i > 1 && check_motion(path[i], path[j]))
+            path.erase(path.begin() + i + 1, path.begin() + j);
+    }
+
+    // Greedy pass: from every waypoint, the farthest waypoint that can be reached directly
+    std::vector<JointStateVector> shortened(1, path.front());
+    for (int i = 0; i + 1 < (int)path.size();)
+    {
+        int j = path.size() - 1;
+        while (j > i + 1 && !check_motion(path[i], path[j]))
+            j--;
+        shortened.push_back(path[j]);
+        i = j;
+    }
+    path = shortened;
+
+    stats.smoothing_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    stats.waypoints = path.size();
+}
+
+RRTStats RRTConnect::get_stats(void) const
+{
+    return stats;
+}
+
+/* Private functions */
+
+int RRTConnect::nearest(const Tree &tree, const JointStateVector &q) const
+{
+    int best = 0;
+    double best_distance = INFINITY;
+    for (int i = 0; i < (int)tree.size(); i++)
+    {
+        double distance = (tree[i].q - q).squaredNorm();
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            best = i;
+        }
+    }
+    return best;
+}
+
+RRTConnect::ExtendResult RRTConnect::extend(Tree &tree, const JointStateVector &target)
+{
+    int near = nearest(tree, target);
+    JointStateVector delta = target - tree[near].q;
+    double distance = delta.norm();
+
+    bool reached = distance <= max_step;
+    JointStateVector q_new = reached ? target : JointStateVector(tree[near].q + delta * (max_step / distance));
+    if (!check_motion(tree[near].q, q_new))
+        return TRAPPED;
+
+    tree.push_back({q_new, near});
+    return reached ? REACHED : ADVANCED;
+}
+
+RRTConnect::ExtendResult RRTConnect::connect(Tree &tree, const JointStateVector &target)
+{
+    ExtendResult result = ADVANCED;
+    while (result == ADVANCED)
+        result = extend(tree, target);
+    return result;
+}
+
+std::vector<JointStateVector> RRTConnect::branch(const Tree &tree, int node) const
+{
+    std::vector<JointStateVector> configurations;
+    for (int i = node; i >= 0; i = tree[i].parent)
+        configurations.push_back(tree[i].q);
+    std::reverse(configurations.begin(), configurations.end());
+    return configurations;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "kinematics_lib/thread_pool.h"
+#include <algorithm>
+#include <memory>
+
+/* Public functions */
+
+ThreadPool::ThreadPool(int n_threads)
+{
+    stopping = false;
+
+    if (n_threads <= 0)
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < n_threads; i++)
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+int ThreadPool::size(void) const
+{
+    return workers.size();
+}
+
+std::future<void> ThreadPool::submit(const std::function<void(void)> &task)
+{
+    auto packaged = std::make_shared<std::packaged_task<void(void)>>(task);
+    std::future<void> result = packaged->get_future();
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        tasks.push([packaged]() { (*packaged)(); });
+    }
+    task_available.notify_one();
+    return result;
+}
+
+void ThreadPool::parallel_for(int n, const std::function<void(int, int)> &body, int min_chunk)
+{
+    if (n <= 0)
+        return;
+
+    // A few chunks per thread balance the load when the elements have different costs
+    int n_chunks = std::min((n + min_chunk - 1) / min_chunk, 4 * (size() + 1));
+    int chunk = (n + n_chunks - 1) / n_chunks;
+
+    std::vector<std::future<void>> results;
+    for (int begin = chunk; begin < n; begin += chunk)
+    {
+        int end = std::min(begin + chunk, n);
+        results.push_back(submit([&body, begin, end]() { body(begin, end); }));
+    }
+
+    // The calling thread takes care of the first chunk
+    body(0, std::min(chunk, n));
+
+    for (auto &result : results)
+        result.get();
+}
+
+/* Private functions */
+
+void ThreadPool::worker_loop(void)
+{
+    while (true)
+    {
+        std::function<void(void)> task;
+        {
+            std::unique_lock<std::mutex> lock(tasks_mutex);
+            task_available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+            if (stopping && tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "kinematics_lib/toppra.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+/**
+ * Bound of the path acceleration u, affine in the squared path velocity x: c0 + c1 * x
+ */
+struct AffineBound
+{
+    double c0;
+    double c1;
+
+    double operator()(double x) const { return c0 + c1 * x; }
+};
+
+/**
+ * Constraints of a gridpoint: x <= x_max, lower(x) <= u <= upper(x) for every bound
+ */
+struct GridConstraints
+{
+    double x_max;
+    std::vector<AffineBound> lower;
+    std::vector<AffineBound> upper;
+};
+
+static const double parallel_tolerance = 1e-9;
+
+/* Private functions */
+
+/**
+ * Acceleration limits as bounds of u: -a <= u_coeff * u + x_coeff * x <= a for every joint
+ */
+static void add_acceleration_bounds(const JointStateVector &u_coeff, const JointStateVector &x_coeff, const JointLimits &limits, GridConstraints &constraints)
+{
+    for (int j = 0; j < 6; j++)
+    {
+        double a = limits.acceleration(j);
+        if (fabs(u_coeff(j)) < parallel_tolerance)
+        {
+            // The joint acceleration does not depend on u: only x * x_coeff is bounded
+            if (fabs(x_coeff(j)) > parallel_tolerance)
+                constraints.x_max = std::min(constraints.x_max, a / fabs(x_coeff(j)));
+            continue;
+        }
+
+        AffineBound low = {-a / u_coeff(j), -x_coeff(j) / u_coeff(j)};
+        AffineBound high = {a / u_coeff(j), -x_coeff(j) / u_coeff(j)};
+        if (u_coeff(j) < 0)
+            std::swap(low.c0, high.c0);
+        constraints.lower.push_back(low);
+        constraints.upper.push_back(high);
+    }
+}
+
+/**
+ * Joints limits as constraints of (x, u) on the segment [s, s + ds]: q' * sqrt(x) within the velocity limits,
+ * q' * u + q'' * x within the acceleration limits at both ends of the segment.
+ * At the end of the segment the squared velocity is x + 2 * ds * u (first order interpolation of TOPP-RA),
+ * which reduces the violations between the gridpoints.
+ */
+static GridConstraints grid_constraints(const JointPath &path, const JointLimits &limits, double s, double ds)
+{
+    GridConstraints constraints;
+    constraints.x_max = std::numeric_limits<double>::infinity();
+
+    JointStateVector qp = path.derivative(s);
+    JointStateVector qpp = path.second_derivative(s);
+    for (int j = 0; j < 6; j++)
+        if (fabs(qp(j)) > parallel_tolerance)
+            constraints.x_max = std::min(constraints.x_max, pow(limits.velocity(j) / qp(j), 2));
+    add_acceleration_bounds(qp, qpp, limits, constraints);
+
+    if (ds > 0)
+    {
+        JointStateVector qp_next = path.derivative(s + ds);
+        JointStateVector qpp_next = path.second_derivative(s + ds);
+        add_acceleration_bounds(qp_next + 2 * ds * qpp_next, qpp_next, limits, constraints);
+    }
+    return constraints;
+}
+
+/**
+ * Interval of the squared path velocities x at a gridpoint for which a path acceleration u exists
+ * that satisfies the constraints and leads inside the next set: x_next_min <= x + 2 * ds * u <= x_next_max.
+ * Each pair of lower and upper bounds of u gives a linear inequality in x (u is eliminated).
+ *
+ * @return false if the interval is empty
+ */
+static bool feasible_interval(const GridConstraints &constraints, double ds, double x_next_min, double x_next_max, double &x_min, double &x_max)
+{
+    std::vector<AffineBound> lower = constraints.lower, upper = constraints.upper;
+    lower.push_back({x_next_min / (2 * ds), -1 / (2 * ds)});
+    upper.push_back({x_next_max / (2 * ds), -1 / (2 * ds)});
+
+    x_min = 0;
+    x_max = constraints.x_max;
+    for (const AffineBound &low : lower)
+    {
+        for (const AffineBound &high : upper)
+        {
+            // low.c0 + low.c1 * x <= high.c0 + high.c1 * x
+            double c = low.c1 - high.c1, r = high.c0 - low.c0;
+            if (c > parallel_tolerance)
+                x_max = std::min(x_max, r / c);
+            else if (c < -parallel_tolerance)
+                x_min = std::max(x_min, r / c);
+            else if (r < -parallel_tolerance)
+                return false;
+        }
+    }
+    return x_min <= x_max + parallel_tolerance;
+}
+
+/* Public functions */
+
+PathTiming::PathTiming(const std::vector<double> &s, const std::vector<double> &x) : s(s)
+{
+    for (double xi : x)
+        sd.push_back(sqrt(std::max(xi, 0.0)));
+
+    t.push_back(0);
+    for (int i = 0; i + 1 < (int)s.size(); i++)
+        t.push_back(t.back() + 2 * (s[i + 1] - s[i]) / (sd[i] + sd[i + 1]));
+}
+
+double PathTiming::duration(void) const
+{
+    return t.empty() ? 0 : t.back();
+}
+
+double PathTiming::path_parameter(double time, double *s_dot) const
+{
+    if (s_dot)
+        *s_dot = 0;
+    if (t.empty())
+        return 0;
+    if (time <= 0)
+        return s.front();
+    if (time >= t.back())
+        return s.back();
+
+    // Constant path acceleration inside the segment
+    int k = std::upper_bound(t.begin(), t.end(), time) - t.begin() - 1;
+    double tau = time - t[k];
+    double u = (sd[k + 1] * sd[k + 1] - sd[k] * sd[k]) / (2 * (s[k + 1] - s[k]));
+    if (s_dot)
+        *s_dot = sd[k] + u * tau;
+    return std::min(s[k] + sd[k] * tau + u * tau * tau / 2, s[k + 1]);
+}
+
+int PathTiming::size(void) const
+{
+    return s.size();
+}
+
+bool time_parameterize(const JointPath &path, const JointLimits &limits, PathTiming &timing, int n_gridpoints)
+{
+    int n = std::max(n_gridpoints, 2) - 1;
+    double ds = path.length() / n;
+    if (ds <= 0)
+    {
+        timing = PathTiming();
+        return true;
+    }
+
+    std::vector<double> s(n + 1);
+    std::vector<GridConstraints> constraints(n + 1);
+    for (int i = 0; i <= n; i++)
+    {
+        s[i] = path.length() * i / n;
+        constraints[i] = grid_constraints(path, limits, s[i], i < n ? ds : 0);
+    }
+
+    // Backward pass: controllable sets, the velocities from which the end of the path can be reached at rest
+    std::vector<double> k_min(n + 1, 0), k_max(n + 1, 0);
+    for (int i = n - 1; i >= 0; i--)
+    {
+        if (!feasible_interval(constraints[i], ds, k_min[i + 1], k_max[i + 1], k_min[i], k_max[i]))
+            return false;
+    }
+    if (k_min[0] > parallel_tolerance)
+        return false;
+
+    // Forward pass: greedy maximum path acceleration, the next velocity stays in the controllable set
+    std::vector<double> x(n + 1, 0);
+    for (int i = 0; i < n; i++)
+    {
+        double u_min = (k_min[i + 1] - x[i]) / (2 * ds);
+        double u_max = (k_max[i + 1] - x[i]) / (2 * ds);
+        for (const AffineBound &low : constraints[i].lower)
+            u_min = std::max(u_min, low(x[i]));
+        for (const AffineBound &high : constraints[i].upper)
+            u_max = std::min(u_max, high(x[i]));
+
+        double u = std::max(u_max, u_min);
+        x[i + 1] = std::min(std::max(x[i] + 2 * ds * u, k_min[i + 1]), k_max[i + 1]);
+    }
+
+    timing = PathTiming(s, x);
+    return std::isfinite(timing.duration());
+}
\ No newline at end of file
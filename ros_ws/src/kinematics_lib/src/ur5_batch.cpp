@@ -0,0 +1,103 @@
+#include "kinematics_lib/ur5_batch.h"
+#include "kinematics_lib/ur5_kinematics.h"
+
+// Minimum number of poses processed by a single task, smaller chunks are dominated by the scheduling overhead
+static const int min_chunk = 32;
+
+/* Public functions */
+
+void PoseBatch::resize(int n)
+{
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    for (int k = 0; k < 9; k++)
+        rot[k].resize(n);
+}
+
+void PoseBatch::set(int i, const Coordinates &pe, const RotationMatrix &re)
+{
+    x[i] = pe(0);
+    y[i] = pe(1);
+    z[i] = pe(2);
+    for (int k = 0; k < 9; k++)
+        rot[k][i] = re(k);
+}
+
+void PoseBatch::get(int i, Coordinates &pe, RotationMatrix &re) const
+{
+    pe << x[i], y[i], z[i];
+    for (int k = 0; k < 9; k++)
+        re(k) = rot[k][i];
+}
+
+void JointBatch::resize(int n)
+{
+    for (int j = 0; j < 6; j++)
+        th[j].resize(n);
+}
+
+void JointBatch::set(int i, const JointStateVector &joints)
+{
+    for (int j = 0; j < 6; j++)
+        th[j][i] = joints(j);
+}
+
+JointStateVector JointBatch::get(int i) const
+{
+    JointStateVector joints;
+    for (int j = 0; j < 6; j++)
+        joints(j) = th[j][i];
+    return joints;
+}
+
+void ur5_inverse_batch(const PoseBatch &poses, IkBatchResult &result, ThreadPool *pool)
+{
+    int n = poses.size();
+    result.solutions.resize(8 * n);
+    result.valid.resize(8 * n);
+
+    auto body = [&](int begin, int end)
+    {
+        Coordinates pe;
+        RotationMatrix re;
+        for (int i = begin; i < end; i++)
+        {
+            poses.get(i, pe, re);
+            Eigen::Array<bool, 8, 1> exact;
+            Eigen::Matrix<double, 8, 6> th = ur5_inverse_complete_simd(pe, re, exact);
+
+            for (int b = 0; b < 8; b++)
+            {
+                for (int j = 0; j < 6; j++)
+                    result.solutions.th[j][8 * i + b] = th(b, j);
+                result.valid[8 * i + b] = exact(b);
+            }
+        }
+    };
+
+    if (pool)
+        pool->parallel_for(n, body, min_chunk);
+    else
+        body(0, n);
+}
+
+void ur5_direct_batch(const JointBatch &joints, PoseBatch &poses, ThreadPool *pool)
+{
+    int n = joints.size();
+    poses.resize(n);
+
+    auto body = [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            RigidTransform t06 = ur5_direct(joints.get(i));
+            poses.set(i, t06.pos, t06.rot);
+        }
+    };
+
+    if (pool)
+        pool->parallel_for(n, body, min_chunk);
+    else
+        body(0, n);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/cartesian_path.h"
+
+/* Public functions */
+
+bool ur5_inverse_lm(const Coordinates &pe, const RotationMatrix &re, const JointStateVector &initial, JointStateVector &th,
+    double tolerance, int max_iterations, int *iterations)
+{
+    RigidTransform desired(re, pe), current;
+    Eigen::Matrix<double, 6, 6> jac, candidate_jac;
+    ur5_direct_and_jacobian(initial, current.pos, current.rot, jac);
+    th = initial;
+    Twist error = pose_error(desired, current);
+    double cost = error.squaredNorm();
+
+    double damping = 1e-3;
+    int i = 0;
+    for (; i < max_iterations && cost > 1e-20; i++)
+    {
+        // Damped normal equations, the damping keeps the step bounded near the singularities
+        Eigen::Matrix<double, 6, 6> a = jac.transpose() * jac + damping * Eigen::Matrix<double, 6, 6>::Identity();
+        JointStateVector step = a.ldlt().solve(jac.transpose() * error);
+
+        JointStateVector candidate = th + step;
+        ur5_direct_and_jacobian(candidate, current.pos, current.rot, candidate_jac);
+        Twist candidate_error = pose_error(desired, current);
+        double candidate_cost = candidate_error.squaredNorm();
+
+        if (candidate_cost < cost)
+        {
+            th = candidate;
+            jac = candidate_jac;
+            error = candidate_error;
+            cost = candidate_cost;
+            damping = std::max(damping / 10, 1e-9);
+        }
+        else
+        {
+            damping *= 10;
+            // No step reduces the error: a local minimum of the distance from the pose
+            if (damping > 1e6)
+                break;
+        }
+
+        if (step.norm() < 1e-12)
+            break;
+    }
+
+    if (iterations)
+        *iterations = i;
+    return sqrt(cost) <= tolerance;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#include "kinematics_lib/ur5_kinematics.h"
+
+/* Public functions */
+
+Eigen::Matrix<double, 8, 6> ur5_inverse_complete_simd(const Coordinates &pe, const RotationMatrix &re)
+{
+    Eigen::Array<bool, 8, 1> exact;
+    return ur_inverse_complete<UR5Model>(pe, re, exact);
+}
+
+Eigen::Matrix<double, 8, 6> ur5_inverse_complete_simd(const Coordinates &pe, const RotationMatrix &re, Eigen::Array<bool, 8, 1> &exact)
+{
+    return ur_inverse_complete<UR5Model>(pe, re, exact);
+}
\ No newline at end of file
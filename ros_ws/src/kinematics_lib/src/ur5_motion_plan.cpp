@@ -1,39 +1,38 @@
 #include "kinematics_lib/ur5_kinematics.h"
-#include <iostream>
 
-double *ur5_trajectory_plan(const JointStateVector &initial_joints, const JointStateVector &final_joints, int n)
+CubicTrajectory ur5_trajectory_plan(const JointStateVector &initial_joints, const JointStateVector &final_joints, int n)
 {
-    Eigen::Matrix<double, 6, 4> coeff;
-    for (int i = 0; i < 6; i++)
-    {
-        // Matrix associated to the third degree system
-        Eigen::Matrix<double, 4, 4> m;
-        m << 1, 0, 0, 0,
-            0, 1, 0, 0,
-            1, 1, 1, 1,
-            0, 1, 2, 3;
+    return CubicTrajectory(initial_joints, final_joints, n);
+}
 
-        Eigen::Matrix<double, 4, 1> a, b;
-        b << initial_joints(i), 0, final_joints(i), 0;
-
-        // Solve system m*coeff=b
-        a = m.inverse() * b;
+double ur5_workbench_distance(const Coordinates &pos)
+{
+    double dz = 0.74 - pos(2), dy = -0.4 - pos(1);
+    // Outside both half spaces the closest point of the region is its edge
+    if (dz > 0 && dy > 0)
+        return std::hypot(dz, dy);
+    return std::max(dz, dy);
+}
 
-        for (int j = 0; j < 4; j++)
-            coeff(i, j) = a(j);
-    }
+bool ur5_check_configuration(const JointStateVector &th)
+{
+    // The trigonometry of the configuration is shared by the two checks
+    JointTrig trig(th);
+    RigidTransform pose = ur5_direct(trig);
 
-    // Allocate dynamically the return vector
-    double *theta = (double *)malloc(sizeof(double) * 6 * n);
+    // Check position constraints
+    if (ur5_workbench_distance(pose.pos) < 0)
+        return false;
 
-    for (double t = 0; t < 1; t += 1.0 / n)
-    {
-        for (int i = 0; i < 6; i++)
-        {
-            double q = coeff(i, 0) + coeff(i, 1) * t + coeff(i, 2) * t * t + coeff(i, 3) * t * t * t;
-            theta[(int)(t * n) * 6 + i] = q;
-        }
-    }
+    // Check singularity with jacobian determinant and singular values (analytic)
+    return !ur5_is_singular(trig, 0.00001);
+}
 
-    return theta;
+JointLimits ur5_joint_limits(void)
+{
+    JointLimits limits;
+    limits.velocity << 1.0, 1.0, 1.0, 1.0, 1.0, 1.0;
+    limits.acceleration << 2.0, 2.0, 2.0, 2.0, 2.0, 2.0;
+    limits.jerk << 15.0, 15.0, 15.0, 15.0, 15.0, 15.0;
+    return limits;
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "kinematics_lib/ur5_kinematics.h"
+
+/* Public functions */
+
+UrSingularity ur5_singularity(const JointStateVector &th)
+{
+    return ur_singularity<UR5Model>(JointTrig(th));
+}
+
+double ur5_manipulability(const JointStateVector &th)
+{
+    return ur_manipulability<UR5Model>(JointTrig(th));
+}
+
+bool ur5_is_singular(const JointTrig &t, double threshold)
+{
+    return ur_is_singular<UR5Model>(t, threshold);
+}
\ No newline at end of file
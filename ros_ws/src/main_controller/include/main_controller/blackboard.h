@@ -0,0 +1,144 @@
+/**
+* @file blackboard.h
+* @brief Header file for the blackboard shared by the state machines of Shelfino and UR5
+*
+* @date 17/10/2026
+*/
+
+#ifndef __BLACKBOARD_H__
+#define __BLACKBOARD_H__
+
+#include "robotic_vision/BoundingBox.h"
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * @brief Time of the state machines, the steady clock shared by both of them.
+ * A simulated clock gives each state machine its own virtual time, synchronized at the handoff points.
+ * @class MissionClock
+ */
+class MissionClock
+{
+public:
+    virtual ~MissionClock() {}
+
+    /**
+     * @return The time of the calling state machine, in seconds
+     */
+    virtual double now(void);
+
+    /**
+     * The calling state machine waited at a handoff point for the other one, which arrived at the given time
+     *
+     * @param time The time of arrival of the other state machine, in seconds
+     */
+    virtual void wait_until(double time);
+};
+
+/**
+ * @brief Block handed over from Shelfino to the UR5
+ */
+struct Handoff
+{
+    int model; // Number of the area of the block, name of its gazebo model
+    robotic_vision::BoundingBox box; // Block detected and classified by shelfino
+};
+
+/**
+ * @brief Throughput of the mission
+ */
+struct MissionStats
+{
+    int blocks; // Blocks sorted in the baskets
+    double makespan; // Seconds from the start of the mission to the last block sorted
+    double shelfino_busy; // Seconds spent by shelfino out of the handoff points
+    double ur5_busy; // Seconds spent by UR5 out of the handoff points
+    double blocks_per_hour;
+    double sequential_blocks_per_hour; // Estimated for a single state machine: the busy times do not overlap
+};
+
+/**
+ * @brief Thread-safe state shared by the state machines of Shelfino and UR5, and their handoff points.
+ * Shelfino parks with a block and waits until UR5 has grabbed and lifted it, then it goes to the next area while
+ * UR5 sorts the block. The time spent waiting at the handoff points is the idle time of each robot.
+ * @class Blackboard
+ */
+class Blackboard
+{
+private:
+    MissionClock steady_clock;
+    MissionClock *clock;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+
+    bool parked; // A block is on shelfino, not yet grabbed by UR5
+    bool shelfino_stopped; // Shelfino will not bring other blocks
+    bool ur5_stopped; // UR5 will not grab other blocks
+    Handoff block;
+    int blocks_sorted;
+
+    double start_time, parked_time, taken_time, shelfino_end, ur5_end;
+    double shelfino_idle, ur5_idle;
+
+public:
+    Blackboard();
+
+    Blackboard(const Blackboard &) = delete;
+    Blackboard &operator=(const Blackboard &) = delete;
+
+    /**
+     * Replace the steady clock, before the mission starts
+     *
+     * @param mission_clock The clock of the state machines, it must outlive the blackboard
+     */
+    void set_clock(MissionClock *mission_clock);
+
+    /**
+     * The mission starts now, before the state machines
+     */
+    void start(void);
+
+    /**
+     * Shelfino: the block is parked in the workcell of UR5, wait until UR5 has grabbed and lifted it
+     *
+     * @param parked_block The block on shelfino
+     * @return false if UR5 stopped before grabbing the block
+     */
+    bool hand_over(const Handoff &parked_block);
+
+    /**
+     * UR5: wait for the next parked block
+     *
+     * @param parked_block Output, the block on shelfino
+     * @return false if shelfino stopped and no block is parked
+     */
+    bool wait_block(Handoff &parked_block);
+
+    /**
+     * UR5: the parked block is grabbed and lifted clear of shelfino (or UR5 gave up grabbing it), shelfino can leave
+     */
+    void block_taken(void);
+
+    /**
+     * UR5: the block is in its basket
+     */
+    void block_sorted(void);
+
+    /**
+     * Shelfino: the state machine stopped, no more blocks to search
+     */
+    void shelfino_done(void);
+
+    /**
+     * UR5: the state machine stopped
+     */
+    void ur5_done(void);
+
+    /**
+     * @return The number of blocks sorted, the makespan and the throughput with and without the overlap
+     */
+    MissionStats stats(void) const;
+};
+
+#endif
\ No newline at end of file
@@ -11,18 +11,24 @@
 #define __FSM_H__
 
 #include "ros/ros.h"
-#include "ur5_controller/MoveTo.h"
+#include "ur5_controller/MoveThrough.h"
+#include "ur5_controller/CheckReachable.h"
 #include "ur5_controller/SetGripper.h"
-#include "shelfino_controller/MoveTo.h"
-#include "shelfino_controller/Rotate.h"
 #include "shelfino_controller/PointTo.h"
-#include "shelfino_controller/MoveForward.h"
 #include "robotic_vision/Detect.h"
 #include "robotic_vision/Ping.h"
 #include "robotic_vision/PointCloud.h"
 #include "gazebo_msgs/SetModelState.h"
 #include "gazebo_msgs/GetModelState.h"
 #include "gazebo_ros_link_attacher/Attach.h"
+#include "main_controller/blackboard.h"
+#include "main_controller/route_planner.h"
+#include "ur5_controller/MoveToAction.h"
+#include "shelfino_controller/MoveToAction.h"
+#include "shelfino_controller/RotateAction.h"
+#include "shelfino_controller/MoveForwardAction.h"
+#include <actionlib/client/simple_action_client.h>
+#include <future>
 #include <vector>
 #include <map>
 
@@ -38,6 +44,7 @@ typedef enum
     STATE_SHELFINO_PARK,
     STATE_UR5_LOAD,
     STATE_UR5_UNLOAD,
+    STATE_UR5_WAIT_BLOCK,
     STATE_END
 } State_t;
 
@@ -52,6 +59,11 @@ typedef void (*state_function)(void);
  */
 typedef std::map<int, state_function> StateMachine_t;
 
+/**
+ * State machines of the assignments (defined into fsm_mission.cpp), the UR5 runs fsm_ass_3_ur5 at the same time as fsm_ass_3
+ */
+extern StateMachine_t fsm_test, fsm_ass_1, fsm_ass_2, fsm_ass_3, fsm_ass_3_ur5;
+
 /** 
  * State functions for the three assignments.
  * For a description of the state functions, please refer to the project report.
@@ -84,7 +96,9 @@ namespace ass_2
 }
 
 /**
- * @brief State functions for assignment 3
+ * @brief State functions for assignment 3.
+ * Shelfino and UR5 run two state machines at the same time (current_state and ur5_state),
+ * they meet at the handoff points of the blackboard: UR5 sorts a block while Shelfino searches the next one.
  */
 namespace ass_3
 {
@@ -94,6 +108,7 @@ namespace ass_3
     void shelfino_search_block(void);
     void shelfino_check_block(void);
     void shelfino_park(void);
+    void ur5_wait_block(void);
     void ur5_load(void);
     void ur5_unload(void);    
 }
@@ -101,8 +116,72 @@ namespace ass_3
 /* Utils */
 
 /**
- * Send request to shelfino service move_to.
- * Update final position of shelfino
+ * Outcome of an asynchronous movement: ready when the action server has completed the goal,
+ * true if the goal succeeded (false if aborted or preempted)
+ */
+typedef std::shared_future<bool> MotionFuture;
+
+/**
+ * Create the clients of the action servers of UR5 and Shelfino, each one with its own spinner thread,
+ * and wait for the servers
+ */
+void setup_action_clients(void);
+
+/**
+ * Send a goal to the UR5 action server move_to_action, without waiting for the movement.
+ * Only one UR5 movement at a time: wait for the future before sending another goal.
+ * 
+ * @param pos The final desired position of the end-effector
+ * @param rot The final desired rotation of the end-effector
+ * @param linear If true the end-effector moves along the straight line to the final pose
+ * @return The outcome of the movement
+ */
+MotionFuture ur5_move_async(const ur5_controller::Coordinates& pos, const ur5_controller::EulerRotation& rot, bool linear = false);
+
+/**
+ * Send a goal to the Shelfino action server move_to_action, without waiting for the movement.
+ * The position and rotation of shelfino are updated before the future becomes ready.
+ * Only one Shelfino movement at a time: wait for the future before sending another goal.
+ * 
+ * @param x The x coordinate
+ * @param y The y coordinate
+ * @param yaw The final rotation. If yaw == 0 do not rotate
+ * @return The outcome of the movement
+ */
+MotionFuture shelfino_move_to_async(double x, double y, double yaw);
+
+/**
+ * Send a goal to the Shelfino action server move_forward_action, without waiting for the movement.
+ * The position of shelfino is updated before the future becomes ready.
+ * 
+ * @param distance The distance shelfino should run
+ * @param control Enables Lyapunov control on straight movement
+ * @return The outcome of the movement
+ */
+MotionFuture shelfino_forward_async(double distance, bool control);
+
+/**
+ * Send a goal to the Shelfino action server rotate_action, without waiting for the movement.
+ * The rotation of shelfino is updated before the future becomes ready.
+ * 
+ * @param angle The rotation angle (negative for clockwise rotation)
+ * @return The outcome of the movement
+ */
+MotionFuture shelfino_rotate_async(double angle);
+
+/**
+ * Preempt the running UR5 movement, the robot stops at its last setpoint
+ */
+void ur5_cancel(void);
+
+/**
+ * Preempt the running Shelfino movement, shelfino stops
+ */
+void shelfino_cancel(void);
+
+/**
+ * Send goal to shelfino action server move_to_action and wait for the movement.
+ * Update final position of shelfino. The goal is preempted if ROS shuts down or the movement does not end in time
  * 
  * @param x The x coordinate
  * @param y The y coordinate
@@ -111,8 +190,8 @@ namespace ass_3
 void shelfino_move_to(double x, double y, double yaw);
 
 /**
- * Send request to shelfino service forward.
- * Update final position of shelfino
+ * Send goal to shelfino action server move_forward_action and wait for the movement.
+ * Update final position of shelfino. The goal is preempted if ROS shuts down or the movement does not end in time
  * 
  * @param distance The distance shelfino should run
  * @param control Enables Lyapunov control on straight movement
@@ -120,13 +199,22 @@ void shelfino_move_to(double x, double y, double yaw);
 void shelfino_forward(double distance, bool control);
 
 /**
- * Send request to shelfino service rotate
- * Update final rotation of shelfino
+ * Send goal to shelfino action server rotate_action and wait for the movement.
+ * Update final rotation of shelfino. The goal is preempted if ROS shuts down or the movement does not end in time
  * 
  * @param angle The rotation angle (negative for clockwise rotation)
  */
 void shelfino_rotate(double angle);
 
+/**
+ * Sort the remaining areas in the order of visit that minimizes the movements of shelfino from its current pose,
+ * with the velocities /shelfino_linear_velocity and /shelfino_angular_velocity (default 0.2).
+ * The next area to visit becomes areas[0].
+ * 
+ * @param park If not null, shelfino goes back to this pose after every area
+ */
+void order_areas(const RoutePose *park = nullptr);
+
 /**
  * Send request to shelfino service point_to
  * Update final rotation of shelfino
@@ -137,13 +225,33 @@ void shelfino_rotate(double angle);
 void shelfino_point_to(double x, double y);
 
 /**
- * Send request to UR5 service move_to.
+ * Send goal to UR5 action server move_to_action and wait for the movement.
+ * The goal is preempted if ROS shuts down or the movement does not end in time
  * 
  * @param pos The final desired position of the end-effector
  * @param rot The final desired rotation of the end-effector
+ * @param linear If true the end-effector moves along the straight line to the final pose
  * @return true if the movement was completed
  */
-bool ur5_move(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot);
+bool ur5_move(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot, bool linear = false);
+
+/**
+ * Send request to UR5 service move_through: the UR5 does not stop at the intermediate positions.
+ * 
+ * @param pos The desired positions of the end-effector, the last one is the final position
+ * @param rot The desired rotation of the end-effector, the same for every position
+ * @return true if the movement was completed
+ */
+bool ur5_move_through(std::vector<ur5_controller::Coordinates>& pos, ur5_controller::EulerRotation& rot);
+
+/**
+ * Send request to UR5 service check_reachable, answered in constant time by the reachability map.
+ * 
+ * @param pos The desired position of the end-effector
+ * @param rot The desired rotation of the end-effector
+ * @return The number of valid ik solutions around the position (0 if unreachable), -1 if unknown
+ */
+int ur5_reachability(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot);
 
 /**
  * Send request to UR5 service set_gripper.
@@ -159,6 +267,50 @@ void ur5_grip(double diameter);
  */
 bool shelfino_detect(void);
 
+/**
+ * Send request to vision node service for shelfino camera, close to the detected block.
+ * Keep the new classification if it is more accurate
+ */
+void shelfino_classify(void);
+
+/**
+ * Send request to vision node service stop: the block classified by shelfino is not detected anymore
+ */
+void shelfino_blacklist(void);
+
+/**
+ * Send request to vision node service for UR5 camera.
+ * Update the block classified by UR5
+ * 
+ * @param x Output, the x coordinate of the block in the world frame
+ * @param y Output, the y coordinate of the block in the world frame
+ * @return true if a block is detected
+ */
+bool ur5_detect(double &x, double &y);
+
+/**
+ * Send request to gazebo service get_model_state.
+ * 
+ * @param model The name of the model
+ * @return The pose of the model in the world frame
+ */
+geometry_msgs::Pose gazebo_get_pose(const std::string &model);
+
+/**
+ * Send request to gazebo service set_model_state.
+ * 
+ * @param model The name of the model
+ * @param pose The new pose of the model in the world frame
+ */
+void gazebo_set_pose(const std::string &model, const geometry_msgs::Pose &pose);
+
+/**
+ * Wait in the current state, the robots do not move
+ * 
+ * @param seconds The time to wait
+ */
+void fsm_sleep(double seconds);
+
 void attach(int model, bool gripper);
 void detach(int model, bool gripper);
 void state_test(void);
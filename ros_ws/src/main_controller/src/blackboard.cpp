@@ -0,0 +1,114 @@
+#include "main_controller/blackboard.h"
+#include <algorithm>
+#include <chrono>
+
+/* Public functions */
+
+double MissionClock::now(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void MissionClock::wait_until(double)
+{
+    // The steady clock went on while waiting
+}
+
+Blackboard::Blackboard() : clock(&steady_clock), parked(false), shelfino_stopped(false), ur5_stopped(false), blocks_sorted(0),
+    start_time(0), parked_time(0), taken_time(0), shelfino_end(0), ur5_end(0), shelfino_idle(0), ur5_idle(0)
+{
+}
+
+void Blackboard::set_clock(MissionClock *mission_clock)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    clock = mission_clock;
+}
+
+void Blackboard::start(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    start_time = clock->now();
+    shelfino_idle = 0;
+    ur5_idle = 0;
+}
+
+bool Blackboard::hand_over(const Handoff &parked_block)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    block = parked_block;
+    parked = true;
+    parked_time = clock->now();
+    changed.notify_all();
+
+    double wait_start = clock->now();
+    changed.wait(lock, [this] { return !parked || ur5_stopped; });
+    clock->wait_until(parked ? ur5_end : taken_time);
+    shelfino_idle += clock->now() - wait_start;
+    return !parked;
+}
+
+bool Blackboard::wait_block(Handoff &parked_block)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    double wait_start = clock->now();
+    changed.wait(lock, [this] { return parked || shelfino_stopped; });
+    clock->wait_until(parked ? parked_time : shelfino_end);
+    ur5_idle += clock->now() - wait_start;
+
+    if (!parked)
+        return false;
+
+    parked_block = block;
+    return true;
+}
+
+void Blackboard::block_taken(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    parked = false;
+    taken_time = clock->now();
+    changed.notify_all();
+}
+
+void Blackboard::block_sorted(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    blocks_sorted++;
+}
+
+void Blackboard::shelfino_done(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    shelfino_stopped = true;
+    shelfino_end = clock->now();
+    changed.notify_all();
+}
+
+void Blackboard::ur5_done(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ur5_stopped = true;
+    ur5_end = clock->now();
+    changed.notify_all();
+}
+
+MissionStats Blackboard::stats(void) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    double now = clock->now();
+    double shelfino_stop = shelfino_stopped ? shelfino_end : now;
+    double ur5_stop = ur5_stopped ? ur5_end : now;
+
+    MissionStats s;
+    s.blocks = blocks_sorted;
+    s.makespan = std::max(shelfino_stop, ur5_stop) - start_time;
+    s.shelfino_busy = shelfino_stop - start_time - shelfino_idle;
+    s.ur5_busy = ur5_stop - start_time - ur5_idle;
+    s.blocks_per_hour = s.makespan > 0 ? s.blocks * 3600.0 / s.makespan : 0;
+
+    // A single state machine moves one robot at a time: its makespan is the sum of the busy times
+    double sequential = s.shelfino_busy + s.ur5_busy;
+    s.sequential_blocks_per_hour = sequential > 0 ? s.blocks * 3600.0 / sequential : 0;
+    return s;
+}
\ No newline at end of file
@@ -1,60 +1,24 @@
 #include "main_controller/fsm.h"
 #include <ros/console.h>
+#include <thread>
 
 using namespace std;
 
 /* Extern variables */
 
-extern ros::ServiceClient shelfino_move_client, shelfino_point_client,
-    shelfino_rotate_client, shelfino_forward_client, 
+extern ros::ServiceClient shelfino_point_client,
     gazebo_link_attacher, gazebo_link_detacher,
-    ur5_move_client, ur5_gripper_client,
+    ur5_move_through_client, ur5_gripper_client,
+    ur5_reachable_client,
     detection_client, gazebo_set_state, 
     gazebo_get_state, vision_stop_client, 
     pointcloud_client;
 
+extern State_t current_state, ur5_state;
 extern std::vector<std::vector<double>> areas;
 extern bool real_robot;
-
-/* FSM Functions arrays for the three assignments */
-
-StateMachine_t fsm_test = {
-    {STATE_INIT, state_test},
-};
-
-StateMachine_t fsm_ass_1 = {
-    {STATE_INIT, ass_1::init},
-    {STATE_SHELFINO_ROTATE_AREA, ass_1::shelfino_rotate_towards_next_area},
-    {STATE_SHELFINO_NEXT_AREA, ass_1::shelfino_next_area},
-    {STATE_SHELFINO_SEARCH_BLOCK, ass_1::shelfino_search_block},
-    {STATE_SHELFINO_CHECK_BLOCK, ass_1::shelfino_check_block},
-};
-
-StateMachine_t fsm_ass_2 = {
-    {STATE_INIT, ass_2::init},
-    {STATE_SHELFINO_ROTATE_AREA, ass_2::shelfino_rotate_towards_next_area},
-    {STATE_SHELFINO_NEXT_AREA, ass_2::shelfino_next_area},
-    {STATE_SHELFINO_SEARCH_BLOCK, ass_2::shelfino_search_block},
-    {STATE_SHELFINO_CHECK_BLOCK, ass_2::shelfino_check_block},
-    {STATE_UR5_LOAD, ass_2::ur5_load},
-    {STATE_UR5_UNLOAD, ass_2::ur5_unload},
-};
-
-StateMachine_t fsm_ass_3 = {
-    {STATE_INIT, ass_3::init},
-    {STATE_SHELFINO_ROTATE_AREA, ass_3::shelfino_rotate_towards_next_area},
-    {STATE_SHELFINO_NEXT_AREA, ass_3::shelfino_next_area},
-    {STATE_SHELFINO_SEARCH_BLOCK, ass_3::shelfino_search_block},
-    {STATE_SHELFINO_CHECK_BLOCK, ass_3::shelfino_check_block},
-    {STATE_SHELFINO_PARK, ass_3::shelfino_park},
-    {STATE_UR5_LOAD, ass_3::ur5_load},
-    {STATE_UR5_UNLOAD, ass_3::ur5_unload},
-};
-
-/* Global variables */
-
-State_t current_state;
-std::vector<std::vector<double>> areas;
+extern Blackboard blackboard;
+extern double shelfino_linear_velocity, shelfino_angular_velocity;
 
 void get_world_params(ros::NodeHandle& n)
 {
@@ -82,12 +46,10 @@ int main(int argc, char **argv)
     ROS_INFO("Using real robot: %d", real_robot);
     
     // Setup services
-    ur5_move_client = fsm_node.serviceClient<ur5_controller::MoveTo>("ur5/move_to");
+    ur5_move_through_client = fsm_node.serviceClient<ur5_controller::MoveThrough>("ur5/move_through");
+    ur5_reachable_client = fsm_node.serviceClient<ur5_controller::CheckReachable>("ur5/check_reachable");
     ur5_gripper_client = fsm_node.serviceClient<ur5_controller::SetGripper>("ur5/set_gripper");
-    shelfino_move_client = fsm_node.serviceClient<shelfino_controller::MoveTo>("shelfino/move_to");
-    shelfino_rotate_client = fsm_node.serviceClient<shelfino_controller::Rotate>("shelfino/rotate");
     shelfino_point_client = fsm_node.serviceClient<shelfino_controller::PointTo>("shelfino/point_to");
-    shelfino_forward_client = fsm_node.serviceClient<shelfino_controller::MoveForward>("shelfino/move_forward");
 
     // Vision services
     detection_client = fsm_node.serviceClient<robotic_vision::Detect>("shelfino/yolo/detect");
@@ -102,17 +64,35 @@ int main(int argc, char **argv)
 
     // Get world params
     get_world_params(fsm_node);
+    ros::param::get("/shelfino_linear_velocity", shelfino_linear_velocity);
+    ros::param::get("/shelfino_angular_velocity", shelfino_angular_velocity);
 
     // Initial state
     current_state = STATE_INIT;
 
-    // Wait for other ROS nodes
-    ur5_move_client.waitForExistence();
-    shelfino_rotate_client.waitForExistence();
-    shelfino_forward_client.waitForExistence();
+    // Wait for other ROS nodes, the movements of UR5 and Shelfino are actions
+    setup_action_clients();
     detection_client.waitForExistence();
     // system("clear");
 
+    // The state machine of UR5 starts after the init state of shelfino
+    std::thread ur5_fsm;
+    if (assignment_number == 3)
+    {
+        ass_3::init();
+        blackboard.start();
+        ur5_fsm = std::thread([] {
+            ros::Rate ur5_rate(100.);
+            while (ros::ok() && ur5_state < STATE_END)
+            {
+                ROS_DEBUG("Executing UR5 state function %d", ur5_state);
+                (fsm_ass_3_ur5[ur5_state])();
+                ur5_rate.sleep();
+            }
+            blackboard.ur5_done();
+        });
+    }
+
     while (ros::ok())
     {
         if (current_state < STATE_END)
@@ -133,10 +113,30 @@ int main(int argc, char **argv)
         }
         else
         {
-            ROS_INFO("Mission completed!");
             break;
         }
     }
 
+    if (assignment_number == 3)
+    {
+        // After Ctrl-C the UR5 state machine ends with its current state: the movement in progress is preempted,
+        // the next ones and the service calls fail without waiting, and the handoff points are released
+        if (!ros::ok())
+        {
+            ROS_INFO("Stopping the UR5 state machine");
+            ur5_cancel();
+        }
+        blackboard.shelfino_done();
+        ur5_fsm.join();
+
+        MissionStats stats = blackboard.stats();
+        ROS_INFO("Sorted %d blocks in %.1f s: %.1f blocks/hour, %.1f blocks/hour without overlapping UR5 and Shelfino (+%.0f%%)",
+            stats.blocks, stats.makespan, stats.blocks_per_hour, stats.sequential_blocks_per_hour,
+            stats.sequential_blocks_per_hour > 0 ? (stats.blocks_per_hour / stats.sequential_blocks_per_hour - 1) * 100 : 0.);
+        ROS_INFO("Shelfino busy %.1f s, UR5 busy %.1f s", stats.shelfino_busy, stats.ur5_busy);
+    }
+
+    if (current_state >= STATE_END)
+        ROS_INFO("Mission completed!");
     return 0;
 }
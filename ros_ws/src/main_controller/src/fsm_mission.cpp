@@ -0,0 +1,88 @@
+#include "main_controller/fsm.h"
+
+/* FSM Functions arrays for the three assignments, run by the fsm node and by the simulator */
+
+StateMachine_t fsm_test = {
+    {STATE_INIT, state_test},
+};
+
+StateMachine_t fsm_ass_1 = {
+    {STATE_INIT, ass_1::init},
+    {STATE_SHELFINO_ROTATE_AREA, ass_1::shelfino_rotate_towards_next_area},
+    {STATE_SHELFINO_NEXT_AREA, ass_1::shelfino_next_area},
+    {STATE_SHELFINO_SEARCH_BLOCK, ass_1::shelfino_search_block},
+    {STATE_SHELFINO_CHECK_BLOCK, ass_1::shelfino_check_block},
+};
+
+StateMachine_t fsm_ass_2 = {
+    {STATE_INIT, ass_2::init},
+    {STATE_SHELFINO_ROTATE_AREA, ass_2::shelfino_rotate_towards_next_area},
+    {STATE_SHELFINO_NEXT_AREA, ass_2::shelfino_next_area},
+    {STATE_SHELFINO_SEARCH_BLOCK, ass_2::shelfino_search_block},
+    {STATE_SHELFINO_CHECK_BLOCK, ass_2::shelfino_check_block},
+    {STATE_UR5_LOAD, ass_2::ur5_load},
+    {STATE_UR5_UNLOAD, ass_2::ur5_unload},
+};
+
+StateMachine_t fsm_ass_3 = {
+    {STATE_INIT, ass_3::init},
+    {STATE_SHELFINO_ROTATE_AREA, ass_3::shelfino_rotate_towards_next_area},
+    {STATE_SHELFINO_NEXT_AREA, ass_3::shelfino_next_area},
+    {STATE_SHELFINO_SEARCH_BLOCK, ass_3::shelfino_search_block},
+    {STATE_SHELFINO_CHECK_BLOCK, ass_3::shelfino_check_block},
+    {STATE_SHELFINO_PARK, ass_3::shelfino_park},
+};
+
+// Runs in its own thread, at the same time as the state machine of shelfino
+StateMachine_t fsm_ass_3_ur5 = {
+    {STATE_UR5_WAIT_BLOCK, ass_3::ur5_wait_block},
+    {STATE_UR5_LOAD, ass_3::ur5_load},
+    {STATE_UR5_UNLOAD, ass_3::ur5_unload},
+};
+
+/* Global variables */
+
+State_t current_state;
+State_t ur5_state = STATE_END;
+std::vector<std::vector<double>> areas;
+
+/* State global variables */
+
+shelfino_controller::Coordinates shelfino_current_pos, block_pos;
+ur5_controller::Coordinates ur5_home_pos, ur5_load_pos, ur5_unload_pos;
+ur5_controller::EulerRotation ur5_default_rot;
+geometry_msgs::Pose block_load_pos;
+double shelfino_current_rot; // Shelfino current rotation angle
+int current_area_index; // Index of the current area in the areas array (different to area number)
+robotic_vision::BoundingBox block_shelfino; // Block detected and classified by shelfino
+robotic_vision::BoundingBox block_ur5; // Block detected and classified by ur5
+double block_angle; // If the block is not centered in front of shelfino
+int choosen_block_class; // Class of the detected block choosen after classification from shelfino and ur5
+
+std::vector<double> unload_pos_y;
+std::map<int, int> class_to_basket_map;
+Blackboard blackboard; // Shared by the state machines of shelfino and UR5
+double shelfino_linear_velocity = 0.2, shelfino_angular_velocity = 0.2; // Cost model of the order of the areas
+
+void order_areas(const RoutePose *park)
+{
+    if (areas.size() < 2)
+        return;
+
+    RoutePlanner planner(shelfino_linear_velocity, shelfino_angular_velocity);
+    if (park)
+        planner.set_park(*park);
+
+    RoutePose start = {shelfino_current_pos.x, shelfino_current_pos.y, shelfino_current_rot};
+    std::vector<int> order = planner.plan(start, areas);
+
+    std::vector<std::vector<double>> ordered;
+    std::string log;
+    for (int i : order)
+    {
+        ordered.push_back(areas[i]);
+        log += " " + std::to_string((int)areas[i][3]);
+    }
+    ROS_INFO("Order of the areas:%s (%.1f s of movements)", log.data(), planner.route_time(start, areas, order));
+    areas.swap(ordered);
+}
\ No newline at end of file
@@ -0,0 +1,535 @@
+/**
+* @file fsm_simulator.cpp
+* @brief Headless mission simulator: runs the state machines of an assignment (fsm_ass_1, fsm_ass_2, fsm_ass_3)
+* against mock robots, vision and gazebo services with a kinematic time model, on a virtual clock.
+* No ROS master, gazebo or YOLO are needed and the missions run much faster than real time; the result only depends
+* on the areas and on the seed, so the makespan, the time spent in each state and the blocks/hour can be compared
+* across commits to catch the throughput regressions of the state machines.
+* Exit code: 2 if the mission reached the time limit, 3 if a block was left behind or the blocks/hour are below the
+* given minimum (the regression tests of CMakeLists.txt run the areas files of the launch folder with their baselines).
+*
+* Usage: fsm_simulator <assignment> <areas file> [seed] [min blocks/hour]
+*/
+
+#include "main_controller/fsm.h"
+#include <ros/console.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+/* Global state variables (defined into fsm_mission.cpp) */
+
+extern State_t current_state, ur5_state;
+extern std::vector<std::vector<double>> areas;
+extern shelfino_controller::Coordinates shelfino_current_pos, block_pos;
+extern double shelfino_current_rot;
+extern robotic_vision::BoundingBox block_shelfino;
+extern robotic_vision::BoundingBox block_ur5;
+extern double block_angle;
+extern Blackboard blackboard;
+extern double shelfino_linear_velocity, shelfino_angular_velocity;
+
+/* Time model */
+
+const double detection_time = 0.3; // YOLO inference on the shelfino camera (s)
+const double pointcloud_time = 0.5; // Detection on the UR5 camera (s)
+const double detection_range = 1.2; // Maximum distance of a block detected by shelfino (m)
+const double camera_fov = M_PI / 6; // Half field of view of the shelfino camera (rad)
+const double ur5_velocity = 0.25; // Mean velocity of the end effector (m/s)
+const double ur5_settle_time = 0.5; // Start and stop of every UR5 movement (s)
+const double ur5_first_move_time = 3.0; // First movement, from an unknown configuration (s)
+const double gripper_time = 1.0; // Open or close the gripper (s)
+const double ur5_camera_range = 1.2; // Maximum distance of a block from the UR5 base seen by its camera (m)
+const double time_limit = 4 * 3600; // Virtual time after which a mission is considered stuck (s)
+
+// Origin of the frame of shelfino (its initial position) and of the UR5 base in the world frame of gazebo
+const double shelfino_origin_x = 0.5, shelfino_origin_y = 1.2;
+const double ur5_base_x = 0.5, ur5_base_y = 0.35;
+
+/* Virtual clock */
+
+/**
+ * Time of the state machine running on the calling thread, in seconds
+ */
+thread_local double sim_time = 0;
+
+/**
+ * @brief Virtual clock of the blackboard: each state machine has its own time, the one that waits at a
+ * handoff point jumps to the time of arrival of the other one. The times never depend on the scheduling of the threads.
+ */
+class SimClock : public MissionClock
+{
+public:
+    double now(void) override
+    {
+        return sim_time;
+    }
+
+    void wait_until(double time) override
+    {
+        sim_time = std::max(sim_time, time);
+    }
+};
+
+/* Mock world */
+
+typedef enum
+{
+    BLOCK_GROUND,
+    BLOCK_SHELFINO,
+    BLOCK_GRIPPER,
+    BLOCK_BASKET
+} BlockHolder_t;
+
+struct SimBlock
+{
+    int model;
+    int class_n;
+    double x, y; // Frame of shelfino
+    BlockHolder_t holder;
+    bool blacklisted; // Not detected anymore by the shelfino camera
+};
+
+std::mutex world_mutex; // The state machines of shelfino and UR5 of assignment 3 share the blocks
+std::vector<SimBlock> blocks;
+int last_detected = -1; // Index of the block detected by shelfino
+bool ur5_moved = false;
+ur5_controller::Coordinates ur5_position; // End effector, frame of the UR5
+int blocks_classified = 0, blocks_sorted = 0;
+
+/**
+ * @return The index of the closest block seen by shelfino from the given pose, -1 if none
+ */
+static int visible_block(double x, double y, double rot)
+{
+    int closest = -1;
+    double closest_distance = detection_range;
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        if (blocks[i].holder != BLOCK_GROUND || blocks[i].blacklisted)
+            continue;
+
+        double distance = hypot(blocks[i].x - x, blocks[i].y - y);
+        double bearing = atan2(blocks[i].y - y, blocks[i].x - x) - rot;
+        bearing = atan2(sin(bearing), cos(bearing));
+        if (distance <= closest_distance && fabs(bearing) <= camera_fov)
+        {
+            closest = i;
+            closest_distance = distance;
+        }
+    }
+    return closest;
+}
+
+/**
+ * Rotate shelfino, it stops as soon as a block is in view if stop_on_block
+ *
+ * @return The final rotation
+ */
+static double sim_rotate(double angle, bool stop_on_block)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    const double step = M_PI / 180;
+    double rotated = 0;
+    while (rotated < fabs(angle))
+    {
+        rotated = std::min(rotated + step, fabs(angle));
+        if (stop_on_block && visible_block(shelfino_current_pos.x, shelfino_current_pos.y, shelfino_current_rot + copysign(rotated, angle)) != -1)
+            break;
+    }
+    sim_time += rotated / shelfino_angular_velocity;
+    return atan2(sin(shelfino_current_rot + copysign(rotated, angle)), cos(shelfino_current_rot + copysign(rotated, angle)));
+}
+
+/**
+ * Move shelfino straight, it stops as soon as a block is in view if stop_on_block
+ */
+static void sim_forward(double distance, bool stop_on_block)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    const double step = 0.01;
+    double travelled = 0;
+    while (travelled < distance)
+    {
+        travelled = std::min(travelled + step, distance);
+        if (stop_on_block && visible_block(shelfino_current_pos.x + travelled * cos(shelfino_current_rot),
+            shelfino_current_pos.y + travelled * sin(shelfino_current_rot), shelfino_current_rot) != -1)
+            break;
+    }
+    sim_time += travelled / shelfino_linear_velocity;
+    shelfino_current_pos.x += travelled * cos(shelfino_current_rot);
+    shelfino_current_pos.y += travelled * sin(shelfino_current_rot);
+}
+
+/**
+ * Move the end effector of the UR5 through the given positions, without stopping
+ */
+static void sim_ur5_move(const std::vector<ur5_controller::Coordinates> &pos)
+{
+    double length = 0;
+    for (const ur5_controller::Coordinates &p : pos)
+    {
+        length += sqrt(pow(p.x - ur5_position.x, 2) + pow(p.y - ur5_position.y, 2) + pow(p.z - ur5_position.z, 2));
+        ur5_position = p;
+    }
+    sim_time += ur5_moved ? ur5_settle_time + length / ur5_velocity : ur5_first_move_time;
+    ur5_moved = true;
+}
+
+/* Mock robot, vision and gazebo services */
+
+void shelfino_move_to(double x, double y, double yaw)
+{
+    // Vision is disabled while moving to a point
+    double first_rot = atan2(y - shelfino_current_pos.y, x - shelfino_current_pos.x) - shelfino_current_rot;
+    shelfino_current_rot = sim_rotate(atan2(sin(first_rot), cos(first_rot)), false);
+    sim_forward(hypot(x - shelfino_current_pos.x, y - shelfino_current_pos.y), false);
+    if (yaw != 0)
+        shelfino_current_rot = sim_rotate(atan2(sin(yaw - shelfino_current_rot), cos(yaw - shelfino_current_rot)), false);
+
+    shelfino_current_pos.x = x;
+    shelfino_current_pos.y = y;
+}
+
+void shelfino_forward(double distance, bool control)
+{
+    sim_forward(distance - 0.15, control);
+}
+
+void shelfino_rotate(double angle)
+{
+    shelfino_current_rot = sim_rotate(angle, true);
+}
+
+void shelfino_point_to(double x, double y)
+{
+    double rot = atan2(y - shelfino_current_pos.y, x - shelfino_current_pos.x) - shelfino_current_rot;
+    shelfino_current_rot = sim_rotate(atan2(sin(rot), cos(rot)), true);
+}
+
+bool shelfino_detect(void)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    sim_time += detection_time;
+    last_detected = visible_block(shelfino_current_pos.x, shelfino_current_pos.y, shelfino_current_rot);
+    if (last_detected == -1)
+        return false;
+
+    // Same outputs of the vision node and of the corrections of the real shelfino_detect
+    const SimBlock &block = blocks[last_detected];
+    double distance = hypot(block.x - shelfino_current_pos.x, block.y - shelfino_current_pos.y);
+    block_angle = atan2(block.y - shelfino_current_pos.y, block.x - shelfino_current_pos.x) - shelfino_current_rot;
+    block_angle = atan2(sin(block_angle), cos(block_angle));
+    double center = 320.0 - block_angle / (M_PI / 6.0) * 320.0;
+
+    block_shelfino = robotic_vision::BoundingBox();
+    block_shelfino.class_n = block.class_n;
+    block_shelfino.Class = "block_" + std::to_string(block.class_n);
+    block_shelfino.probability = std::max(0.5, 0.9 - 0.1 * distance);
+    block_shelfino.xmin = center - 20;
+    block_shelfino.xmax = center + 20;
+    block_shelfino.distance = distance - 0.65;
+    block_pos.x = block.x + shelfino_origin_x;
+    block_pos.y = block.y + shelfino_origin_y;
+    return true;
+}
+
+void shelfino_classify(void)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    sim_time += detection_time;
+    if (last_detected != -1 && 0.95 > block_shelfino.probability)
+        block_shelfino.probability = 0.95;
+}
+
+void shelfino_blacklist(void)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    if (last_detected != -1 && !blocks[last_detected].blacklisted)
+    {
+        blocks[last_detected].blacklisted = true;
+        blocks_classified++;
+    }
+}
+
+bool ur5_detect(double &x, double &y)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    sim_time += pointcloud_time;
+    for (const SimBlock &block : blocks)
+    {
+        double wx = block.x + shelfino_origin_x, wy = block.y + shelfino_origin_y;
+        if (block.holder == BLOCK_GROUND && hypot(wx - ur5_base_x, wy - ur5_base_y) <= ur5_camera_range)
+        {
+            x = wx;
+            y = wy;
+            block_ur5 = robotic_vision::BoundingBox();
+            block_ur5.class_n = block.class_n;
+            block_ur5.Class = "block_" + std::to_string(block.class_n);
+            block_ur5.probability = 0.8;
+            return true;
+        }
+    }
+    return false;
+}
+
+geometry_msgs::Pose gazebo_get_pose(const std::string &model)
+{
+    geometry_msgs::Pose pose;
+    if (model == "shelfino")
+    {
+        pose.position.x = shelfino_current_pos.x + shelfino_origin_x;
+        pose.position.y = shelfino_current_pos.y + shelfino_origin_y;
+        pose.orientation.w = cos(shelfino_current_rot / 2);
+        pose.orientation.z = sin(shelfino_current_rot / 2);
+    }
+    return pose;
+}
+
+void gazebo_set_pose(const std::string &model, const geometry_msgs::Pose &pose)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    for (SimBlock &block : blocks)
+    {
+        if (std::to_string(block.model) == model)
+        {
+            block.x = pose.position.x - shelfino_origin_x;
+            block.y = pose.position.y - shelfino_origin_y;
+            block.holder = BLOCK_GROUND;
+        }
+    }
+}
+
+void fsm_sleep(double seconds)
+{
+    sim_time += seconds;
+}
+
+bool ur5_move(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot, bool linear)
+{
+    sim_ur5_move({pos});
+    return true;
+}
+
+bool ur5_move_through(std::vector<ur5_controller::Coordinates>& pos, ur5_controller::EulerRotation& rot)
+{
+    sim_ur5_move(pos);
+    return true;
+}
+
+int ur5_reachability(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot)
+{
+    // As the service without a reachability map: never rejects a target
+    return -1;
+}
+
+void ur5_grip(double diameter)
+{
+    sim_time += gripper_time;
+}
+
+void attach(int model, bool gripper)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    for (SimBlock &block : blocks)
+        if (block.model == model)
+            block.holder = gripper ? BLOCK_GRIPPER : BLOCK_SHELFINO;
+}
+
+void detach(int model, bool gripper)
+{
+    std::lock_guard<std::mutex> lock(world_mutex);
+    for (SimBlock &block : blocks)
+    {
+        if (block.model != model)
+            continue;
+
+        if (gripper)
+        {
+            block.holder = BLOCK_BASKET;
+            blocks_sorted++;
+        }
+        else
+        {
+            // Left where shelfino is
+            block.x = shelfino_current_pos.x;
+            block.y = shelfino_current_pos.y;
+            block.holder = BLOCK_GROUND;
+        }
+    }
+}
+
+/* Mission */
+
+/**
+ * @brief Time spent by a state machine in one of its states
+ */
+struct StateTime
+{
+    long runs;
+    double time;
+};
+
+const char *state_names[] = {"init", "shelfino_rotate_area", "shelfino_next_area", "shelfino_search_block",
+    "shelfino_check_block", "shelfino_park", "ur5_load", "ur5_unload", "ur5_wait_block"};
+
+/**
+ * Run a state machine on the calling thread until its end (or the time limit)
+ *
+ * @return false if the time limit was reached
+ */
+static bool run_state_machine(StateMachine_t &fsm, State_t &state, std::map<int, StateTime> &breakdown)
+{
+    while (state < STATE_END)
+    {
+        if (sim_time > time_limit)
+            return false;
+
+        State_t executed = state;
+        double begin = sim_time;
+        fsm[state]();
+        breakdown[executed].runs++;
+        breakdown[executed].time += sim_time - begin;
+    }
+    return true;
+}
+
+/**
+ * Read the areas in the format of the areas files of the launch folder: areaN: [x, y, radius, index]
+ */
+static bool read_areas(const char *filename)
+{
+    ifstream file(filename);
+    if (!file)
+        return false;
+
+    std::map<std::string, std::vector<double>> values;
+    std::string line, key;
+    while (getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos)
+            continue;
+
+        if (line[first] == '-')
+            values[key].push_back(atof(line.substr(first + 1).data()));
+        else
+            key = line.substr(first, line.find(':') - first);
+    }
+
+    for (int i = 0; values.count("area" + std::to_string(i)); i++)
+        areas.push_back(values["area" + std::to_string(i)]);
+    return !areas.empty();
+}
+
+static void print_breakdown(const char *robot, const std::map<int, StateTime> &breakdown, double makespan)
+{
+    for (const std::pair<const int, StateTime> &s : breakdown)
+    {
+        cout << "  " << setw(9) << left << robot << setw(24) << state_names[s.first] << right
+            << setw(6) << s.second.runs << " runs" << setw(10) << s.second.time << " s"
+            << setw(8) << (makespan > 0 ? 100 * s.second.time / makespan : 0) << " %" << endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        cerr << "usage: " << argv[0] << " <assignment> <areas file> [seed] [min blocks/hour]" << endl;
+        return 1;
+    }
+
+    int assignment = atoi(argv[1]);
+    unsigned seed = argc > 3 ? atoi(argv[3]) : 0;
+    double min_blocks_per_hour = argc > 4 ? atof(argv[4]) : 0;
+    if (assignment < 1 || assignment > 3 || !read_areas(argv[2]))
+    {
+        cerr << "invalid assignment or areas file " << argv[2] << endl;
+        return 1;
+    }
+
+    // The log of the state machines would hide the report
+    if (ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Warn))
+        ros::console::notifyLoggerLevelsChanged();
+
+    // One block in every area, at a random position within its radius
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    for (const std::vector<double> &area : areas)
+    {
+        double angle = 2 * M_PI * uniform(generator);
+        double distance = area[2] * (0.2 + 0.4 * uniform(generator));
+        SimBlock block = {(int)area[3], (int)(4 * uniform(generator)), area[0] + distance * cos(angle),
+            area[1] + distance * sin(angle), BLOCK_GROUND, false};
+        blocks.push_back(block);
+    }
+
+    cout << fixed << setprecision(1);
+    SimClock clock;
+    std::map<int, StateTime> shelfino_breakdown, ur5_breakdown;
+    bool completed;
+    double makespan;
+    int blocks_done;
+    MissionStats stats;
+
+    if (assignment == 3)
+    {
+        // As the fsm node: the state machine of UR5 starts after the init state of shelfino
+        ass_3::init();
+        blackboard.set_clock(&clock);
+        blackboard.start();
+        double start_time = sim_time;
+        bool ur5_completed = true;
+        std::thread ur5_fsm([&] {
+            sim_time = start_time;
+            ur5_completed = run_state_machine(fsm_ass_3_ur5, ur5_state, ur5_breakdown);
+            blackboard.ur5_done();
+        });
+        completed = run_state_machine(fsm_ass_3, current_state, shelfino_breakdown);
+        blackboard.shelfino_done();
+        ur5_fsm.join();
+        completed = completed && ur5_completed;
+
+        stats = blackboard.stats();
+        makespan = stats.makespan;
+        blocks_done = stats.blocks;
+    }
+    else
+    {
+        current_state = STATE_INIT;
+        completed = run_state_machine(assignment == 1 ? fsm_ass_1 : fsm_ass_2, current_state, shelfino_breakdown);
+        makespan = sim_time;
+        blocks_done = assignment == 1 ? blocks_classified : blocks_sorted;
+    }
+
+    cout << "assignment " << assignment << ", " << blocks.size() << " areas, seed " << seed << (completed ? "" : ", TIME LIMIT REACHED") << endl;
+    double blocks_per_hour = makespan > 0 ? blocks_done * 3600.0 / makespan : 0;
+    cout << "blocks " << (assignment == 1 ? "classified" : "sorted") << ": " << blocks_done << " in " << makespan << " s, "
+        << blocks_per_hour << " blocks/hour" << endl;
+    if (assignment == 3)
+    {
+        cout << "shelfino busy " << stats.shelfino_busy << " s, UR5 busy " << stats.ur5_busy << " s, "
+            << stats.sequential_blocks_per_hour << " blocks/hour without overlapping UR5 and shelfino" << endl;
+    }
+    cout << "time in each state (shelfino and UR5 overlap in assignment 3):" << endl;
+    print_breakdown("shelfino", shelfino_breakdown, makespan);
+    print_breakdown("ur5", ur5_breakdown, makespan);
+
+    if (!completed)
+        return 2;
+    if (blocks_done < (int)blocks.size() || blocks_per_hour < min_blocks_per_hour)
+    {
+        cout << "THROUGHPUT REGRESSION: " << blocks_done << " of " << blocks.size() << " blocks, "
+            << blocks_per_hour << " blocks/hour (minimum " << min_blocks_per_hour << ")" << endl;
+        return 3;
+    }
+    return 0;
+}
\ No newline at end of file
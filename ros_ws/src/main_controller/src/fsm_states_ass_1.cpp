@@ -1,15 +1,7 @@
 #include "main_controller/fsm.h"
 #include <string> 
 
-/* Services */
-
-extern ros::ServiceClient detection_client;
-extern ros::ServiceClient vision_stop_client;
-
-extern robotic_vision::Detect detection_srv;
-extern robotic_vision::Ping vision_stop_srv;
-
-/* Global state variables (defined into fsm_utils.cpp) */
+/* Global state variables (defined into fsm_mission.cpp) */
 
 extern State_t current_state;
 extern std::vector<std::vector<double>> areas;
@@ -28,6 +20,7 @@ void ass_1::init(void)
     shelfino_current_pos.x = 0;
     shelfino_current_pos.y = 0;
     shelfino_current_rot = 0;
+    order_areas();
 
     current_state = STATE_SHELFINO_ROTATE_AREA;
 }
@@ -84,15 +77,11 @@ void ass_1::shelfino_check_block(void)
         0
     );
 
-    ros::Duration(1.0).sleep();
-    detection_client.call(detection_srv);
-    if (detection_srv.response.status == 1 && detection_srv.response.box.probability > block_shelfino.probability)
-    {
-        block_shelfino = detection_srv.response.box;
-    }
+    fsm_sleep(1.0);
+    shelfino_classify();
     
     ROS_INFO("Object classified: %s, position: (%.2f, %.2f)", block_shelfino.Class.data(), block_pos.x, block_pos.y);
-    vision_stop_client.call(vision_stop_srv); // Blacklist this block
+    shelfino_blacklist(); // Blacklist this block
 
     // Check in which area shelfino is
     bool area_found = false;
@@ -118,6 +107,7 @@ void ass_1::shelfino_check_block(void)
     ROS_INFO("Completed area %d, %ld remaining", (int)areas[current_area_index][3], areas.size() - 1);
     areas.erase(areas.begin() + current_area_index);
     current_area_index = 0;
+    order_areas();
 
     if (areas.size() == 0)
         current_state = STATE_END;
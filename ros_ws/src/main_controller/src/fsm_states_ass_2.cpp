@@ -1,17 +1,7 @@
 #include "main_controller/fsm.h"
 #include <string> 
 
-/* Services */
-
-extern ros::ServiceClient detection_client;
-extern ros::ServiceClient gazebo_set_state;	
-extern ros::ServiceClient vision_stop_client;
-
-extern robotic_vision::Detect detection_srv;
-extern robotic_vision::Ping vision_stop_srv;
-extern gazebo_msgs::SetModelState set_state_srv;
-
-/* Global state variables (defined into fsm_utils.cpp) */
+/* Global state variables (defined into fsm_mission.cpp) */
 
 extern State_t current_state;
 extern std::vector<std::vector<double>> areas;
@@ -42,6 +32,7 @@ void ass_2::init(void)
     shelfino_current_pos.x = 0;
     shelfino_current_pos.y = 0;
     shelfino_current_rot = 0;
+    order_areas();
     
     // Where to load the megablock
     ur5_load_pos.x = 0.0;
@@ -121,15 +112,11 @@ void ass_2::shelfino_check_block(void)
         0
     );
 
-    ros::Duration(1.0).sleep();
-    detection_client.call(detection_srv);
-    if (detection_srv.response.status == 1 && detection_srv.response.box.probability > block_shelfino.probability)
-    {
-        block_shelfino = detection_srv.response.box;
-    }
+    fsm_sleep(1.0);
+    shelfino_classify();
     
     ROS_INFO("Object classified: %s, position: (%.2f, %.2f)", block_shelfino.Class.data(), block_pos.x, block_pos.y);
-    vision_stop_client.call(vision_stop_srv);
+    shelfino_blacklist();
 
     // Choose the right basket based on the block class
     if (class_to_basket_map.find(block_shelfino.class_n) == class_to_basket_map.end())
@@ -161,9 +148,7 @@ void ass_2::shelfino_check_block(void)
     }
     
     // gazebo move block to ur5 load position
-    set_state_srv.request.model_state.model_name = std::to_string((int)areas[current_area_index][3]);
-    set_state_srv.request.model_state.pose = block_load_pos;
-    gazebo_set_state.call(set_state_srv);
+    gazebo_set_pose(std::to_string((int)areas[current_area_index][3]), block_load_pos);
 
     current_state = STATE_UR5_LOAD;
 }
@@ -198,6 +183,7 @@ void ass_2::ur5_unload(void)
     ROS_INFO("Completed area %d, %ld remaining", (int)areas[current_area_index][3], areas.size() - 1);
     areas.erase(areas.begin() + current_area_index);
     current_area_index = 0;
+    order_areas();
 
     if (areas.size() == 0)
         current_state = STATE_END;
@@ -1,23 +1,10 @@
 #include "main_controller/fsm.h"
 #include <string> 
 
-/* Services */
+/* Global state variables (defined into fsm_mission.cpp) */
 
-extern ros::ServiceClient detection_client;
-extern ros::ServiceClient gazebo_set_state;	
-extern ros::ServiceClient gazebo_get_state;	
-extern ros::ServiceClient vision_stop_client;
-extern ros::ServiceClient pointcloud_client;
-
-extern robotic_vision::Detect detection_srv;
-extern robotic_vision::Ping vision_stop_srv;
-extern robotic_vision::PointCloud pointcloud_srv;
-extern gazebo_msgs::GetModelState get_state_srv;
-extern gazebo_msgs::SetModelState set_state_srv;
-
-/* Global state variables (defined into fsm_utils.cpp) */
-
-extern State_t current_state;
+extern State_t current_state; // State of shelfino
+extern State_t ur5_state;
 extern std::vector<std::vector<double>> areas;
 
 extern geometry_msgs::Pose block_load_pos;
@@ -33,11 +20,51 @@ extern int choosen_block_class;
 
 extern std::vector<double> unload_pos_y;
 extern std::map<int, int> class_to_basket_map;
+extern Blackboard blackboard;
+
+static Handoff ur5_block; // Block handed over to UR5, owned by the state machine of UR5
+static int ur5_load_failures; // Failed attempts to grab the block handed over
+static const int max_load_failures = 3; // Then the block is left on shelfino and the mission goes on
+static const RoutePose shelfino_park_pose = {-0.2, -0.1, M_PI + 0.1}; // Where UR5 grabs the block on shelfino
+
+/**
+ * Position above a target of the UR5 (its z axis points down), where the straight final approach starts
+ */
+static ur5_controller::Coordinates approach_pos(const ur5_controller::Coordinates &pos)
+{
+    ur5_controller::Coordinates above = pos;
+    above.z -= 0.1;
+    return above;
+}
+
+/**
+ * The UR5 could not grab the block handed over: try again, or after max_load_failures attempts release shelfino
+ * without sorting the block and wait for the next one
+ *
+ * @param reason The reason of the failure
+ */
+static void ur5_load_failed(const char *reason)
+{
+    ROS_WARN("%s", reason);
+    if (++ur5_load_failures < max_load_failures)
+    {
+        fsm_sleep(1.0);
+        return;
+    }
+
+    // Out of the way of shelfino before releasing it
+    ROS_WARN("UR5 gave up on block %d after %d attempts, shelfino can leave", ur5_block.model, ur5_load_failures);
+    ur5_load_failures = 0;
+    ur5_move(ur5_home_pos, ur5_default_rot);
+    blackboard.block_taken();
+    ur5_state = STATE_UR5_WAIT_BLOCK;
+}
 
 void ass_3::init(void)
 {
     // Global FSM variables
     current_area_index = 0;
+    ur5_load_failures = 0;
     
     // Initial and park position
     ur5_home_pos.x = 0.1;
@@ -48,6 +75,7 @@ void ass_3::init(void)
     shelfino_current_pos.x = 0;
     shelfino_current_pos.y = 0;
     shelfino_current_rot = 0;
+    order_areas(&shelfino_park_pose);
     
     // Where to find baskets
     ur5_unload_pos.x = 0.42;
@@ -57,10 +85,8 @@ void ass_3::init(void)
     unload_pos_y.push_back(-0.18);
     unload_pos_y.push_back(-0.33);
 
-    // Move ur5 to home position
-    ur5_move(ur5_home_pos, ur5_default_rot);
-
     current_state = STATE_SHELFINO_ROTATE_AREA;
+    ur5_state = STATE_UR5_WAIT_BLOCK;
 }
 
 void ass_3::shelfino_rotate_towards_next_area(void)
@@ -115,15 +141,11 @@ void ass_3::shelfino_check_block(void)
         0
     );
 
-    ros::Duration(1.0).sleep();
-    detection_client.call(detection_srv);
-    if (detection_srv.response.status == 1 && detection_srv.response.box.probability > block_shelfino.probability)
-    {
-        block_shelfino = detection_srv.response.box;
-    }
+    fsm_sleep(1.0);
+    shelfino_classify();
     
     ROS_INFO("Object classified: %s, position: (%.2f, %.2f)", block_shelfino.Class.data(), block_pos.x, block_pos.y);
-    vision_stop_client.call(vision_stop_srv); // Blacklist this block
+    shelfino_blacklist(); // Blacklist this block
 
     // Check in which area shelfino is
     bool area_found = false;
@@ -152,55 +174,82 @@ void ass_3::shelfino_check_block(void)
 void ass_3::shelfino_park(void)
 {
     // gazebo move block on top of shelfino
-    get_state_srv.request.model_name = "shelfino";
-    gazebo_get_state.call(get_state_srv);
-
-    set_state_srv.request.model_state.pose = get_state_srv.response.pose;
-    set_state_srv.request.model_state.model_name = std::to_string((int)areas[current_area_index][3]);
-    set_state_srv.request.model_state.pose.position.x -= 0.1;
-    set_state_srv.request.model_state.pose.position.y += 0.1;
-    set_state_srv.request.model_state.pose.position.z = 0.9;
-    set_state_srv.request.model_state.pose.orientation.w = cos((shelfino_current_rot + M_PI / 2) / 2);
-    set_state_srv.request.model_state.pose.orientation.z = sin((shelfino_current_rot + M_PI / 2) / 2);
-    gazebo_set_state.call(set_state_srv);
-    ros::Duration(1.0).sleep();
+    geometry_msgs::Pose block_pose = gazebo_get_pose("shelfino");
+    block_pose.position.x -= 0.1;
+    block_pose.position.y += 0.1;
+    block_pose.position.z = 0.9;
+    block_pose.orientation.w = cos((shelfino_current_rot + M_PI / 2) / 2);
+    block_pose.orientation.z = sin((shelfino_current_rot + M_PI / 2) / 2);
+    gazebo_set_pose(std::to_string((int)areas[current_area_index][3]), block_pose);
+    fsm_sleep(1.0);
 
     attach((int)areas[current_area_index][3], false);
-    shelfino_move_to(-0.2, -0.1, M_PI + 0.1);
+    shelfino_move_to(shelfino_park_pose.x, shelfino_park_pose.y, shelfino_park_pose.yaw);
     detach((int)areas[current_area_index][3], false);
-    
-    current_state = STATE_UR5_LOAD;
+
+    // Wait until UR5 has grabbed and lifted the block, then shelfino can leave while UR5 sorts it
+    Handoff block;
+    block.model = (int)areas[current_area_index][3];
+    block.box = block_shelfino;
+    if (!blackboard.hand_over(block))
+    {
+        ROS_WARN("UR5 stopped before grabbing the block. Cannot proceed.");
+        current_state = STATE_END;
+        return;
+    }
+
+    // No need to order the remaining areas again: from the park pose every order takes the same time
+    areas.erase(areas.begin() + current_area_index);
+    current_area_index = 0;
+    ROS_INFO("Handed over block %d, %ld areas remaining", block.model, areas.size());
+
+    if (areas.size() == 0)
+        current_state = STATE_END;
+    else
+        current_state = STATE_SHELFINO_ROTATE_AREA;
+}
+
+void ass_3::ur5_wait_block(void)
+{
+    // Out of the view of the camera and of the way of shelfino
+    ur5_move(ur5_home_pos, ur5_default_rot);
+
+    if (!blackboard.wait_block(ur5_block))
+    {
+        ur5_state = STATE_END;
+        return;
+    }
+
+    ur5_state = STATE_UR5_LOAD;
 }
 
 void ass_3::ur5_load(void)
 {
     // Move ur5 to load position
-    pointcloud_client.call(pointcloud_srv);
-    if (pointcloud_srv.response.box.class_n != -1)
+    double block_x, block_y;
+    if (ur5_detect(block_x, block_y))
     {
-        ur5_load_pos.x = pointcloud_srv.response.wx - 0.5;
-        ur5_load_pos.y = 0.35 - pointcloud_srv.response.wy;
+        ur5_load_pos.x = block_x - 0.5;
+        ur5_load_pos.y = 0.35 - block_y;
         ur5_load_pos.z = 0.8;
-        block_ur5 = pointcloud_srv.response.box;
         ROS_DEBUG("Response from pointcloud: %f %f %f", ur5_load_pos.x, ur5_load_pos.y, ur5_load_pos.z);
     }
     else
     {
-        ROS_WARN("UR5 could not find object. Cannot proceed.");
-        ros::Duration(1.0).sleep();
+        ur5_load_failed("UR5 could not find object. Cannot proceed.");
         return;
     }
 
     ROS_INFO("UR5 classified the object: %s", block_ur5.Class.data());
     
     // If the two cameras classified differently
-    choosen_block_class = block_shelfino.class_n;
-    if (block_shelfino.class_n != block_ur5.class_n)
+    choosen_block_class = ur5_block.box.class_n;
+    if (ur5_block.box.class_n != block_ur5.class_n)
     {
-        if (block_shelfino.probability >= block_ur5.probability)
+        if (ur5_block.box.probability >= block_ur5.probability)
         {
-            ROS_INFO("Classification from Shelfino was more accurate, using class: %s", block_shelfino.Class.data());
-            choosen_block_class = block_shelfino.class_n;
+            ROS_INFO("Classification from Shelfino was more accurate, using class: %s", ur5_block.box.Class.data());
+            choosen_block_class = ur5_block.box.class_n;
         }
         else
         {
@@ -217,53 +266,72 @@ void ass_3::ur5_load(void)
         // Else, an object of the same class has already been classified: put it in the same basket
     }
 
-    // Move ur5 to home position
-    ur5_move(ur5_home_pos, ur5_default_rot);
+    // Do not plan towards an object out of reach
+    if (ur5_reachability(ur5_load_pos, ur5_default_rot) == 0)
+    {
+        ur5_load_failed("UR5 cannot reach the object.");
+        return;
+    }
+
+    // Open gripper
     ur5_grip(100);
 
-    // Move UR5 to load position
-    if (!ur5_move(ur5_load_pos, ur5_default_rot))
+    // Move UR5 above the load position passing over home position, without stopping
+    std::vector<ur5_controller::Coordinates> waypoints = {ur5_home_pos, approach_pos(ur5_load_pos)};
+    if (!ur5_move_through(waypoints, ur5_default_rot))
     {
         // If UR5 cannot find a path, try an intermediate position
         ur5_controller::Coordinates intermediate_pos;
         intermediate_pos.x = -0.1;
         intermediate_pos.y = -0.4;
         intermediate_pos.z = 0.55;
-        ur5_move(intermediate_pos, ur5_default_rot);
+        waypoints.insert(waypoints.begin() + 1, intermediate_pos);
 
-        if (!ur5_move(ur5_load_pos, ur5_default_rot))
+        if (ur5_reachability(intermediate_pos, ur5_default_rot) == 0 || !ur5_move_through(waypoints, ur5_default_rot))
         {
-            ROS_WARN("UR5 cannot move to the specified area.");
-            ros::Duration(1.0).sleep();
+            ur5_load_failed("UR5 cannot move to the specified area.");
             return;
         } 
     }
 
-    // Grab
+    // Straight final approach, in the joints space if the line is not valid
+    if (!ur5_move(ur5_load_pos, ur5_default_rot, true) && !ur5_move(ur5_load_pos, ur5_default_rot))
+    {
+        ur5_load_failed("UR5 cannot approach the object.");
+        return;
+    }
+
+    // Grab, shelfino leaves once the block is lifted
     ur5_grip(31);
-    attach((int)areas[current_area_index][3], true);
+    attach(ur5_block.model, true);
+    ur5_load_failures = 0;
 
-    current_state = STATE_UR5_UNLOAD;
+    ur5_state = STATE_UR5_UNLOAD;
 }
 
 void ass_3::ur5_unload(void)
 {
-    // Move ur5 to home position
-    ur5_move(ur5_home_pos, ur5_default_rot);
-    // Move ur5 to unload position
+    // Lift the block clear of shelfino, then shelfino can leave while UR5 sorts it
+    ur5_controller::Coordinates lift_pos = approach_pos(ur5_load_pos);
+    if (!ur5_move(lift_pos, ur5_default_rot, true))
+        ur5_move(lift_pos, ur5_default_rot);
+    blackboard.block_taken();
+
+    // Move ur5 above the unload position passing over home position, without stopping
     ur5_unload_pos.y = unload_pos_y[class_to_basket_map[choosen_block_class]];
-    ur5_move(ur5_unload_pos, ur5_default_rot);
+    std::vector<ur5_controller::Coordinates> waypoints = {ur5_home_pos, approach_pos(ur5_unload_pos)};
+    ur5_move_through(waypoints, ur5_default_rot);
+
+    // Straight final approach, in the joints space if the line is not valid
+    if (!ur5_move(ur5_unload_pos, ur5_default_rot, true))
+        ur5_move(ur5_unload_pos, ur5_default_rot);
 
     // Open gripper
-    detach((int)areas[current_area_index][3], true);
+    detach(ur5_block.model, true);
     ur5_grip(100);
 
-    ROS_INFO("Completed area %d, %ld remaining", (int)areas[current_area_index][3], areas.size() - 1);
-    areas.erase(areas.begin() + current_area_index);
-    current_area_index = 0;
+    blackboard.block_sorted();
+    ROS_INFO("Completed area %d", ur5_block.model);
 
-    if (areas.size() == 0)
-        current_state = STATE_END;
-    else
-        current_state = STATE_SHELFINO_ROTATE_AREA;
+    ur5_state = STATE_UR5_WAIT_BLOCK;
 }
\ No newline at end of file
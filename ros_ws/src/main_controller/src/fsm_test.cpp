@@ -1,15 +1,7 @@
 #include "main_controller/fsm.h"
 #include <string> 
 
-/* Services */
-
-extern ros::ServiceClient detection_client;
-extern ros::ServiceClient vision_stop_client;
-
-extern robotic_vision::Detect detection_srv;
-extern robotic_vision::Ping vision_stop_srv;
-
-/* Global state variables (defined into fsm_utils.cpp) */
+/* Global state variables (defined into fsm_mission.cpp) */
 
 extern State_t current_state;
 extern std::vector<std::vector<double>> areas;
@@ -65,7 +57,7 @@ void state_test(void)
     ur5_move(ur5_load_pos, ur5_default_rot);
     // Grab
     ur5_grip(31);
-    ros::Duration(1.0).sleep();
+    fsm_sleep(1.0);
 
     //////////
     // UNLOAD
@@ -77,7 +69,7 @@ void state_test(void)
     ur5_move(ur5_unload_pos, ur5_default_rot);
     // Open gripper
     ur5_grip(100);
-    ros::Duration(1.0).sleep();
+    fsm_sleep(1.0);
 
     if (cont == 4)
     {
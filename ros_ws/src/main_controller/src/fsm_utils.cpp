@@ -1,25 +1,33 @@
 #include "main_controller/fsm.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
 
 /* Global Service Clients */
 
-ros::ServiceClient shelfino_move_client, shelfino_point_client,
-    shelfino_rotate_client, shelfino_forward_client, 
+ros::ServiceClient shelfino_point_client,
     gazebo_link_attacher, gazebo_link_detacher,
-    ur5_move_client, ur5_gripper_client,
+    ur5_move_through_client, ur5_gripper_client,
+    ur5_reachable_client,
     vision_stop_client, pointcloud_client,
     detection_client, gazebo_set_state,
     gazebo_get_state;
 
+/* Global Action Clients */
+
+std::unique_ptr<actionlib::SimpleActionClient<ur5_controller::MoveToAction>> ur5_move_action;
+std::unique_ptr<actionlib::SimpleActionClient<shelfino_controller::MoveToAction>> shelfino_move_action;
+std::unique_ptr<actionlib::SimpleActionClient<shelfino_controller::RotateAction>> shelfino_rotate_action;
+std::unique_ptr<actionlib::SimpleActionClient<shelfino_controller::MoveForwardAction>> shelfino_forward_action;
+
 /* Global Shelfino SRV Variables */
 
-shelfino_controller::MoveTo shelfino_move_srv;
-shelfino_controller::Rotate shelfino_rotate_srv;
 shelfino_controller::PointTo shelfino_point_srv;
-shelfino_controller::MoveForward shelfino_forward_srv;
 
 /* Global UR5 SRV Variables */
 
-ur5_controller::MoveTo ur5_move_srv;
+ur5_controller::MoveThrough ur5_move_through_srv;
+ur5_controller::CheckReachable ur5_reachable_srv;
 ur5_controller::SetGripper ur5_gripper_srv;
 
 /* Global vision SRV Variables */
@@ -33,53 +41,153 @@ robotic_vision::PointCloud pointcloud_srv;
 gazebo_msgs::GetModelState get_state_srv;
 gazebo_msgs::SetModelState set_state_srv;
 gazebo_ros_link_attacher::Attach link_attacher_srv;
+std::mutex link_attacher_mutex; // The state machines of shelfino and UR5 attach and detach at the same time
 
-/* State global variables */
-
-shelfino_controller::Coordinates shelfino_current_pos, block_pos;
-ur5_controller::Coordinates ur5_home_pos, ur5_load_pos, ur5_unload_pos;
-ur5_controller::EulerRotation ur5_default_rot;
-geometry_msgs::Pose block_load_pos;
-double shelfino_current_rot; // Shelfino current rotation angle
-int current_area_index; // Index of the current area in the areas array (different to area number)
-robotic_vision::BoundingBox block_shelfino; // Block detected and classified by shelfino
-robotic_vision::BoundingBox block_ur5; // Block detected and classified by ur5
-double block_angle; // If the block is not centered in front of shelfino
-int choosen_block_class; // Class of the detected block choosen after classification from shelfino and ur5
-
-std::vector<double> unload_pos_y;
-std::map<int, int> class_to_basket_map;
 bool real_robot;
 
-void shelfino_move_to(double x, double y, double yaw)
+/* Longest wait for the outcome of a movement [s], the longest one is the full rotation of shelfino */
+const int motion_timeout = 120;
+
+/* Global state variables (defined into fsm_mission.cpp) */
+
+extern shelfino_controller::Coordinates shelfino_current_pos, block_pos;
+extern double shelfino_current_rot;
+extern robotic_vision::BoundingBox block_shelfino;
+extern robotic_vision::BoundingBox block_ur5;
+extern double block_angle;
+
+void setup_action_clients(void)
+{
+    // The clients spin their own callback queue, the futures become ready while the FSM waits on them
+    ur5_move_action.reset(new actionlib::SimpleActionClient<ur5_controller::MoveToAction>("ur5/move_to_action", true));
+    shelfino_move_action.reset(new actionlib::SimpleActionClient<shelfino_controller::MoveToAction>("shelfino/move_to_action", true));
+    shelfino_rotate_action.reset(new actionlib::SimpleActionClient<shelfino_controller::RotateAction>("shelfino/rotate_action", true));
+    shelfino_forward_action.reset(new actionlib::SimpleActionClient<shelfino_controller::MoveForwardAction>("shelfino/move_forward_action", true));
+
+    ur5_move_action->waitForServer();
+    shelfino_move_action->waitForServer();
+    shelfino_rotate_action->waitForServer();
+    shelfino_forward_action->waitForServer();
+}
+
+MotionFuture ur5_move_async(const ur5_controller::Coordinates& pos, const ur5_controller::EulerRotation& rot, bool linear)
 {
-    shelfino_move_srv.request.pos.x = x;
-    shelfino_move_srv.request.pos.y = y;
-    shelfino_move_srv.request.rot = yaw;
+    ur5_controller::MoveToGoal goal;
+    goal.pos = pos;
+    goal.rot = rot;
+    goal.linear = linear;
 
-    shelfino_move_client.call(shelfino_move_srv);
+    std::shared_ptr<std::promise<bool>> done = std::make_shared<std::promise<bool>>();
+    ur5_move_action->sendGoal(goal, [done](const actionlib::SimpleClientGoalState &state, const ur5_controller::MoveToResultConstPtr &result)
+    {
+        done->set_value(state == actionlib::SimpleClientGoalState::SUCCEEDED && result && result->status);
+    });
+    return done->get_future().share();
+}
+
+MotionFuture shelfino_move_to_async(double x, double y, double yaw)
+{
+    shelfino_controller::MoveToGoal goal;
+    goal.pos.x = x;
+    goal.pos.y = y;
+    goal.rot = yaw;
 
-    shelfino_current_pos.x = x;
-    shelfino_current_pos.y = y;
-    shelfino_current_rot = shelfino_move_srv.response.rot;
+    std::shared_ptr<std::promise<bool>> done = std::make_shared<std::promise<bool>>();
+    shelfino_move_action->sendGoal(goal, [done, x, y](const actionlib::SimpleClientGoalState &state, const shelfino_controller::MoveToResultConstPtr &result)
+    {
+        if (result)
+        {
+            shelfino_current_pos.x = x;
+            shelfino_current_pos.y = y;
+            shelfino_current_rot = result->rot;
+        }
+        done->set_value(state == actionlib::SimpleClientGoalState::SUCCEEDED);
+    });
+    return done->get_future().share();
 }
 
-void shelfino_forward(double distance, bool control)
+MotionFuture shelfino_forward_async(double distance, bool control)
+{
+    shelfino_controller::MoveForwardGoal goal;
+    goal.distance = distance - 0.15;
+    goal.control = control;
+
+    std::shared_ptr<std::promise<bool>> done = std::make_shared<std::promise<bool>>();
+    shelfino_forward_action->sendGoal(goal, [done](const actionlib::SimpleClientGoalState &state, const shelfino_controller::MoveForwardResultConstPtr &result)
+    {
+        if (result)
+        {
+            shelfino_current_pos.x = result->pos.x;
+            shelfino_current_pos.y = result->pos.y;
+        }
+        done->set_value(state == actionlib::SimpleClientGoalState::SUCCEEDED);
+    });
+    return done->get_future().share();
+}
+
+MotionFuture shelfino_rotate_async(double angle)
+{
+    shelfino_controller::RotateGoal goal;
+    goal.angle = angle;
+
+    std::shared_ptr<std::promise<bool>> done = std::make_shared<std::promise<bool>>();
+    shelfino_rotate_action->sendGoal(goal, [done](const actionlib::SimpleClientGoalState &state, const shelfino_controller::RotateResultConstPtr &result)
+    {
+        if (result)
+            shelfino_current_rot = result->rot;
+        done->set_value(state == actionlib::SimpleClientGoalState::SUCCEEDED);
+    });
+    return done->get_future().share();
+}
+
+void ur5_cancel(void)
+{
+    ur5_move_action->cancelGoal();
+}
+
+void shelfino_cancel(void)
 {
-    shelfino_forward_srv.request.distance = distance - 0.15;
-    shelfino_forward_srv.request.control = control;
+    shelfino_move_action->cancelGoal();
+    shelfino_rotate_action->cancelGoal();
+    shelfino_forward_action->cancelGoal();
+}
 
-    shelfino_forward_client.call(shelfino_forward_srv);
+/**
+ * Wait for the outcome of a movement while ROS is running. If the action server does not complete the goal
+ * within motion_timeout (e.g. it died) or the node is shutting down the goal is preempted
+ * 
+ * @param done The outcome of the movement
+ * @param cancel The function that preempts the movement
+ * @return true if the movement was completed
+ */
+static bool wait_motion(const MotionFuture& done, void (*cancel)(void))
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(motion_timeout);
+    while (done.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+    {
+        if (!ros::ok() || std::chrono::steady_clock::now() > deadline)
+        {
+            ROS_WARN("Movement %s, preempting the goal", ros::ok() ? "timed out" : "interrupted by the shutdown");
+            cancel();
+            return false;
+        }
+    }
+    return done.get();
+}
 
-    shelfino_current_pos.x = shelfino_forward_srv.response.pos.x;
-    shelfino_current_pos.y = shelfino_forward_srv.response.pos.y;
+void shelfino_move_to(double x, double y, double yaw)
+{
+    wait_motion(shelfino_move_to_async(x, y, yaw), shelfino_cancel);
+}
+
+void shelfino_forward(double distance, bool control)
+{
+    wait_motion(shelfino_forward_async(distance, control), shelfino_cancel);
 }
 
 void shelfino_rotate(double angle)
 {
-    shelfino_rotate_srv.request.angle = angle;
-    shelfino_rotate_client.call(shelfino_rotate_srv);
-    shelfino_current_rot = shelfino_rotate_srv.response.rot;
+    wait_motion(shelfino_rotate_async(angle), shelfino_cancel);
 }
 
 void shelfino_point_to(double x, double y)
@@ -112,13 +220,29 @@ bool shelfino_detect(void)
     return true;
 }
 
-bool ur5_move(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot)
+bool ur5_move(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot, bool linear)
+{
+    return wait_motion(ur5_move_async(pos, rot, linear), ur5_cancel);
+}
+
+bool ur5_move_through(std::vector<ur5_controller::Coordinates>& pos, ur5_controller::EulerRotation& rot)
+{
+    ur5_move_through_srv.request.pos = pos;
+    ur5_move_through_srv.request.rot.assign(pos.size(), rot);
+    ur5_move_through_srv.request.tolerance = 0;
+    ur5_move_through_client.call(ur5_move_through_srv);
+
+    return ur5_move_through_srv.response.status;
+}
+
+int ur5_reachability(ur5_controller::Coordinates& pos, ur5_controller::EulerRotation& rot)
 {
-    ur5_move_srv.request.pos = pos;
-    ur5_move_srv.request.rot = rot;
-    ur5_move_client.call(ur5_move_srv);
+    ur5_reachable_srv.request.pos = pos;
+    ur5_reachable_srv.request.rot = rot;
+    if (!ur5_reachable_client.call(ur5_reachable_srv))
+        return -1;
 
-    return ur5_move_srv.response.status;
+    return ur5_reachable_srv.response.status;
 }
 
 void ur5_grip(double diameter)
@@ -127,8 +251,54 @@ void ur5_grip(double diameter)
     ur5_gripper_client.call(ur5_gripper_srv);
 }
 
+void shelfino_classify(void)
+{
+    detection_client.call(detection_srv);
+    if (detection_srv.response.status == 1 && detection_srv.response.box.probability > block_shelfino.probability)
+    {
+        block_shelfino = detection_srv.response.box;
+    }
+}
+
+void shelfino_blacklist(void)
+{
+    vision_stop_client.call(vision_stop_srv);
+}
+
+bool ur5_detect(double &x, double &y)
+{
+    pointcloud_client.call(pointcloud_srv);
+    if (pointcloud_srv.response.box.class_n == -1)
+        return false;
+
+    x = pointcloud_srv.response.wx;
+    y = pointcloud_srv.response.wy;
+    block_ur5 = pointcloud_srv.response.box;
+    return true;
+}
+
+geometry_msgs::Pose gazebo_get_pose(const std::string &model)
+{
+    get_state_srv.request.model_name = model;
+    gazebo_get_state.call(get_state_srv);
+    return get_state_srv.response.pose;
+}
+
+void gazebo_set_pose(const std::string &model, const geometry_msgs::Pose &pose)
+{
+    set_state_srv.request.model_state.model_name = model;
+    set_state_srv.request.model_state.pose = pose;
+    gazebo_set_state.call(set_state_srv);
+}
+
+void fsm_sleep(double seconds)
+{
+    ros::Duration(seconds).sleep();
+}
+
 void attach(int model, bool gripper)
 {
+    std::lock_guard<std::mutex> lock(link_attacher_mutex);
     if (gripper)
     {
         link_attacher_srv.request.model_name_1 = "ur5";
@@ -146,6 +316,7 @@ void attach(int model, bool gripper)
 
 void detach(int model, bool gripper)
 {
+    std::lock_guard<std::mutex> lock(link_attacher_mutex);
     if (gripper)
     {
         link_attacher_srv.request.model_name_1 = "ur5";
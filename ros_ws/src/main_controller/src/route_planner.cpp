@@ -0,0 +1,317 @@
+#include "main_controller/route_planner.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+/* Number of nearest neighbour orders improved by the heuristic, each one from a different first area */
+static const int heuristic_starts = 8;
+
+/**
+ * @return The angle in [-pi, pi]
+ */
+static double wrap_angle(double angle)
+{
+    return atan2(sin(angle), cos(angle));
+}
+
+/* Public functions */
+
+RoutePlanner::RoutePlanner(double linear_velocity, double angular_velocity, int exact_limit)
+{
+    this->linear_velocity = linear_velocity;
+    this->angular_velocity = angular_velocity;
+    this->exact_limit = exact_limit;
+    return_to_park = false;
+    park = {0, 0, 0};
+}
+
+void RoutePlanner::set_park(const RoutePose &pose)
+{
+    park = pose;
+    return_to_park = true;
+}
+
+void RoutePlanner::clear_park(void)
+{
+    return_to_park = false;
+}
+
+double RoutePlanner::route_time(const RoutePose &start, const std::vector<std::vector<double>> &areas, const std::vector<int> &order) const
+{
+    RoutePose pose = start;
+    double time = 0;
+    for (int i : order)
+        time += visit_time(pose, areas[i][0], areas[i][1], pose);
+    return time;
+}
+
+std::vector<int> RoutePlanner::plan(const RoutePose &start, const std::vector<std::vector<double>> &areas) const
+{
+    if (return_to_park)
+        return plan_park(start, areas);
+    if (areas.size() <= (size_t)std::max(exact_limit, 1))
+        return plan_exact(start, areas);
+    return plan_heuristic(start, areas);
+}
+
+/* Private functions */
+
+double RoutePlanner::visit_time(const RoutePose &from, double x, double y, RoutePose &to) const
+{
+    // Rotate towards the point, then run straight
+    double distance = hypot(x - from.x, y - from.y);
+    double heading = distance > 1e-9 ? atan2(y - from.y, x - from.x) : from.yaw;
+    double time = fabs(wrap_angle(heading - from.yaw)) / angular_velocity + distance / linear_velocity;
+    to = {x, y, heading};
+
+    if (return_to_park)
+    {
+        distance = hypot(park.x - x, park.y - y);
+        double back_heading = distance > 1e-9 ? atan2(park.y - y, park.x - x) : heading;
+        time += fabs(wrap_angle(back_heading - heading)) / angular_velocity + distance / linear_velocity;
+        time += fabs(wrap_angle(park.yaw - back_heading)) / angular_velocity;
+        to = park;
+    }
+
+    return time;
+}
+
+std::vector<int> RoutePlanner::plan_park(const RoutePose &start, const std::vector<std::vector<double>> &areas) const
+{
+    // Every area but the first one is a round trip from the park pose: only the first area changes the time
+    const int n = areas.size();
+    int first = 0;
+    double best_saving = -std::numeric_limits<double>::infinity();
+    for (int j = 0; j < n; j++)
+    {
+        RoutePose pose;
+        double saving = visit_time(park, areas[j][0], areas[j][1], pose) - visit_time(start, areas[j][0], areas[j][1], pose);
+        if (saving > best_saving + 1e-9)
+        {
+            best_saving = saving;
+            first = j;
+        }
+    }
+
+    std::vector<int> order(1, first);
+    for (int j = 0; j < n; j++)
+    {
+        if (j != first)
+            order.push_back(j);
+    }
+    return order;
+}
+
+std::vector<int> RoutePlanner::plan_exact(const RoutePose &start, const std::vector<std::vector<double>> &areas) const
+{
+    // State: visited areas, last area and the last one before it with a different center (n for the start pose),
+    // which gives the heading in the last area: shelfino does not rotate between areas with the same center
+    const int n = areas.size();
+    if (n == 0)
+        return std::vector<int>();
+
+    const int n_prev = n + 1;
+    const size_t n_states = ((size_t)1 << n) * n * n_prev;
+    auto index = [n, n_prev](unsigned mask, int last, int prev) { return ((size_t)mask * n + last) * n_prev + prev; };
+    auto same_center = [&areas](int i, int j) { return hypot(areas[i][0] - areas[j][0], areas[i][1] - areas[j][1]) <= 1e-9; };
+
+    std::vector<double> time(n_states, std::numeric_limits<double>::infinity());
+    std::vector<RoutePose> pose(n_states);
+    std::vector<size_t> parent(n_states, n_states); // The state before, n_states for the start pose
+
+    for (int j = 0; j < n; j++)
+    {
+        size_t s = index(1u << j, j, n);
+        time[s] = visit_time(start, areas[j][0], areas[j][1], pose[s]);
+    }
+
+    for (unsigned mask = 1; mask < (1u << n); mask++)
+    {
+        for (int last = 0; last < n; last++)
+        {
+            if (!(mask & (1u << last)))
+                continue;
+
+            for (int prev = 0; prev <= n; prev++)
+            {
+                size_t s = index(mask, last, prev);
+                if (time[s] == std::numeric_limits<double>::infinity())
+                    continue;
+
+                for (int j = 0; j < n; j++)
+                {
+                    if (mask & (1u << j))
+                        continue;
+
+                    RoutePose next_pose;
+                    double next_time = time[s] + visit_time(pose[s], areas[j][0], areas[j][1], next_pose);
+                    size_t next = index(mask | (1u << j), j, same_center(last, j) ? prev : last);
+                    if (next_time < time[next])
+                    {
+                        time[next] = next_time;
+                        pose[next] = next_pose;
+                        parent[next] = s;
+                    }
+                }
+            }
+        }
+    }
+
+    // Best complete route, then follow the parents backwards
+    const unsigned mask = (1u << n) - 1;
+    size_t best = index(mask, 0, n);
+    for (int last = 0; last < n; last++)
+    {
+        for (int prev = 0; prev <= n; prev++)
+        {
+            if (time[index(mask, last, prev)] < time[best])
+                best = index(mask, last, prev);
+        }
+    }
+
+    std::vector<int> order;
+    for (size_t s = best; s != n_states; s = parent[s])
+        order.push_back((s / n_prev) % n);
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+double RoutePlanner::improve(const RoutePose &start, const std::vector<std::vector<double>> &areas, std::vector<int> &order) const
+{
+    // Time and pose before each area of the order: a move that changes the order from i on only re-times the suffix
+    const int n = order.size();
+    std::vector<double> prefix_time(n + 1);
+    std::vector<RoutePose> prefix_pose(n + 1);
+    auto update_prefix = [&](int from)
+    {
+        for (int k = from; k < n; k++)
+            prefix_time[k + 1] = prefix_time[k] + visit_time(prefix_pose[k], areas[order[k]][0], areas[order[k]][1], prefix_pose[k + 1]);
+    };
+    prefix_time[0] = 0;
+    prefix_pose[0] = start;
+    update_prefix(0);
+
+    // Time of the candidate, or infinity as soon as it cannot improve the route
+    std::vector<int> candidate(n);
+    auto candidate_time = [&](int from)
+    {
+        RoutePose pose = prefix_pose[from];
+        double time = prefix_time[from];
+        for (int k = from; k < n && time < prefix_time[n] - 1e-9; k++)
+            time += visit_time(pose, areas[candidate[k]][0], areas[candidate[k]][1], pose);
+        return time < prefix_time[n] - 1e-9 ? time : std::numeric_limits<double>::infinity();
+    };
+    auto accept = [&](int from)
+    {
+        order.swap(candidate);
+        update_prefix(from);
+    };
+
+    // 2-opt (reverse a segment) and Or-opt (move a segment of up to three areas, also reversed) until no move improves the route
+    bool improved = true;
+    while (improved)
+    {
+        improved = false;
+
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int k = i + 1; k < n; k++)
+            {
+                candidate = order;
+                std::reverse(candidate.begin() + i, candidate.begin() + k + 1);
+                if (candidate_time(i) < std::numeric_limits<double>::infinity())
+                {
+                    accept(i);
+                    improved = true;
+                }
+            }
+        }
+
+        for (int length = 1; length <= 3 && length < n; length++)
+        {
+            for (int i = 0; i + length <= n; i++)
+            {
+                for (int p = 0; p <= n - length; p++)
+                {
+                    for (int reversed = 0; reversed <= (length > 1 ? 1 : 0); reversed++)
+                    {
+                        if (p == i && !reversed)
+                            continue;
+
+                        std::vector<int> segment(order.begin() + i, order.begin() + i + length);
+                        if (reversed)
+                            std::reverse(segment.begin(), segment.end());
+                        candidate.assign(order.begin(), order.begin() + i);
+                        candidate.insert(candidate.end(), order.begin() + i + length, order.end());
+                        candidate.insert(candidate.begin() + p, segment.begin(), segment.end());
+                        if (candidate_time(std::min(i, p)) < std::numeric_limits<double>::infinity())
+                        {
+                            accept(std::min(i, p));
+                            improved = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return prefix_time[n];
+}
+
+std::vector<int> RoutePlanner::plan_heuristic(const RoutePose &start, const std::vector<std::vector<double>> &areas) const
+{
+    // Nearest neighbour orders (by time) starting from the heuristic_starts areas nearest to the start pose,
+    // each one improved by local search: the best local optimum is kept
+    const int n = areas.size();
+    std::vector<std::pair<double, int>> firsts;
+    for (int j = 0; j < n; j++)
+    {
+        RoutePose pose;
+        firsts.push_back(std::make_pair(visit_time(start, areas[j][0], areas[j][1], pose), j));
+    }
+    std::sort(firsts.begin(), firsts.end());
+    firsts.resize(std::min(n, heuristic_starts));
+
+    std::vector<int> best_order;
+    double best_time = std::numeric_limits<double>::infinity();
+    for (const std::pair<double, int> &first : firsts)
+    {
+        std::vector<int> order(1, first.second);
+        std::vector<bool> visited(n, false);
+        visited[first.second] = true;
+        RoutePose pose;
+        visit_time(start, areas[first.second][0], areas[first.second][1], pose);
+
+        while ((int)order.size() < n)
+        {
+            int nearest = -1;
+            double nearest_time = std::numeric_limits<double>::infinity();
+            RoutePose nearest_pose;
+            for (int j = 0; j < n; j++)
+            {
+                RoutePose next_pose;
+                double t = visited[j] ? nearest_time : visit_time(pose, areas[j][0], areas[j][1], next_pose);
+                if (t < nearest_time)
+                {
+                    nearest = j;
+                    nearest_time = t;
+                    nearest_pose = next_pose;
+                }
+            }
+            visited[nearest] = true;
+            order.push_back(nearest);
+            pose = nearest_pose;
+        }
+
+        double time = improve(start, areas, order);
+        if (time < best_time - 1e-9)
+        {
+            best_order.swap(order);
+            best_time = time;
+        }
+    }
+
+    return best_order;
+}
\ No newline at end of file
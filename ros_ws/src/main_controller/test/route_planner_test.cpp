@@ -0,0 +1,138 @@
+/**
+* @file route_planner_test.cpp
+* @brief Unit tests of the route planner: the orders are compared with the brute force over all the permutations
+*
+* @date 17/10/2026
+*/
+
+#include "main_controller/route_planner.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+static const RoutePose park_pose = {-0.2, -0.1, M_PI + 0.1};
+
+/**
+ * Random areas in a 6x6 m floor, the center of every other area coincides with the previous one if coincident is set
+ */
+static std::vector<std::vector<double>> random_areas(std::mt19937 &generator, int n, bool coincident)
+{
+    std::uniform_real_distribution<double> coordinate(-3, 3);
+    std::vector<std::vector<double>> areas;
+    for (int i = 0; i < n; i++)
+    {
+        double x = coordinate(generator), y = coordinate(generator);
+        if (coincident && i % 2 == 1)
+        {
+            x = areas[i - 1][0];
+            y = areas[i - 1][1];
+        }
+        areas.push_back({x, y, 0.5, (double)i});
+    }
+    return areas;
+}
+
+static RoutePose random_pose(std::mt19937 &generator)
+{
+    std::uniform_real_distribution<double> coordinate(-3, 3), angle(-M_PI, M_PI);
+    return {coordinate(generator), coordinate(generator), angle(generator)};
+}
+
+static double brute_force_time(const RoutePlanner &planner, const RoutePose &start, const std::vector<std::vector<double>> &areas)
+{
+    std::vector<int> order(areas.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    double best = std::numeric_limits<double>::infinity();
+    do
+        best = std::min(best, planner.route_time(start, areas, order));
+    while (std::next_permutation(order.begin(), order.end()));
+    return best;
+}
+
+static bool is_permutation_of_areas(std::vector<int> order, size_t n)
+{
+    std::sort(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        if (order[i] != (int)i)
+            return false;
+    }
+    return order.size() == n;
+}
+
+TEST(RoutePlanner, NoAreas)
+{
+    RoutePlanner planner(0.2, 0.2);
+    EXPECT_TRUE(planner.plan({0, 0, 0}, {}).empty());
+}
+
+TEST(RoutePlanner, ExactMatchesBruteForce)
+{
+    std::mt19937 generator(1);
+    for (int test = 0; test < 400; test++)
+    {
+        int n = 1 + test % 8;
+        std::vector<std::vector<double>> areas = random_areas(generator, n, test % 2 == 1);
+        RoutePose start = random_pose(generator);
+        RoutePlanner planner(0.2, 0.2);
+
+        std::vector<int> order = planner.plan(start, areas);
+        ASSERT_TRUE(is_permutation_of_areas(order, n));
+        EXPECT_NEAR(planner.route_time(start, areas, order), brute_force_time(planner, start, areas), 1e-9) << "test " << test;
+    }
+}
+
+TEST(RoutePlanner, ParkMatchesBruteForce)
+{
+    std::mt19937 generator(2);
+    for (int test = 0; test < 200; test++)
+    {
+        int n = 1 + test % 7;
+        std::vector<std::vector<double>> areas = random_areas(generator, n, test % 2 == 1);
+        RoutePose start = test % 3 == 0 ? park_pose : random_pose(generator);
+        RoutePlanner planner(0.2, 0.2);
+        planner.set_park(park_pose);
+
+        std::vector<int> order = planner.plan(start, areas);
+        ASSERT_TRUE(is_permutation_of_areas(order, n));
+        EXPECT_NEAR(planner.route_time(start, areas, order), brute_force_time(planner, start, areas), 1e-9) << "test " << test;
+    }
+}
+
+TEST(RoutePlanner, HeuristicCloseToOptimum)
+{
+    // Measured on 4400 maps: optimal in 99% of the cases, 0.03% slower on average, 13% in the worst case
+    std::mt19937 generator(3);
+    const int tests = 200;
+    double gap_sum = 0;
+    int optimal = 0;
+    for (int test = 0; test < tests; test++)
+    {
+        int n = 5 + test % 3;
+        std::vector<std::vector<double>> areas = random_areas(generator, n, false);
+        RoutePose start = random_pose(generator);
+        RoutePlanner heuristic(0.2, 0.2, 0);
+
+        std::vector<int> order = heuristic.plan(start, areas);
+        ASSERT_TRUE(is_permutation_of_areas(order, n));
+        double best = brute_force_time(heuristic, start, areas);
+        double gap = heuristic.route_time(start, areas, order) / best - 1;
+        EXPECT_GE(gap, -1e-9);
+        EXPECT_LT(gap, 0.15) << "test " << test;
+        gap_sum += gap;
+        optimal += gap < 1e-9;
+    }
+
+    EXPECT_LT(gap_sum / tests, 0.002);
+    EXPECT_GE(optimal, tests * 95 / 100);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
\ No newline at end of file
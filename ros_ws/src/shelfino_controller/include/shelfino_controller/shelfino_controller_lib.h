@@ -18,6 +18,18 @@
 #include "robotic_vision/BoundingBoxes.h"
 #include <Eigen/Dense>
 #include <math.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+/**
+ * Feedback of a movement, called from the thread of the movement a few times per second
+ *
+ * @param position The estimated position of Shelfino
+ * @param rotation The estimated rotation of Shelfino
+ * @param progress Fraction of the current rotation or straight movement completed, from 0 to 1
+ */
+typedef std::function<void(const Coordinates &position, double rotation, double progress)> ShelfinoFeedbackFunction;
 
 /**
  * @brief The Shelfino Controller class implements the high level functions for the movement and control of Shelfino
@@ -42,8 +54,12 @@ private:
     Coordinates odometry_position, odometry_position_0;
     double odometry_rotation, odometry_rotation_0;
 
-    bool block_detected;
-    bool disable_vision;
+    std::atomic<bool> block_detected; // set by the detection callback, may run in another thread than the movement
+    std::atomic<bool> disable_vision;
+
+    std::mutex odometry_mutex; // the odometry callback may run in another thread than the movement
+    std::recursive_mutex motion_mutex; // one movement at a time, move_to is made of rotations and straight movements
+    int feedback_decimation = 5; // control cycles between two feedback calls
 
     /**
      * Callback function, listen to /shelfino/odom topic and update odometry position and rotation
@@ -96,9 +112,12 @@ public:
      * 
      * @param pos The desired final position
      * @param yaw The desired final rotation
+     * @param cancel Optional flag checked every control cycle, Shelfino stops when it is set
+     * @param feedback Optional feedback of the movement
      * @return Final rotation of shelfino
      */
-    double move_to(const Coordinates &pos, double yaw);
+    double move_to(const Coordinates &pos, double yaw, const std::atomic<bool> *cancel = nullptr,
+        const ShelfinoFeedbackFunction &feedback = ShelfinoFeedbackFunction());
 
     /**
      * Rotate Shelfino from its current rotation to look towards the desired position.
@@ -114,9 +133,12 @@ public:
      * The rotation may be interrupted if a block is detected on the vision topic.
      * 
      * @param angle The desired rotation
+     * @param cancel Optional flag checked every control cycle, Shelfino stops when it is set
+     * @param feedback Optional feedback of the movement
      * @return The final rotation of shelfino
      */
-    double rotate(double angle);
+    double rotate(double angle, const std::atomic<bool> *cancel = nullptr,
+        const ShelfinoFeedbackFunction &feedback = ShelfinoFeedbackFunction());
 
     /**
      * Move shelfino forwards of the desired distance using lyapunov control.
@@ -124,9 +146,12 @@ public:
      * 
      * @param distance The distance that shelfino should travel
      * @param control Use Lyapunov control if True. Break if block detected.
+     * @param cancel Optional flag checked every control cycle, Shelfino stops when it is set
+     * @param feedback Optional feedback of the movement
      * @return Final position of Shelfino
     */
-    Coordinates move_forward(double distance, bool control);
+    Coordinates move_forward(double distance, bool control, const std::atomic<bool> *cancel = nullptr,
+        const ShelfinoFeedbackFunction &feedback = ShelfinoFeedbackFunction());
 
     /**
      * Reset the odometry values by setting the current position as origin
@@ -16,9 +16,18 @@
 #include "shelfino_controller/Rotate.h"
 #include "shelfino_controller/PointTo.h"
 #include "shelfino_controller/MoveForward.h"
+#include "shelfino_controller/MoveToAction.h"
+#include "shelfino_controller/RotateAction.h"
+#include "shelfino_controller/MoveForwardAction.h"
 #include "std_srvs/SetBool.h"
+#include <actionlib/server/simple_action_server.h>
+#include <atomic>
 #include <signal.h>
 
+typedef actionlib::SimpleActionServer<shelfino_controller::MoveToAction> MoveToActionServer;
+typedef actionlib::SimpleActionServer<shelfino_controller::RotateAction> RotateActionServer;
+typedef actionlib::SimpleActionServer<shelfino_controller::MoveForwardAction> MoveForwardActionServer;
+
 /**
  * Handle requests from shelfino/move_to ROS service. Call move_to function on Shelfino controller.
  * If yaw param is equal to zero, no rotation is applied at the end of the forward movement.
@@ -55,6 +64,30 @@ bool point_to(shelfino_controller::PointTo::Request &req, shelfino_controller::P
  */
 bool move_forward(shelfino_controller::MoveForward::Request &req, shelfino_controller::MoveForward::Response &res);
 
+/**
+ * Execute the goals of the shelfino/move_to_action action server, in the thread of the server.
+ * Same movement of the shelfino/move_to service, with feedback; a preempted goal stops Shelfino.
+ * 
+ * @param goal The coordinates of the desired position and rotation of shelfino
+ */
+void execute_move_to(const shelfino_controller::MoveToGoalConstPtr &goal);
+
+/**
+ * Execute the goals of the shelfino/rotate_action action server, in the thread of the server.
+ * Same movement of the shelfino/rotate service, with feedback; a preempted goal stops Shelfino.
+ * 
+ * @param goal The desired angle of rotation
+ */
+void execute_rotate(const shelfino_controller::RotateGoalConstPtr &goal);
+
+/**
+ * Execute the goals of the shelfino/move_forward_action action server, in the thread of the server.
+ * Same movement of the shelfino/move_forward service, with feedback; a preempted goal stops Shelfino.
+ * 
+ * @param goal The distance that shelfino should run, and the control flag
+ */
+void execute_move_forward(const shelfino_controller::MoveForwardGoalConstPtr &goal);
+
 /**
  * Signal handler to poweroff shelfino engines on CTRL+C 
  */
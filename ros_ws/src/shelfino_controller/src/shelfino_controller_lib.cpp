@@ -13,6 +13,8 @@ ShelfinoController::ShelfinoController(double linear_velocity, double angular_ve
     this->current_rotation = 0;
     this->odometry_rotation = 0;
     this->current_position << 0, 0, 0;
+    this->block_detected = false;
+    this->disable_vision = false;
 
     // Publisher initialization
     velocity_pub = node.advertise<geometry_msgs::Twist>("/cmd_vel", 1);
@@ -22,21 +24,23 @@ ShelfinoController::ShelfinoController(double linear_velocity, double angular_ve
     detection_sub = node.subscribe("/shelfino/yolo/detections", 10, &ShelfinoController::detection_callback, this);
 }
 
-double ShelfinoController::move_to(const Coordinates &pos, double yaw)
+double ShelfinoController::move_to(const Coordinates &pos, double yaw, const atomic<bool> *cancel, const ShelfinoFeedbackFunction &feedback)
 {
+    lock_guard<recursive_mutex> motion_lock(motion_mutex);
     ROS_DEBUG("Moving Shelfino: initial position: %.2f %.2f %.2f, initial rotation: %.2f", current_position(0), current_position(1), current_position(2), current_rotation); 
     disable_vision = true;
 
     // Compute the first rotation to make shelfino look towards the destination point
     double first_rot = shelfino_trajectory_rotation(current_position, current_rotation, pos);
-    rotate(first_rot);
+    rotate(first_rot, cancel, feedback);
     
     // Move forward and reach desired position
     double distance = sqrt(pow(pos(0) - current_position(0), 2) + pow(pos(1) - current_position(1), 2));
     
-    move_forward(distance, true);
+    if (cancel == nullptr || !*cancel)
+        move_forward(distance, true, cancel, feedback);
 
-    if (yaw == 0) {
+    if (yaw == 0 || (cancel != nullptr && *cancel)) {
         disable_vision = false;
         ROS_DEBUG("Moving Shelfino: final position: %.2f %.2f %.2f, final rotation: %.2f", current_position(0), current_position(1), current_position(2), current_rotation); 
         return current_rotation; 
@@ -44,7 +48,7 @@ double ShelfinoController::move_to(const Coordinates &pos, double yaw)
 
     // Rotate shelfino to match final rotation yaw
     double final_rot = norm_angle(yaw - current_rotation);
-    rotate(final_rot);
+    rotate(final_rot, cancel, feedback);
     
     ROS_DEBUG("Moving Shelfino: final position: %.2f %.2f %.2f, final rotation: %.2f", current_position(0), current_position(1), current_position(2), current_rotation); 
     disable_vision = false;
@@ -62,24 +66,32 @@ double ShelfinoController::point_to(const Coordinates &pos)
     return current_rotation;
 }
 
-double ShelfinoController::rotate(double angle)
+double ShelfinoController::rotate(double angle, const atomic<bool> *cancel, const ShelfinoFeedbackFunction &feedback)
 {
+    lock_guard<recursive_mutex> motion_lock(motion_mutex);
     double movement_duration = abs(angle / angular_velocity);
     double elapsed_time = 0;
+    double direction = angle > 0 ? 1 : -1;
     block_detected = false;
     
-    while (ros::ok())
+    for (int cycle = 0; ros::ok(); cycle++)
     {
         // Select rotation direction and publish to topic
         angle > 0 ? send_velocity(0, angular_velocity) : send_velocity(0, -angular_velocity);
-     
-        if (elapsed_time > movement_duration || block_detected)
+
+        bool cancelled = cancel != nullptr && *cancel;
+        if (elapsed_time > movement_duration || block_detected || cancelled)
         {
             if (block_detected)
                 ROS_DEBUG("Detected block during rotation, breaking.");
+            if (cancelled)
+                ROS_INFO("Shelfino rotation cancelled");
             break;
         }
 
+        if (feedback && cycle % feedback_decimation == 0)
+            feedback(current_position, current_rotation + direction * angular_velocity * elapsed_time, movement_duration > 0 ? elapsed_time / movement_duration : 1.0);
+
         loop_rate.sleep();
         ros::spinOnce();
         elapsed_time += 1.0 / loop_frequency;
@@ -93,27 +105,35 @@ double ShelfinoController::rotate(double angle)
         current_rotation = current_rotation + angular_velocity * elapsed_time;
     else 
         current_rotation = current_rotation - angular_velocity * elapsed_time;
+    if (feedback)
+        feedback(current_position, current_rotation, movement_duration > 0 ? min(1.0, elapsed_time / movement_duration) : 1.0);
     return current_rotation;
 }
 
-Coordinates ShelfinoController::move_forward(double distance, bool control)
+Coordinates ShelfinoController::move_forward(double distance, bool control, const atomic<bool> *cancel, const ShelfinoFeedbackFunction &feedback)
 {
+    lock_guard<recursive_mutex> motion_lock(motion_mutex);
     ROS_DEBUG("Moving Shelfino forward: initial position: %.2f %.2f %.2f", current_position(0), current_position(1), current_position(2)); 
     double movement_duration = abs(distance / linear_velocity);
     Coordinates des_pos;
     double elapsed_time = 0;
     double linear_res = 0, angular_res = 0; // Output of the Lyapunov control
 
+    Coordinates direction(cos(current_rotation), sin(current_rotation), 0);
     block_detected = false;
 
-    while (ros::ok())
+    for (int cycle = 0; ros::ok(); cycle++)
     {
         if (control)
         {
             // Compute Lyapunov line control
             des_pos << current_position(0) + (linear_velocity * cos(current_rotation) * elapsed_time), 
                 current_position(1) + (linear_velocity * sin(current_rotation) * elapsed_time), 0;
-            line_control(odometry_position, odometry_rotation, des_pos, current_rotation, linear_velocity, 0.0, linear_res, angular_res);
+            unique_lock<mutex> odometry_lock(odometry_mutex);
+            Coordinates position = odometry_position;
+            double rotation = odometry_rotation;
+            odometry_lock.unlock();
+            line_control(position, rotation, des_pos, current_rotation, linear_velocity, 0.0, linear_res, angular_res);
 
             // Publish to topic
             send_velocity(linear_res, angular_res);
@@ -124,13 +144,19 @@ Coordinates ShelfinoController::move_forward(double distance, bool control)
             send_velocity(linear_velocity, 0);
         }
 
-        if (elapsed_time > movement_duration || block_detected && control)
+        bool cancelled = cancel != nullptr && *cancel;
+        if (elapsed_time > movement_duration || (block_detected && control) || cancelled)
         {
             if (block_detected && control)
                 ROS_DEBUG("Detected block during movement, breaking.");
+            if (cancelled)
+                ROS_INFO("Shelfino movement cancelled");
             break;
         }
 
+        if (feedback && cycle % feedback_decimation == 0)
+            feedback(current_position + direction * linear_velocity * elapsed_time, current_rotation, movement_duration > 0 ? elapsed_time / movement_duration : 1.0);
+
         loop_rate.sleep();
         ros::spinOnce();
         elapsed_time += 1.0 / loop_frequency;
@@ -142,6 +168,8 @@ Coordinates ShelfinoController::move_forward(double distance, bool control)
     current_position(0) = current_position(0) + elapsed_time * linear_velocity * cos(current_rotation);
     current_position(1) = current_position(1) + elapsed_time * linear_velocity * sin(current_rotation);
     ROS_DEBUG("Moving Shelfino forward: final position: %.2f %.2f %.2f", current_position(0), current_position(1), current_position(2)); 
+    if (feedback)
+        feedback(current_position, current_rotation, movement_duration > 0 ? min(1.0, elapsed_time / movement_duration) : 1.0);
 
     return current_position;
 }
@@ -149,6 +177,7 @@ Coordinates ShelfinoController::move_forward(double distance, bool control)
 void ShelfinoController::reset_odometry(void)
 {
     ros::spinOnce();
+    lock_guard<mutex> odometry_lock(odometry_mutex);
     odometry_position_0 = odometry_position;
     odometry_rotation_0 = odometry_rotation;
 
@@ -161,6 +190,7 @@ void ShelfinoController::reset_odometry(void)
 
 void ShelfinoController::odometry_callback(const nav_msgs::Odometry::ConstPtr &msg)
 {
+    lock_guard<mutex> odometry_lock(odometry_mutex);
     geometry_msgs::Point p = msg->pose.pose.position;
     odometry_position << p.x, p.y, 0;
     odometry_position -= odometry_position_0;
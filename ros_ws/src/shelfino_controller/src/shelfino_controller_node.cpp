@@ -5,6 +5,11 @@ ShelfinoController *controller_ptr = nullptr;
 std_srvs::SetBool shelfino_power_srv;
 ros::ServiceClient shelfino_power;
 
+MoveToActionServer *move_action_ptr = nullptr;
+RotateActionServer *rotate_action_ptr = nullptr;
+MoveForwardActionServer *forward_action_ptr = nullptr;
+std::atomic<bool> move_action_cancel(false), rotate_action_cancel(false), forward_action_cancel(false);
+
 bool srv_move_to(shelfino_controller::MoveTo::Request &req, shelfino_controller::MoveTo::Response &res)
 {
     Coordinates pos;
@@ -40,6 +45,68 @@ bool srv_move_forward(shelfino_controller::MoveForward::Request &req, shelfino_c
     return true;
 }
 
+/**
+ * Feedback of a movement published by an action server
+ */
+template <typename Server, typename Feedback>
+ShelfinoFeedbackFunction action_feedback(Server *server)
+{
+    return [server](const Coordinates &position, double rotation, double progress)
+    {
+        Feedback feedback_msg;
+        feedback_msg.pos.x = position(0);
+        feedback_msg.pos.y = position(1);
+        feedback_msg.rot = rotation;
+        feedback_msg.progress = progress;
+        server->publishFeedback(feedback_msg);
+    };
+}
+
+/**
+ * Outcome of a goal: preempted if the cancellation flag has been set, succeeded otherwise
+ */
+template <typename Server, typename Result>
+void action_result(Server *server, const std::atomic<bool> &cancel, const Result &result)
+{
+    if (cancel || server->isPreemptRequested())
+        server->setPreempted(result);
+    else
+        server->setSucceeded(result);
+}
+
+void execute_move_to(const shelfino_controller::MoveToGoalConstPtr &goal)
+{
+    Coordinates pos;
+    pos << goal->pos.x, goal->pos.y, 0;
+
+    // The preempt callback may run before the movement starts
+    move_action_cancel = move_action_ptr->isPreemptRequested();
+    shelfino_controller::MoveToResult result;
+    result.rot = controller_ptr->move_to(pos, goal->rot, &move_action_cancel,
+        action_feedback<MoveToActionServer, shelfino_controller::MoveToFeedback>(move_action_ptr));
+    action_result(move_action_ptr, move_action_cancel, result);
+}
+
+void execute_rotate(const shelfino_controller::RotateGoalConstPtr &goal)
+{
+    rotate_action_cancel = rotate_action_ptr->isPreemptRequested();
+    shelfino_controller::RotateResult result;
+    result.rot = controller_ptr->rotate(goal->angle, &rotate_action_cancel,
+        action_feedback<RotateActionServer, shelfino_controller::RotateFeedback>(rotate_action_ptr));
+    action_result(rotate_action_ptr, rotate_action_cancel, result);
+}
+
+void execute_move_forward(const shelfino_controller::MoveForwardGoalConstPtr &goal)
+{
+    forward_action_cancel = forward_action_ptr->isPreemptRequested();
+    shelfino_controller::MoveForwardResult result;
+    Coordinates new_position = controller_ptr->move_forward(goal->distance, goal->control, &forward_action_cancel,
+        action_feedback<MoveForwardActionServer, shelfino_controller::MoveForwardFeedback>(forward_action_ptr));
+    result.pos.x = new_position(0);
+    result.pos.y = new_position(1);
+    action_result(forward_action_ptr, forward_action_cancel, result);
+}
+
 void handler(int sig)
 {
     // Engines power off on CTRL+C
@@ -54,8 +121,11 @@ int main(int argc, char **argv)
     ros::init(argc, argv, "shelfino_controller_node");
     ros::NodeHandle controller_node;
 
-    // Initialize controller
-    ShelfinoController controller(0.2, 0.2, 50.0);
+    // Initialize controller, the main controller plans the order of the areas with the same velocities
+    double linear_velocity = 0.2, angular_velocity = 0.2;
+    ros::param::get("/shelfino_linear_velocity", linear_velocity);
+    ros::param::get("/shelfino_angular_velocity", angular_velocity);
+    ShelfinoController controller(linear_velocity, angular_velocity, 50.0);
     ros::Duration(2.0).sleep(); // do not remove this sleep (necessary to reset odometry)
     // Reset odometry: shelfino thinks it is in position (0,0,0) after this node starts running
     // otherwise lyapunov control (and the movement functions generally) will have problems
@@ -79,6 +149,20 @@ int main(int argc, char **argv)
     ros::ServiceServer rotate_service = controller_node.advertiseService("shelfino/rotate", srv_rotate);
     ros::ServiceServer point_service = controller_node.advertiseService("shelfino/point_to", srv_point_to);
     ros::ServiceServer forward_service = controller_node.advertiseService("shelfino/move_forward", srv_move_forward);
+
+    // Preemptible movements with feedback, the goals are executed in the threads of the servers
+    MoveToActionServer move_action(controller_node, "shelfino/move_to_action", execute_move_to, false);
+    RotateActionServer rotate_action(controller_node, "shelfino/rotate_action", execute_rotate, false);
+    MoveForwardActionServer forward_action(controller_node, "shelfino/move_forward_action", execute_move_forward, false);
+    move_action_ptr = &move_action;
+    rotate_action_ptr = &rotate_action;
+    forward_action_ptr = &forward_action;
+    move_action.registerPreemptCallback([]() { move_action_cancel = true; });
+    rotate_action.registerPreemptCallback([]() { rotate_action_cancel = true; });
+    forward_action.registerPreemptCallback([]() { forward_action_cancel = true; });
+    move_action.start();
+    rotate_action.start();
+    forward_action.start();
     
     ros::spin();
 
@@ -11,8 +11,76 @@
 #define __UR5_CONTROLLER_H__
 
 #include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/thread_pool.h"
+#include "kinematics_lib/toppra.h"
+#include "kinematics_lib/rrt_connect.h"
+#include "kinematics_lib/roadmap.h"
+#include "kinematics_lib/reachability_map.h"
+#include "kinematics_lib/collision.h"
+#include "kinematics_lib/cartesian_path.h"
+#include "kinematics_lib/ik_cache.h"
+#include "kinematics_lib/spsc_ring.h"
+#include "kinematics_lib/seqlock.h"
+#include "kinematics_lib/jitter_histogram.h"
 #include "ros/ros.h"
+#include <ros/callback_queue.h>
 #include <sensor_msgs/JointState.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Timings and outcome of the path planning of the last move_to
+ */
+struct PlanningStats
+{
+    double ik_time; // seconds spent computing and sorting the inverse kinematics
+    double planning_time; // seconds from the start of move_to until the path to follow is known
+    int candidates; // number of ik solutions that have been validated
+    int selected_rank; // rank of the followed solution (0 is the closest one), -1 if no path was valid
+    int discarded; // lower ranked candidates cancelled or ignored once the selected one was valid
+    double fallback_time; // seconds spent in the sampling based planner when no cubic path was valid, 0 if not used
+    int fallback_waypoints; // number of configurations of the fallback path, 0 if no fallback path was found
+    int validated_configurations; // configurations evaluated by the continuous checks of the candidate paths
+    bool ik_cache_hit; // the ik solutions of the target were cached
+    int ik_iterations; // iterations of the iterative ik (no exact analytic solution or cached pose refined), 0 if not used
+};
+
+/**
+ * @brief Timings of the precomputed steps and tracking of the last straight line motion (move_linear).
+ * The steps are computed open-loop before the motion, the timings do not measure the control loop.
+ */
+struct CartesianStats
+{
+    int ticks; // control ticks of the motion streamed, one setpoint each
+    double mean_step_time; // seconds spent in the differential inverse kinematics of a precomputed step, on average
+    double max_step_time; // longest differential inverse kinematics of a precomputed step
+    int slow_steps; // precomputed steps whose differential inverse kinematics took longer than the loop period
+    double max_position_error; // largest distance between the end effector of a setpoint and the line (m)
+    double max_rotation_error; // largest angle between the end effector of a setpoint and the rotation of the line at its time (rad)
+};
+
+/**
+ * Feedback of a movement, called at most every feedback period from the thread of the movement
+ *
+ * @param stage "moving" while the setpoints are streamed, "settling" while the final configuration is held
+ * @param joints The last joints configuration received
+ * @param progress Fraction of the joints space distance covered by the current segment, from 0 to 1
+ */
+typedef std::function<void(const std::string &stage, const JointStateVector &joints, double progress)> UR5FeedbackFunction;
+
+/**
+ * @brief Last joint states received from /ur5/joint_states, plain arrays to be copied by the seqlock
+ */
+struct JointStateSample
+{
+    double joints[6];
+    double gripper[3];
+};
 
 /**
  * @brief The UR5 Controller class implements the high level functions for the movement and control of UR5
@@ -22,10 +90,16 @@ class UR5Controller
 {
 private:
     ros::NodeHandle node;
-    ros::Rate loop_rate;
     ros::Publisher joint_state_pub;
     ros::Publisher gripper_state_pub;
+    ros::Publisher jitter_pub;
+
+    // The joint states and the jitter timer have their own queue and spinner, served while a movement is running
+    ros::CallbackQueue control_queue;
+    ros::NodeHandle control_node;
+    ros::AsyncSpinner control_spinner;
     ros::Subscriber joint_state_sub;
+    ros::WallTimer jitter_timer;
 
     double settling_time;
     double loop_frequency;
@@ -35,21 +109,116 @@ private:
                                   "wrist_1_joint", "wrist_2_joint", "wrist_3_joint",
                                   "hand_1_joint", "hand_2_joint", "hand_3_joint"};
 
-    JointStateVector current_joints;
-    GripperStateVector current_gripper;
+    SeqLock<JointStateSample> joint_state; // written by the joint states callback, read by the planner and the control thread
     bool is_real_robot = false;
     bool using_soft_gripper = false;
     bool is_simulating_gripper = false;
 
     int gripper_diameter;
 
+    // Real-time streaming of the setpoints: the planner fills the ring, the control thread publishes one setpoint per cycle
+    SpscRing<JointStateVector, 512> setpoints;
+    JitterHistogram jitter_histogram;
+    std::thread control_thread;
+    std::atomic<bool> control_running;
+    std::atomic<bool> holding; // the control thread republishes the last setpoint while the ring is empty
+    std::atomic<bool> flush_requested; // the control thread discards the queued setpoints and stops the robot, then it clears the flag
+    std::mutex motion_mutex; // one movement or gripper command at a time, the other services are served concurrently
+    int control_priority = 80; // SCHED_FIFO priority of the control thread
+
+    // Cancellation flag and feedback of the current movement, set by MotionScope
+    const std::atomic<bool> *motion_cancelled = nullptr;
+    UR5FeedbackFunction motion_feedback;
+    JointStateVector segment_start, segment_end; // straight segment of the joints space followed, for the progress
+    std::chrono::steady_clock::time_point last_feedback;
+    double feedback_period = 0.1; // seconds between two feedback calls
+
+    ThreadPool planning_pool;
+    PlanningStats planning_stats;
+    CartesianStats cartesian_stats;
+    OnlineTrajectoryGenerator trajectory_generator;
+    OnlineTrajectoryGenerator stop_generator; // jerk limited stop of a cancelled movement, used by the control thread only
+    RRTConnect fallback_planner;
+    Roadmap roadmap;
+    ReachabilityMap reachability_map;
+    CollisionScene collision_scene;
+    IKCache ik_cache;
+    double fallback_time = 1.0;
+    double clearance_distance = 0.15; // largest clearance of the links computed by the continuous checks (m)
+    double max_check_step = 0.1; // longest motion accepted by the continuous checks without evaluating a configuration (rad)
+    double linear_velocity = 0.2; // maximum speed of the end effector in the straight line motions (m/s)
+    double angular_velocity = 0.8; // maximum angular speed of the end effector in the straight line motions (rad/s)
+    double ik_gain = 20.0; // gain of the pose error correction of the differential inverse kinematics (1/s)
+    double ik_damping = 0.02; // damping factor of the differential inverse kinematics
+    double ik_tolerance = 0.001; // largest pose error accepted from the iterative inverse kinematics
+
     /**
-     * Callback function, listen to /ur5/joint_states topic and update current_pos
+     * @brief Scope of a movement: hold the movement mutex and set the cancellation flag and the feedback
+     * of the movement, reset when the movement returns
+     * @class MotionScope
+     */
+    class MotionScope
+    {
+    private:
+        UR5Controller &controller;
+        std::lock_guard<std::mutex> lock;
+
+    public:
+        MotionScope(UR5Controller &controller, const std::atomic<bool> *cancelled, const UR5FeedbackFunction &feedback);
+        ~MotionScope();
+    };
+
+    /**
+     * Callback function, listen to /ur5/joint_states topic and update the joint states snapshot
      * 
      * @param msg The data received from the topic
      */
     void joint_state_callback(const sensor_msgs::JointState::ConstPtr &msg);
 
+    /**
+     * Body of the control thread. Wake up at absolute deadlines every loop period (SCHED_FIFO if allowed),
+     * record the wake-up latency in the jitter histogram and publish the next setpoint of the ring,
+     * or the last one while holding
+     */
+    void control_loop(void);
+
+    /**
+     * Queue a setpoint for the control thread. Wait while the ring is full, the control thread paces the planner.
+     * Call the feedback of the movement, at most every feedback period.
+     * 
+     * @param setpoint The desired configuration of a control cycle
+     * @return false if the movement has been cancelled, the setpoint is not queued
+     */
+    bool stream_setpoint(const JointStateVector &setpoint);
+
+    /**
+     * Wait until the control thread has consumed every queued setpoint, or the movement is cancelled
+     */
+    void wait_setpoints(void);
+
+    /**
+     * @return true if the cancellation flag of the current movement is set
+     */
+    bool is_cancelled(void) const;
+
+    /**
+     * Call the feedback of the movement, if any, with the progress along the current segment
+     * 
+     * @param stage The stage of the movement
+     * @param force Call it even if the last call was less than a feedback period ago
+     */
+    void report(const std::string &stage, bool force = false);
+
+    /**
+     * @return The last joints configuration received, from the seqlock snapshot
+     */
+    JointStateVector read_joints(void) const;
+
+    /**
+     * Timer callback, publish the counts of the jitter histogram on /ur5/control_jitter
+     */
+    void publish_jitter(const ros::WallTimerEvent &event);
+
     /**
      * Convert the JointStateVector desired_pos to a Float64MultiArray,
      * then send the array to ros topic defined by the joint_state_pub publisher
@@ -66,68 +235,235 @@ private:
     void send_gripper_state(int diameter) const;
 
     /**
-     * Compute joint values by following consecutive approximations.
-     * The velocity of the end effector remains constant.
-     * Use this function iteratively to send joint states to the robot and avoid steps.
-     * Use init_filters function before starting to use this filter.
+     * Compute difference between the two vectors, by normalizing the angles first.
+     * Eg. -PI/2 will be equal to 3*PI/2
+     * 
+     * @param first_vector The first joints configuration
+     * @param second_vecotr The second joints configuration
+     * @return The norm of the difference between first and second vectors
+     */
+    double compute_error(const JointStateVector &first_vector, const JointStateVector &second_vector) const;
+
+    /**
+     * Inverse kinematics of a pose, ranked by the distance from the initial configuration:
+     * 1. Look up the pose in the cache, the cached solutions of a slightly different pose are refined with a few iterations
+     * 2. Otherwise keep the exact analytic solutions; if every analytic branch is out of reach, run the damped
+     *    Levenberg-Marquardt iterations warm-started from the initial configuration, accepted within ik_tolerance
+     * 3. Cache the solutions found
+     * The cache hit and the iterations are reported in planning_stats.
      * 
-     * @param final_joints The desired joints configuration
-     * @return The filtered configuration
+     * @param pos Cartesian position of the end effector
+     * @param rot Rotation of the end effector
+     * @param initial_joints The configuration used to rank the solutions and to start the iterations
+     * @return The solutions, the closest one first. Empty if the pose cannot be reached
      */
-    JointStateVector linear_filter(const JointStateVector &final_joints);
+    std::vector<JointStateVector> solve_ik(const Coordinates &pos, const RotationMatrix &rot, const JointStateVector &initial_joints);
 
     /**
-     * Init values of the linear filter 
+     * Check a joints configuration: workbench constraint and singularities (ur5_check_configuration),
+     * then the capsules of the links against the obstacles of the scene, if loaded
+     * 
+     * @param joints The joints configuration
+     * @param grasping If true the gripper may touch the grasp obstacles of the scene (straight line approaches and retracts)
+     * @return true if the configuration is valid
      */
-    void init_filters(void);
+    bool validate_configuration(const JointStateVector &joints, bool grasping = false) const;
 
     /**
-     * Compute difference between the two vectors, by normalizing the angles first.
-     * Eg. -PI/2 will be equal to 3*PI/2
+     * Check a joints configuration like validate_configuration, and compute the distance of every link
+     * from the obstacles of the scene and of the end effector from the workbench constraint
      * 
-     * @param first_vector The first joints configuration
-     * @param second_vecotr The second joints configuration
-     * @return The norm of the difference between first and second vectors
+     * @param joints The joints configuration
+     * @param clearance output - the distances, at most clearance_distance
+     * @return true if the configuration is valid
      */
-    double compute_error(const JointStateVector &first_vector, const JointStateVector &second_vector) const;
+    bool configuration_clearance(const JointStateVector &joints, UR5LinkDistances &clearance) const;
+
+    /**
+     * Continuous check of a straight motion in the joints space (CollisionScene::check_motion): the configurations
+     * are evaluated only where the clearance is small, and at least every max_check_step for the singularities
+     * 
+     * @param from The initial configuration
+     * @param to The final configuration
+     * @param cancelled Optional flag checked before every configuration, the validation stops when it is set
+     * @param evaluations output - optional, number of configurations evaluated
+     * @return true if the motion is valid, false if some constraints are not met or the validation was cancelled
+     */
+    bool validate_motion(const JointStateVector &from, const JointStateVector &to, const std::atomic<bool> *cancelled = nullptr,
+        int *evaluations = nullptr) const;
+
+    /**
+     * Validate a cubic trajectory: its path is the straight motion between the first and the last configuration,
+     * checked continuously with validate_motion rather than at the n samples of the trajectory
+     * 
+     * @param path The trajectory
+     * @param cancelled Optional flag checked before every configuration, the validation stops when it is set
+     * @param evaluations output - optional, number of configurations evaluated
+     * @return true if path is valid, false if some constraints are not met or the validation was cancelled
+     */
+    bool validate_path(const CubicTrajectory &path, const std::atomic<bool> *cancelled = nullptr, int *evaluations = nullptr) const;
 
     /**
-     * For every joint configuration: 
-     * 1. Compute direct kinematics and check if the posititon collides with the workbanch
-     * 2. Compute jacobian, its determinant and the minimum singular value to avoid singularities
+     * Validate the configurations of a geometric path, sampled at a fixed step of the path parameter
      * 
-     * @param path Pointer to the vector of n * 6 elements, it represents the n configurations of the joints during the trajectory
-     * @param n The number of configurations of the joints during the trajectory
+     * @param path The geometric path
+     * @param step The distance between two samples, in path parameter units
      * @return true if path is valid, false if some constraints are not met
      */
-    bool validate_path(double *path, int n) const;
+    bool validate_path(const JointPath &path, double step) const;
+
+    /**
+     * Stream the setpoints of the path to the control thread, timed by the jerk limited trajectory generator.
+     * Then wait for the joints to reach the final configuration, at most settling_time seconds.
+     * 
+     * @param path The validated trajectory
+     */
+    void follow_path(const CubicTrajectory &path);
+
+    /**
+     * Stream the setpoints of a geometric path to the control thread, timed by the time optimal parameterization
+     * with the velocity and acceleration limits of the joints. Then wait for the joints to reach the end of the path.
+     * 
+     * @param path The validated path
+     * @return false if the path cannot be timed within the limits
+     */
+    bool follow_timed_path(const JointPath &path);
+
+    /**
+     * Plan a path towards the ik solutions, in ranked order, when none of the cubic paths is valid:
+     * first with the precomputed roadmap, if loaded, then with the sampling based planner.
+     * The time budget of the planner (fallback_time) is shared by the solutions, the path found is shortened.
+     * 
+     * @param initial_joints The current configuration
+     * @param paths The cubic paths of the ik solutions, in ranked order
+     * @param waypoints output - the configurations of the path, joined by valid straight motions
+     * @return false if no path was found within the time budget
+     */
+    bool plan_fallback(const JointStateVector &initial_joints, const std::vector<CubicTrajectory> &paths, std::vector<JointStateVector> &waypoints);
+
+    /**
+     * Follow the straight motions between the waypoints, with the corners blended within the tolerance.
+     * If the blended path is not valid, the robot stops at every waypoint.
+     * 
+     * @param waypoints The configurations, the first one is the current configuration. The straight motions must be valid
+     * @param tolerance Maximum distance (joints space norm, rad) between the path and the intermediate configurations
+     */
+    void follow_waypoints(const std::vector<JointStateVector> &waypoints, double tolerance);
+
+    /**
+     * Wait for the streamed setpoints to be published, then hold the final configuration
+     * until the joints reach it within joints_error, at most settling_time seconds.
+     * If the movement is cancelled, the queued setpoints are discarded and the control thread stops the robot from its
+     * current velocity and acceleration, within the jerk limits.
+     * 
+     * @param final_joints The final configuration of the movement
+     */
+    void settle(const JointStateVector &final_joints);
 
 public:
     /**
-     * Constructor. Initialize ros publishers and subscribers.
+     * Constructor. Initialize ros publishers and subscribers, start the joint states spinner and the control thread.
      * 
-     * @param loop_frequency Specifies the rate of received and sent instruction in a movement loop.
+     * @param loop_frequency Specifies the rate of the setpoints sent by the control thread.
      * @param joints_error Acceptable error between desired position and effective position at the end of a movement operation. Higher value => less precision.
-     * @param settling_time Required time to complete a movement operation. Higher value => higher speed.
+     * @param settling_time Maximum time waited at the end of a movement operation for the joints to reach the final configuration within joints_error.
      */
     UR5Controller(double loop_frequency, double joints_error, double settling_time);
 
+    /**
+     * Destructor. Stop the control thread and the joint states spinner.
+     */
+    ~UR5Controller();
+
     /**
      * Move end effector to desired position (pos) and rotation (rot) by following a path computed by the kinematics libray
      * 
      * @param pos Final cartesian position of the end effector
      * @param rot Final rotation of the end effector
      * @param n Number of intermediate points
-     * @return true if path was valid and movement succeded
+     * @param cancel Optional flag checked every control cycle, the robot stops when it is set
+     * @param feedback Optional feedback of the movement
+     * @return true if path was valid and movement succeded, false if cancelled
      * 
      * This function follows the procedure:
-     * 1. Read the /ur5/joint_states topic and get the initial configuration 
-     * 2. Compute complete inverse kinematics to find all the possibile final configurations
+     * 0. Reject the target if the reachability map shows it cannot be reached
+     * 1. Read the last joint states snapshot and get the initial configuration
+     * 2. Compute complete inverse kinematics to find all the possibile final configurations (solve_ik: cached, iterative if out of reach)
      * 3. Compute the path of for every ik solution
-     * 4. Compute direct kinematics on every configuration inside the path and check position and singularity constraints
-     * 5. If the path is acceptable, follow it 
+     * 4. Check the position, singularity and collision constraints along the path, continuously where the clearance is small.
+     *    The candidates are validated concurrently on the planning pool, a valid path cancels the validation of the lower ranked ones
+     * 5. Follow the valid path of the closest ik solution
+     * 6. If no path is valid, search a path in the precomputed roadmap or plan it with the sampling based planner (RRT-Connect)
+     *    within a bounded time, and follow it
+     */
+    bool move_to(const Coordinates &pos, const RotationMatrix &rot, int n, const std::atomic<bool> *cancel = nullptr,
+        const UR5FeedbackFunction &feedback = UR5FeedbackFunction());
+
+    /**
+     * Move end effector through a sequence of poses without stopping at the intermediate ones.
+     * The ik solution of every pose is the closest one to the previous pose with a valid cubic path;
+     * the resulting configurations are joined by straight segments in the joints space and the corners are blended.
+     * If the blended path is not valid, the robot stops at every pose.
+     * 
+     * @param positions Cartesian positions of the end effector, the last one is the final position
+     * @param rotations Rotations of the end effector, one for every position
+     * @param tolerance Maximum distance (joints space norm, rad) between the path and the intermediate configurations
+     * @param cancel Optional flag checked every control cycle, the robot stops when it is set
+     * @param feedback Optional feedback of the movement
+     * @return true if all the poses were reachable and movement succeded, false if cancelled
      */
-    bool move_to(const Coordinates &pos, const RotationMatrix &rot, int n);
+    bool move_through(const std::vector<Coordinates> &positions, const std::vector<RotationMatrix> &rotations, double tolerance,
+        const std::atomic<bool> *cancel = nullptr, const UR5FeedbackFunction &feedback = UR5FeedbackFunction());
+
+    /**
+     * Move end effector along the straight line to the desired pose, open-loop: one step of the damped least squares
+     * differential inverse kinematics (analytic jacobian) per control tick maps the pose and velocity of the line to the
+     * next setpoint, starting from the previous setpoint and the current joints for the first one. All the setpoints are
+     * computed and validated before the motion, then streamed without feedback from the measured joints:
+     * joint velocity limits, workbench constraint, singularities and collisions. The straight lines are the approaches
+     * to the grasps and the retracts: the gripper may touch the grasp obstacles of the scene.
+     * 
+     * @param pos Final cartesian position of the end effector
+     * @param rot Final rotation of the end effector
+     * @param cancel Optional flag checked every control cycle, the robot stops when it is set
+     * @param feedback Optional feedback of the movement
+     * @return true if the line was valid and movement succeded, false if cancelled
+     */
+    bool move_linear(const Coordinates &pos, const RotationMatrix &rot, const std::atomic<bool> *cancel = nullptr,
+        const UR5FeedbackFunction &feedback = UR5FeedbackFunction());
+
+    /**
+     * Memory-map the precomputed roadmap of the workcell (built offline by ur5_roadmap_builder)
+     * 
+     * @param file The path of the roadmap file
+     * @return false if the file is not a valid roadmap
+     */
+    bool load_roadmap(const std::string &file);
+
+    /**
+     * Read the static scene of the workcell, the links of the robot are checked against its obstacles
+     * 
+     * @param file The path of the scene file
+     * @return false if the file is not a valid scene
+     */
+    bool load_scene(const std::string &file);
+
+    /**
+     * Read the reachability map of the end effector (built offline by ur5_reachability_builder)
+     * 
+     * @param file The path of the map file
+     * @return false if the file is not a valid map
+     */
+    bool load_reachability_map(const std::string &file);
+
+    /**
+     * Check a target with the reachability map, in constant time
+     * 
+     * @param pos Cartesian position of the end effector
+     * @param rot Rotation of the end effector
+     * @return The number of valid ik solutions around the position (0 if unreachable), -1 if the map does not cover the pose
+     */
+    int reachability(const Coordinates &pos, const RotationMatrix &rot) const;
 
     /**
      * Open and close the gripper at the selected diameter
@@ -142,16 +478,26 @@ public:
      * @return The current joint configuration
      */
     JointStateVector get_joint_states(void) const;
-};
 
-/**
- * Sort the 8 inverse kinematics results in ascending order by the norm of the difference between the
- * initial joints and the solution of the IK.
- * 
- * @param ik_result The 8x6 matrix containing the 8 results of the IK
- * @param initial_joints The joint vector that is compared to the IK results
- * @return A dynamically allocated vector containing the sorted indexes of the IK results    
-*/
-int *sort_ik_result(const Eigen::Matrix<double, 8, 6> &ik_result, const JointStateVector &initial_joints);
+    /**
+     * @return The timings and outcome of the path planning of the last move_to
+     */
+    PlanningStats get_planning_stats(void) const;
+
+    /**
+     * @return The hits, misses and evictions of the ik solutions cache since the start
+     */
+    IKCacheStats get_ik_cache_stats(void) const;
+
+    /**
+     * @return The timings of the precomputed steps and the tracking errors of the last move_linear
+     */
+    CartesianStats get_cartesian_stats(void) const;
+
+    /**
+     * @return The wake-up latencies of the control thread since the start
+     */
+    JitterStats get_jitter_stats(void) const;
+};
 
 #endif
\ No newline at end of file
@@ -13,7 +13,14 @@
 #include "ros/ros.h"
 #include "ur5_controller/ur5_controller_lib.h"
 #include "ur5_controller/MoveTo.h"
+#include "ur5_controller/MoveThrough.h"
+#include "ur5_controller/CheckReachable.h"
 #include "ur5_controller/SetGripper.h"
+#include "ur5_controller/MoveToAction.h"
+#include <actionlib/server/simple_action_server.h>
+#include <atomic>
+
+typedef actionlib::SimpleActionServer<ur5_controller::MoveToAction> MoveToActionServer;
 
 /**
  * Handle requests from ur5/move_to ROS service. Convert euler angles to rotation matrix
@@ -24,6 +31,23 @@
  */
 bool srv_move_to(ur5_controller::MoveTo::Request &req, ur5_controller::MoveTo::Response &res);
 
+/**
+ * Handle requests from ur5/move_through ROS service. Convert euler angles to rotation matrices
+ * and call move_through function on UR5 controller.
+ * 
+ * @param req The service request, contains the positions and rotations of the end effector and the blending tolerance
+ * @param res The service response, contains result of the move_through function as status 
+ */
+bool srv_move_through(ur5_controller::MoveThrough::Request &req, ur5_controller::MoveThrough::Response &res);
+
+/**
+ * Handle requests from ur5/check_reachable ROS service. Query the reachability map of the UR5 controller.
+ * 
+ * @param req The service request, contains position and rotation of the end effector
+ * @param res The service response, contains the number of valid ik solutions as status (0 if unreachable, -1 if unknown)
+ */
+bool srv_check_reachable(ur5_controller::CheckReachable::Request &req, ur5_controller::CheckReachable::Response &res);
+
 /**
  * Handle requests from ur5/set_gripper ROS service. Call set_gripper function on UR5 controller.
  * 
@@ -32,4 +56,18 @@ bool srv_move_to(ur5_controller::MoveTo::Request &req, ur5_controller::MoveTo::R
  */
 bool srv_set_gripper(ur5_controller::SetGripper::Request &req, ur5_controller::SetGripper::Response &res);
 
+/**
+ * Execute the goals of the ur5/move_to_action action server, in the thread of the server. Same movement of the
+ * ur5/move_to service, with the feedback of the controller published at most every 0.1 s.
+ * A preempted goal stops the robot from its current motion, within the jerk limits.
+ * 
+ * @param goal The final position and rotation of the end effector, straight line if linear
+ */
+void execute_move_to(const ur5_controller::MoveToGoalConstPtr &goal);
+
+/**
+ * Preempt callback of the ur5/move_to_action action server, set the cancellation flag of the running movement
+ */
+void preempt_move_to(void);
+
 #endif
\ No newline at end of file
@@ -1,42 +1,129 @@
 #include "ur5_controller/ur5_controller_lib.h"
 #include <std_msgs/Float64MultiArray.h>
 #include <std_msgs/Int32.h>
+#include <std_msgs/Int64MultiArray.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
 
 /* Public functions */
 
-UR5Controller::UR5Controller(double loop_frequency, double joints_error, double settling_time) : loop_rate(loop_frequency)
+UR5Controller::UR5Controller(double loop_frequency, double joints_error, double settling_time) : control_spinner(1, &control_queue),
+    control_running(true), holding(false), flush_requested(false), planning_pool(4),
+    trajectory_generator(ur5_joint_limits(), 1.0 / loop_frequency), stop_generator(ur5_joint_limits(), 1.0 / loop_frequency),
+    fallback_planner([this](const JointStateVector &q) { return validate_configuration(q); },
+        JointStateVector::Constant(-M_PI), JointStateVector::Constant(M_PI))
 {
     this->loop_frequency = loop_frequency;
     this->joints_error = joints_error;
     this->settling_time = settling_time;
+    this->planning_stats = PlanningStats();
+    this->cartesian_stats = CartesianStats();
 
     // Set params from ros param server
     node.getParam("/real_robot", is_real_robot);
     node.getParam("/soft_gripper", using_soft_gripper);
     node.getParam("/gripper_sim", is_simulating_gripper);
+    node.getParam("/ur5_control_priority", control_priority);
 
     // Publisher initialization
     joint_state_pub = node.advertise<std_msgs::Float64MultiArray>("/ur5/joint_group_pos_controller/command", 1000);
     gripper_state_pub = node.advertise<std_msgs::Int32>("/ur5/gripper_controller/command", 1);
+    jitter_pub = node.advertise<std_msgs::Int64MultiArray>("/ur5/control_jitter", 1);
 
-    // Subscriber initialization
-    joint_state_sub = node.subscribe("/ur5/joint_states", 1, &UR5Controller::joint_state_callback, this);
+    // Subscriber initialization, on the queue of the control spinner
+    control_node.setCallbackQueue(&control_queue);
+    joint_state_sub = control_node.subscribe("/ur5/joint_states", 1, &UR5Controller::joint_state_callback, this);
+    jitter_timer = control_node.createWallTimer(ros::WallDuration(1.0), &UR5Controller::publish_jitter, this);
+    control_spinner.start();
+
+    control_thread = std::thread(&UR5Controller::control_loop, this);
+}
+
+UR5Controller::~UR5Controller()
+{
+    control_running = false;
+    control_thread.join();
+    control_spinner.stop();
+}
+
+bool UR5Controller::load_roadmap(const std::string &file)
+{
+    if (!roadmap.load(file))
+    {
+        ROS_WARN("UR5 roadmap %s could not be loaded", file.c_str());
+        return false;
+    }
+    ROS_INFO("UR5 roadmap loaded: %d configurations", roadmap.size());
+    return true;
+}
+
+bool UR5Controller::load_scene(const std::string &file)
+{
+    if (!collision_scene.load(file))
+    {
+        ROS_WARN("UR5 scene %s could not be loaded", file.c_str());
+        return false;
+    }
+    ROS_INFO("UR5 scene loaded: %d obstacles", collision_scene.size());
+    return true;
+}
+
+bool UR5Controller::load_reachability_map(const std::string &file)
+{
+    if (!reachability_map.load(file))
+    {
+        ROS_WARN("UR5 reachability map %s could not be loaded", file.c_str());
+        return false;
+    }
+    ROS_INFO("UR5 reachability map loaded: %d gridpoints", reachability_map.size());
+    return true;
+}
+
+int UR5Controller::reachability(const Coordinates &pos, const RotationMatrix &rot) const
+{
+    if (!reachability_map.covers(rot))
+        return -1;
+    return reachability_map.dexterity(pos);
 }
 
 void UR5Controller::set_gripper(int diameter)
 {
+    std::lock_guard<std::mutex> motion_lock(motion_mutex);
     gripper_diameter = diameter;
     send_gripper_state(diameter);
 }
 
 JointStateVector UR5Controller::get_joint_states(void) const
 {
-    ros::spinOnce();
-    return current_joints;
+    return read_joints();
+}
+
+JitterStats UR5Controller::get_jitter_stats(void) const
+{
+    return jitter_histogram.stats();
 }
 
 /* Private functions */
 
+UR5Controller::MotionScope::MotionScope(UR5Controller &controller, const std::atomic<bool> *cancelled, const UR5FeedbackFunction &feedback)
+    : controller(controller), lock(controller.motion_mutex)
+{
+    controller.motion_cancelled = cancelled;
+    controller.motion_feedback = feedback;
+    controller.last_feedback = std::chrono::steady_clock::time_point();
+}
+
+UR5Controller::MotionScope::~MotionScope()
+{
+    controller.motion_cancelled = nullptr;
+    controller.motion_feedback = UR5FeedbackFunction();
+}
+
 void UR5Controller::joint_state_callback(const sensor_msgs::JointState::ConstPtr &msg)
 {
     int n; // number of joints    
@@ -45,22 +132,163 @@ void UR5Controller::joint_state_callback(const sensor_msgs::JointState::ConstPtr
     else
         n = using_soft_gripper ? 8 : 9;
 
+    // The joints missing from the message keep their last value
+    JointStateSample sample = joint_state.load();
+
     // Get joints values from topic
     for (int i = 0; i < n; i++)
     {
         for (int j = 0; j < 6; j++)
         {
             if (joint_names[j].compare(msg->name[i]) == 0)
-                current_joints(j) = msg->position[i];
+                sample.joints[j] = msg->position[i];
         }
         
         // Gripper
         for (int j = 6; j < n; j++)
         {
             if (joint_names[j].compare(msg->name[i]) == 0)
-                current_gripper(j - 6) = msg->position[i];
+                sample.gripper[j - 6] = msg->position[i];
+        }
+    }
+
+    // Single writer: the callbacks of the control queue are served by one thread
+    joint_state.store(sample);
+}
+
+void UR5Controller::control_loop(void)
+{
+    // Real-time priority, if the process is allowed to use it (rtprio limit or CAP_SYS_NICE)
+    sched_param param;
+    param.sched_priority = control_priority;
+    int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0)
+        ROS_WARN("UR5 control thread: SCHED_FIFO priority %d not allowed (%s), running with the default scheduler", control_priority, strerror(error));
+
+    const long period = (long)round(1e9 / loop_frequency);
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    // The last three setpoints published give the velocity and the acceleration of the robot when a movement is cancelled
+    const double cycle_time = 1.0 / loop_frequency;
+    JointStateVector setpoint, previous[2];
+    bool has_setpoint = false, stopping = false;
+    while (control_running)
+    {
+        // Absolute deadlines, the time spent in the cycle does not accumulate as drift
+        deadline.tv_nsec += period;
+        while (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_nsec -= 1000000000L;
+            deadline.tv_sec++;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR);
+
+        // Wake-up latency; after an overrun the missed deadlines are skipped rather than caught up in a burst
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long latency = (now.tv_sec - deadline.tv_sec) * 1000000000L + (now.tv_nsec - deadline.tv_nsec);
+        bool overrun = latency >= period;
+        jitter_histogram.record(latency * 1e-9, overrun);
+        if (overrun)
+            deadline = now;
+
+        // Cancelled movement: the queued setpoints are discarded, the robot stops with the jerk limits from its current motion
+        if (flush_requested && !stopping)
+        {
+            setpoints.clear();
+            if (has_setpoint)
+            {
+                stop_generator.set_stop(setpoint, (setpoint - previous[0]) / cycle_time,
+                    (setpoint - 2 * previous[0] + previous[1]) / (cycle_time * cycle_time));
+                stopping = true;
+            }
+            else
+                flush_requested = false;
         }
+
+        if (stopping)
+        {
+            setpoint = stop_generator.next();
+            send_joint_state(setpoint);
+            if (stop_generator.finished())
+            {
+                stopping = false;
+                flush_requested = false;
+            }
+        }
+        else if (setpoints.try_pop(setpoint))
+        {
+            if (!has_setpoint)
+                previous[0] = previous[1] = setpoint;
+            has_setpoint = true;
+            send_joint_state(setpoint);
+        }
+        else if (has_setpoint && holding)
+            send_joint_state(setpoint);
+
+        // The robot keeps the last setpoint when nothing is published
+        previous[1] = previous[0];
+        previous[0] = setpoint;
+    }
+}
+
+bool UR5Controller::stream_setpoint(const JointStateVector &setpoint)
+{
+    // Back-pressure: the control thread frees a slot every cycle
+    while (!is_cancelled() && !setpoints.try_push(setpoint) && ros::ok())
+    {
+        report("moving");
+        std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / loop_frequency));
     }
+    return !is_cancelled();
+}
+
+void UR5Controller::wait_setpoints(void)
+{
+    while (!is_cancelled() && !setpoints.empty() && ros::ok())
+    {
+        report("moving");
+        std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / loop_frequency));
+    }
+}
+
+bool UR5Controller::is_cancelled(void) const
+{
+    return motion_cancelled != nullptr && *motion_cancelled;
+}
+
+void UR5Controller::report(const std::string &stage, bool force)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!motion_feedback || (!force && std::chrono::duration<double>(now - last_feedback).count() < feedback_period))
+        return;
+    last_feedback = now;
+
+    // Progress along the segment: distance covered over the length of the segment
+    JointStateVector joints = read_joints();
+    double length = (segment_end - segment_start).norm();
+    double progress = length > 0 ? 1.0 - (segment_end - joints).norm() / length : 1.0;
+    motion_feedback(stage, joints, std::min(1.0, std::max(0.0, progress)));
+}
+
+JointStateVector UR5Controller::read_joints(void) const
+{
+    JointStateSample sample = joint_state.load();
+    return Eigen::Map<const JointStateVector>(sample.joints);
+}
+
+void UR5Controller::publish_jitter(const ros::WallTimerEvent &event)
+{
+    // Counts of the wake-up latencies since the start, one bin every 10 us, the last bin is the overflow
+    std_msgs::Int64MultiArray jitter_msg;
+    std::vector<long> bins = jitter_histogram.bins();
+    jitter_msg.data.assign(bins.begin(), bins.end());
+    jitter_pub.publish(jitter_msg);
+
+    JitterStats stats = jitter_histogram.stats();
+    ROS_DEBUG("UR5 control thread: %ld cycles, %ld overruns, latency p50 %.0f us, p99 %.0f us, p99.9 %.0f us, max %.0f us",
+        stats.cycles, stats.overruns, stats.p50_latency * 1e6, stats.p99_latency * 1e6, stats.p999_latency * 1e6, stats.max_latency * 1e6);
 }
 
 void UR5Controller::send_joint_state(const JointStateVector &desired_joints) const
@@ -77,8 +305,9 @@ void UR5Controller::send_joint_state(const JointStateVector &desired_joints) con
 
         joint_state_msg_array.data.resize(6 + n);
         // Add the state of the gripper 
+        JointStateSample sample = joint_state.load();
         for (int i = 0; i < n; i++)
-            joint_state_msg_array.data[6 + i] = current_gripper(i);
+            joint_state_msg_array.data[6 + i] = sample.gripper[i];
     }
 
     // Add state of the joints
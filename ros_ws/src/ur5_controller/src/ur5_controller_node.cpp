@@ -1,6 +1,8 @@
 #include "ur5_controller/ur5_services.h"
 
 UR5Controller *controller_ptr = nullptr;
+MoveToActionServer *move_action_ptr = nullptr;
+std::atomic<bool> move_action_cancel(false);
 
 bool srv_move_to(ur5_controller::MoveTo::Request &req, ur5_controller::MoveTo::Response &res)
 {
@@ -9,7 +11,45 @@ bool srv_move_to(ur5_controller::MoveTo::Request &req, ur5_controller::MoveTo::R
     pos << req.pos.x, req.pos.y, req.pos.z;
     rot = euler_to_rot(req.rot.roll, req.rot.pitch, req.rot.yaw);
 
-    res.status = controller_ptr->move_to(pos, rot, 50);
+    // Straight line of the end effector, or any path in the joints space
+    if (req.linear)
+        res.status = controller_ptr->move_linear(pos, rot);
+    else
+        res.status = controller_ptr->move_to(pos, rot, 50);
+
+    return true;
+}
+
+
+bool srv_move_through(ur5_controller::MoveThrough::Request &req, ur5_controller::MoveThrough::Response &res)
+{
+    if (req.pos.size() != req.rot.size())
+    {
+        res.status = false;
+        return true;
+    }
+
+    std::vector<Coordinates> positions(req.pos.size());
+    std::vector<RotationMatrix> rotations(req.rot.size());
+    for (int i = 0; i < (int)req.pos.size(); i++)
+    {
+        positions[i] << req.pos[i].x, req.pos[i].y, req.pos[i].z;
+        rotations[i] = euler_to_rot(req.rot[i].roll, req.rot[i].pitch, req.rot[i].yaw);
+    }
+
+    // Default blending tolerance, in rad
+    double tolerance = req.tolerance > 0 ? req.tolerance : 0.1;
+    res.status = controller_ptr->move_through(positions, rotations, tolerance);
+
+    return true;
+}
+
+
+bool srv_check_reachable(ur5_controller::CheckReachable::Request &req, ur5_controller::CheckReachable::Response &res)
+{
+    Coordinates pos;
+    pos << req.pos.x, req.pos.y, req.pos.z;
+    res.status = controller_ptr->reachability(pos, euler_to_rot(req.rot.roll, req.rot.pitch, req.rot.yaw));
 
     return true;
 }
@@ -23,6 +63,44 @@ bool srv_set_gripper(ur5_controller::SetGripper::Request &req, ur5_controller::S
 }
 
 
+void execute_move_to(const ur5_controller::MoveToGoalConstPtr &goal)
+{
+    Coordinates pos;
+    pos << goal->pos.x, goal->pos.y, goal->pos.z;
+    RotationMatrix rot = euler_to_rot(goal->rot.roll, goal->rot.pitch, goal->rot.yaw);
+
+    // The preempt callback may run before the movement starts
+    move_action_cancel = move_action_ptr->isPreemptRequested();
+    UR5FeedbackFunction feedback = [](const std::string &stage, const JointStateVector &joints, double progress)
+    {
+        ur5_controller::MoveToFeedback feedback_msg;
+        feedback_msg.stage = stage;
+        feedback_msg.joints.assign(joints.data(), joints.data() + joints.size());
+        feedback_msg.progress = progress;
+        move_action_ptr->publishFeedback(feedback_msg);
+    };
+
+    ur5_controller::MoveToResult result;
+    if (goal->linear)
+        result.status = controller_ptr->move_linear(pos, rot, &move_action_cancel, feedback);
+    else
+        result.status = controller_ptr->move_to(pos, rot, 50, &move_action_cancel, feedback);
+
+    if (move_action_cancel || move_action_ptr->isPreemptRequested())
+        move_action_ptr->setPreempted(result);
+    else if (result.status)
+        move_action_ptr->setSucceeded(result);
+    else
+        move_action_ptr->setAborted(result);
+}
+
+
+void preempt_move_to(void)
+{
+    move_action_cancel = true;
+}
+
+
 int main(int argc, char **argv)
 {
     // ROS Node initialization
@@ -32,9 +110,36 @@ int main(int argc, char **argv)
     UR5Controller controller(1000.0, 0.05, 10.0);
     controller_ptr = &controller;
 
+    // Static scene of the workcell, optional
+    std::string scene_file;
+    if (controller_node.getParam("/ur5_scene", scene_file))
+        controller.load_scene(scene_file);
+
+    // Precomputed roadmap of the workcell, optional
+    std::string roadmap_file;
+    if (controller_node.getParam("/ur5_roadmap", roadmap_file))
+        controller.load_roadmap(roadmap_file);
+
+    // Precomputed reachability map of the default rotation, optional
+    std::string reachability_file;
+    if (controller_node.getParam("/ur5_reachability", reachability_file))
+        controller.load_reachability_map(reachability_file);
+
     ros::ServiceServer move_service = controller_node.advertiseService("ur5/move_to", srv_move_to);
+    ros::ServiceServer move_through_service = controller_node.advertiseService("ur5/move_through", srv_move_through);
+    ros::ServiceServer reachable_service = controller_node.advertiseService("ur5/check_reachable", srv_check_reachable);
     ros::ServiceServer gripper_service = controller_node.advertiseService("ur5/set_gripper", srv_set_gripper);
-    ros::spin();
+
+    // Preemptible movements with feedback, the goals are executed in the thread of the server
+    MoveToActionServer move_action(controller_node, "ur5/move_to_action", execute_move_to, false);
+    move_action_ptr = &move_action;
+    move_action.registerPreemptCallback(preempt_move_to);
+    move_action.start();
+
+    // The services are served concurrently: the reachability queries are answered while the arm moves,
+    // the movements and the gripper commands are serialized by the controller
+    ros::MultiThreadedSpinner spinner(4);
+    spinner.spin();
 
     return 0;
 }
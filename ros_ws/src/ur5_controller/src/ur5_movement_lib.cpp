@@ -1,157 +1,478 @@
 #include "ur5_controller/ur5_controller_lib.h"
-#include <map>
-#include <Eigen/SVD>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
-static JointStateVector lin_filter;
-static double v_ref;
-
 /* Public functions */
 
-bool UR5Controller::move_to(const Coordinates &pos, const RotationMatrix &rot, int n)
+bool UR5Controller::move_to(const Coordinates &pos, const RotationMatrix &rot, int n, const atomic<bool> *cancel,
+    const UR5FeedbackFunction &feedback)
 {
-    // Read the /ur5/joint_states topic and get the initial configuration
-    ros::spinOnce();
-    JointStateVector initial_joints = current_joints;
+    MotionScope scope(*this, cancel, feedback);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // The unreachable targets are rejected before any planning
+    if (reachability(pos, rot) == 0)
+    {
+        planning_stats = PlanningStats();
+        planning_stats.selected_rank = -1;
+        ROS_WARN("UR5 target (%.2f, %.2f, %.2f) is not reachable!", pos(0), pos(1), pos(2));
+        return false;
+    }
+
+    // Read the last joint states and get the initial configuration
+    JointStateVector initial_joints = read_joints();
     ROS_DEBUG("Moving UR5: initial joints values: %.2f %.2f %.2f %.2f %.2f %.2f", initial_joints(0), initial_joints(1), initial_joints(2),
         initial_joints(3), initial_joints(4), initial_joints(5)); 
 
-    // Compute complete inverse kinematics to find all the possibile final configurations
-    Eigen::Matrix<double, 8, 6> ik_result;
-    ik_result = ur5_inverse_complete(pos, rot);
-    int *indexes = sort_ik_result(ik_result, initial_joints);
-
-    double *path;
-    bool is_valid = false;
+    // Compute complete inverse kinematics to find all the possibile final configurations, in ranked order
+    vector<JointStateVector> solutions = solve_ik(pos, rot, initial_joints);
 
     // Compute the path of for every ik solution
-    for (int i = 0; i < 8; i++)
+    vector<CubicTrajectory> paths;
+    for (const JointStateVector &final_testing_joints : solutions)
+        paths.push_back(ur5_trajectory_plan(initial_joints, final_testing_joints, n));
+    int n_paths = paths.size();
+    planning_stats.ik_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Validate the paths concurrently. A valid path cancels the validation of the lower ranked ones
+    array<atomic<bool>, 8> cancelled;
+    array<bool, 8> valid;
+    array<int, 8> evaluations;
+    vector<future<void>> results;
+    for (int r = 0; r < n_paths; r++)
+    {
+        cancelled[r] = false;
+        valid[r] = false;
+        evaluations[r] = 0;
+    }
+    for (int r = 0; r < n_paths; r++)
+    {
+        results.push_back(planning_pool.submit([this, r, n_paths, &paths, &cancelled, &valid, &evaluations]()
+        {
+            valid[r] = validate_path(paths[r], &cancelled[r], &evaluations[r]);
+            if (valid[r])
+                for (int k = r + 1; k < n_paths; k++)
+                    cancelled[k] = true;
+        }));
+    }
+
+    // The first valid path in ranked order is the one to follow, there is no need to wait for the others
+    int selected = -1;
+    for (int r = 0; r < n_paths && selected < 0; r++)
+    {
+        results[r].wait();
+        if (valid[r])
+            selected = r;
+    }
+    planning_stats.planning_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    planning_stats.candidates = n_paths;
+    planning_stats.selected_rank = selected;
+    planning_stats.discarded = selected < 0 ? 0 : n_paths - selected - 1;
+
+    // The cancelled tasks return at their next configuration, they reference the local paths
+    for (auto &result : results)
+        result.wait();
+    planning_stats.validated_configurations = 0;
+    for (int r = 0; r < n_paths; r++)
+        planning_stats.validated_configurations += evaluations[r];
+
+    ROS_DEBUG("UR5 planning: %.3f ms (inverse kinematics %.3f ms), %d candidates, selected rank %d, %d configurations checked",
+        planning_stats.planning_time * 1000, planning_stats.ik_time * 1000, planning_stats.candidates, planning_stats.selected_rank,
+        planning_stats.validated_configurations);
+
+    if (selected >= 0)
     {
-        int index = indexes[i];
-        JointStateVector final_testing_joints;
-        final_testing_joints << ik_result(index, 0), ik_result(index, 1), ik_result(index, 2),
-            ik_result(index, 3), ik_result(index, 4), ik_result(index, 5);
+        planning_stats.fallback_time = 0;
+        planning_stats.fallback_waypoints = 0;
+        follow_path(paths[selected]);
+        return !is_cancelled();
+    }
 
-        path = ur5_trajectory_plan(initial_joints, final_testing_joints, n);
+    // No straight path in the joints space is valid: look for a path around the constraints
+    vector<JointStateVector> waypoints;
+    if (!plan_fallback(initial_joints, paths, waypoints))
+    {
+        ROS_WARN("UR5 could not find a valid path!");
+        return false;
+    }
+
+    follow_waypoints(waypoints, 0.1);
+    return !is_cancelled();
+}
 
-        if (validate_path(path, n))
+bool UR5Controller::move_through(const vector<Coordinates> &positions, const vector<RotationMatrix> &rotations, double tolerance,
+    const atomic<bool> *cancel, const UR5FeedbackFunction &feedback)
+{
+    MotionScope scope(*this, cancel, feedback);
+    if (positions.empty() || positions.size() != rotations.size())
+        return false;
+
+    // The unreachable targets are rejected before any planning
+    for (int k = 0; k < (int)positions.size(); k++)
+    {
+        if (reachability(positions[k], rotations[k]) == 0)
         {
-            is_valid = true;
-            break;
+            ROS_WARN("UR5 waypoint %d is not reachable!", k);
+            return false;
         }
+    }
+
+    // Read the last joint states and get the initial configuration
+    vector<JointStateVector> waypoints(1, read_joints());
 
+    // For every pose, the closest ik solution that can be reached from the previous one
+    for (int k = 0; k < (int)positions.size(); k++)
+    {
+        vector<JointStateVector> solutions = solve_ik(positions[k], rotations[k], waypoints.back());
+
+        bool found = false;
+        for (int i = 0; i < (int)solutions.size() && !found; i++)
+        {
+            JointStateVector final_testing_joints = solutions[i];
+            if (validate_path(ur5_trajectory_plan(waypoints.back(), final_testing_joints, 50)))
+            {
+                waypoints.push_back(final_testing_joints);
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            ROS_WARN("UR5 could not find a valid path to waypoint %d!", k);
+            return false;
+        }
     }
 
-    if (!is_valid)
+    follow_waypoints(waypoints, tolerance);
+    return !is_cancelled();
+}
+
+bool UR5Controller::move_linear(const Coordinates &pos, const RotationMatrix &rot, const atomic<bool> *cancel,
+    const UR5FeedbackFunction &feedback)
+{
+    MotionScope scope(*this, cancel, feedback);
+    // The unreachable targets are rejected before any planning
+    if (reachability(pos, rot) == 0)
     {
-        ROS_WARN("UR5 could not find a valid path!");
-        free(path);
+        ROS_WARN("UR5 target (%.2f, %.2f, %.2f) is not reachable!", pos(0), pos(1), pos(2));
         return false;
     }
 
-    // Filter configuration
-    init_filters();
+    // Read the last joint states and get the initial configuration
+    JointStateVector initial_joints = read_joints();
+    RigidTransform goal(rot, pos);
+    CartesianPath path(ur5_direct(initial_joints), goal, linear_velocity, angular_velocity);
+    double cycle_time = 1.0 / loop_frequency;
+    int ticks = ceil(path.get_duration() / cycle_time);
 
-    // Movement loop
-    int i = -1;
-    while (++i < n)
+    // Open-loop, the setpoints only depend on the initial configuration: one differential inverse kinematics step every cycle,
+    // from the previous setpoint, computed and validated before moving
+    JointLimits limits = ur5_joint_limits();
+    Coordinates line_start = path.pose(0).pos, line = pos - line_start;
+    vector<JointStateVector> setpoints;
+    setpoints.reserve(ticks);
+    cartesian_stats = CartesianStats();
+    cartesian_stats.ticks = ticks;
+    double total_time = 0;
+    JointStateVector joints = initial_joints;
+    for (int k = 1; k <= ticks; k++)
     {
-        JointStateVector intermediate_joints, desired_joints;
-        intermediate_joints << path[i * 6], path[i * 6 + 1], path[i * 6 + 2],
-            path[i * 6 + 3], path[i * 6 + 4], path[i * 6 + 5];
+        double t = k * cycle_time;
+        chrono::steady_clock::time_point step_start = chrono::steady_clock::now();
+        JointStateVector next = ur5_differential_ik(joints, path.pose(t), path.twist(t), cycle_time, ik_gain, ik_damping);
+        double step_time = chrono::duration<double>(chrono::steady_clock::now() - step_start).count();
 
-        if (intermediate_joints.norm() == 0)
-            continue;
+        total_time += step_time;
+        cartesian_stats.max_step_time = max(cartesian_stats.max_step_time, step_time);
+        cartesian_stats.slow_steps += step_time > cycle_time;
 
-        // Movement loop (between two intermediate points)
-        while (ros::ok() && compute_error(current_joints, intermediate_joints) > joints_error)
+        // The straight lines are the approaches to the grasps and the retracts: the gripper may touch the grasp obstacles
+        if (((next - joints).cwiseAbs().array() > limits.velocity.array() * cycle_time).any() || !validate_configuration(next, true))
         {
-            desired_joints = linear_filter(intermediate_joints);
+            ROS_WARN("UR5 straight line to (%.2f, %.2f, %.2f) is not valid at %.2f s!", pos(0), pos(1), pos(2), t);
+            return false;
+        }
 
-            // Send position to topic
-            send_joint_state(desired_joints);
+        // Tracking of the end effector of the setpoint: distance from the segment, rotation error at its time
+        RigidTransform reached = ur5_direct(next);
+        Coordinates offset = reached.pos - line_start;
+        double along = line.squaredNorm() > 0 ? min(max(offset.dot(line) / line.squaredNorm(), 0.0), 1.0) : 0;
+        cartesian_stats.max_position_error = max(cartesian_stats.max_position_error, (offset - along * line).norm());
+        cartesian_stats.max_rotation_error = max(cartesian_stats.max_rotation_error, pose_error(path.pose(t), reached).tail<3>().norm());
 
-            // Loop state
-            loop_rate.sleep();
-            ros::spinOnce();
+        setpoints.push_back(next);
+        joints = next;
+    }
+    cartesian_stats.mean_step_time = ticks > 0 ? total_time / ticks : 0;
+    if (pose_error(goal, ur5_direct(joints)).norm() > 1e-3)
+    {
+        ROS_WARN("UR5 straight line to (%.2f, %.2f, %.2f) does not converge!", pos(0), pos(1), pos(2));
+        return false;
+    }
+
+    // Movement loop: the validated setpoints are queued ahead of the control thread, as far as the ring allows
+    segment_start = initial_joints;
+    segment_end = joints;
+    for (int k = 0; ros::ok() && k < ticks; k++)
+    {
+        // Queue the setpoint, the control thread publishes it at its cycle
+        if (!stream_setpoint(setpoints[k]))
+        {
+            cartesian_stats.ticks = k;
+            break;
         }
     }
-    ROS_DEBUG("Moving UR5: final joints values: %.2f %.2f %.2f %.2f %.2f %.2f", current_joints(0), current_joints(1), current_joints(2),
-        current_joints(3), current_joints(4), current_joints(5)); 
-    free(path);
-    return true;
+
+    ROS_DEBUG("UR5 straight line: %d ticks, precomputed differential ik %.2f us mean, %.2f us max, %d steps over the period, tracking error %.2e m %.2e rad",
+        cartesian_stats.ticks, cartesian_stats.mean_step_time * 1e6, cartesian_stats.max_step_time * 1e6, cartesian_stats.slow_steps,
+        cartesian_stats.max_position_error, cartesian_stats.max_rotation_error);
+
+    settle(joints);
+    return !is_cancelled();
+}
+
+PlanningStats UR5Controller::get_planning_stats(void) const
+{
+    return planning_stats;
+}
+
+IKCacheStats UR5Controller::get_ik_cache_stats(void) const
+{
+    return ik_cache.get_stats();
+}
+
+CartesianStats UR5Controller::get_cartesian_stats(void) const
+{
+    return cartesian_stats;
 }
 
 /* Private functions */
 
-bool UR5Controller::validate_path(double *path, int n) const
+void UR5Controller::follow_path(const CubicTrajectory &path)
 {
-    // Compute direct kinematics on every configuration inside the path
-    for (int j = 0; j < n; j++)
+    JointStateVector final_joints = path.back();
+
+    // Movement loop: the path is a straight line in the joints space, timed by the trajectory generator
+    segment_start = path.front();
+    segment_end = final_joints;
+    trajectory_generator.set_target(path.front(), final_joints);
+    while (ros::ok() && !trajectory_generator.finished())
     {
-        Coordinates testing_position;
-        RotationMatrix testing_rotation;
-        JointStateVector intermediate_testing_joints;
+        // Queue the setpoint, the control thread publishes it at its cycle
+        if (!stream_setpoint(trajectory_generator.next()))
+            break;
+    }
 
-        intermediate_testing_joints << path[j * 6], path[j * 6 + 1], path[j * 6 + 2],
-            path[j * 6 + 3], path[j * 6 + 4], path[j * 6 + 5];
-        ur5_direct(intermediate_testing_joints, testing_position, testing_rotation);
+    settle(final_joints);
+}
 
-        if (intermediate_testing_joints.norm() == 0)
-            continue;
+bool UR5Controller::follow_timed_path(const JointPath &path)
+{
+    PathTiming timing;
+    if (!time_parameterize(path, ur5_joint_limits(), timing))
+        return false;
 
-        // Check position constraints
-        if (testing_position(2) > 0.74 && testing_position(1) > -0.4)
-            return false;
+    // Movement loop: one setpoint of the time law every cycle
+    double cycle_time = 1.0 / loop_frequency;
+    segment_start = path.position(0);
+    segment_end = path.position(path.length());
+    for (double t = cycle_time; ros::ok() && t < timing.duration() + cycle_time; t += cycle_time)
+    {
+        // Queue the setpoint, the control thread publishes it at its cycle
+        if (!stream_setpoint(path.position(timing.path_parameter(t))))
+            break;
+    }
 
-        Eigen::Matrix<double, 6, 6> jac;
-        jac = ur5_jacobian(intermediate_testing_joints);
-        
-        // // Check singularity with jacobian determinant
-        if (abs(jac.determinant()) < 0.00001)
-            return false;
+    settle(path.position(path.length()));
+    return true;
+}
 
-        // Check singulaity with jacobian singular values
-        Eigen::JacobiSVD<Eigen::MatrixXd> svd(jac, Eigen::ComputeThinU | Eigen::ComputeThinV);
-        if (abs(svd.singularValues()(5)) < 0.00001)
-            return false;
+bool UR5Controller::plan_fallback(const JointStateVector &initial_joints, const vector<CubicTrajectory> &paths, vector<JointStateVector> &waypoints)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    planning_stats.fallback_waypoints = 0;
+
+    // Graph search in the roadmap, the local connections are checked with the same constraints
+    bool found = false;
+    StateValidityChecker checker = [this](const JointStateVector &q) { return validate_configuration(q); };
+    for (int r = 0; r < (int)paths.size() && !found && roadmap.loaded(); r++)
+    {
+        found = roadmap.query(initial_joints, paths[r].back(), checker, waypoints);
+
+        // The edges of the roadmap are checked again, the scene may have changed since it was built
+        for (int k = 0; found && k + 1 < (int)waypoints.size(); k++)
+            found = validate_motion(waypoints[k], waypoints[k + 1]);
+        if (found)
+        {
+            fallback_planner.shortcut(waypoints);
+            planning_stats.selected_rank = r;
+            planning_stats.fallback_waypoints = waypoints.size();
+        }
     }
-    return true;
+
+    for (int r = 0; r < (int)paths.size() && !found; r++)
+    {
+        // The remaining time is shared by the remaining solutions
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double budget = (fallback_time - elapsed) / (paths.size() - r);
+        if (budget <= 0)
+            break;
+
+        found = fallback_planner.plan(initial_joints, paths[r].back(), budget, waypoints);
+        if (found)
+        {
+            fallback_planner.shortcut(waypoints);
+            planning_stats.selected_rank = r;
+            planning_stats.fallback_waypoints = waypoints.size();
+        }
+    }
+    planning_stats.fallback_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ROS_DEBUG("UR5 fallback planning: %.3f ms, %d waypoints, selected rank %d", planning_stats.fallback_time * 1000,
+        planning_stats.fallback_waypoints, planning_stats.selected_rank);
+    return found;
+}
+
+void UR5Controller::follow_waypoints(const vector<JointStateVector> &waypoints, double tolerance)
+{
+    // Blend the corners at the intermediate configurations
+    BlendedPath path(waypoints, tolerance);
+    if (validate_path(path, 0.02) && follow_timed_path(path))
+        return;
+
+    // Stop at every waypoint: the straight segments have already been validated
+    ROS_DEBUG("UR5 blended path not valid, stopping at the waypoints");
+    for (int k = 0; k + 1 < (int)waypoints.size() && !is_cancelled(); k++)
+        follow_path(ur5_trajectory_plan(waypoints[k], waypoints[k + 1], 50));
 }
 
-int *sort_ik_result(const Eigen::Matrix<double, 8, 6> &ik_result, const JointStateVector &initial_joints)
+void UR5Controller::settle(const JointStateVector &final_joints)
 {
-    multimap<double, int> m;
-    for (int i = 0; i < 8; i++)
+    // The movement ends when the control thread has published every setpoint
+    stream_setpoint(final_joints);
+    holding = true;
+    wait_setpoints();
+
+    // Cancelled: the control thread stops the robot from its current motion, within the jerk limits
+    if (is_cancelled())
     {
-        JointStateVector comp;
-        comp << ik_result(i, 0), ik_result(i, 1), ik_result(i, 2), 
-            ik_result(i, 3), ik_result(i, 4), ik_result(i, 5);
-        m.insert(pair<double, int>((comp - initial_joints).norm(), i));
+        flush_requested = true;
+        while (flush_requested && ros::ok())
+            this_thread::sleep_for(chrono::duration<double>(1.0 / loop_frequency));
+        holding = false;
+        ROS_INFO("UR5 movement cancelled");
+        return;
     }
-    
-    int *list = (int *)malloc(sizeof(int) * 8);
-    int i = 0;
-    for (auto const& it : m) {
-        list[i++] = it.second;
+
+    // Settling loop: the control thread holds the final configuration until the joints reach it
+    ros::Time settling_start = ros::Time::now();
+    JointStateVector joints = read_joints();
+    while (ros::ok() && !is_cancelled() && compute_error(joints, final_joints) > joints_error &&
+        (ros::Time::now() - settling_start).toSec() < settling_time)
+    {
+        report("settling");
+        this_thread::sleep_for(chrono::duration<double>(1.0 / loop_frequency));
+        joints = read_joints();
     }
-    return list;
+    holding = false;
+    report("settling", true);
+    ROS_DEBUG("Moving UR5: final joints values: %.2f %.2f %.2f %.2f %.2f %.2f", joints(0), joints(1), joints(2),
+        joints(3), joints(4), joints(5)); 
 }
 
-void UR5Controller::init_filters(void)
+vector<JointStateVector> UR5Controller::solve_ik(const Coordinates &pos, const RotationMatrix &rot, const JointStateVector &initial_joints)
 {
-    ros::spinOnce();
-    lin_filter = current_joints;
-    v_ref = 0.0;
+    vector<JointStateVector> solutions;
+    planning_stats.ik_iterations = 0;
+    IKCacheEntry entry;
+    planning_stats.ik_cache_hit = ik_cache.find(pos, rot, entry);
+    if (planning_stats.ik_cache_hit)
+    {
+        // Same quantized pose: the cached solutions are close, a few iterations reach the exact pose
+        bool same_pose = (entry.pos - pos).norm() < 1e-9 && (entry.rot - rot).norm() < 1e-9;
+        for (const JointStateVector &cached : entry.solutions)
+        {
+            JointStateVector refined;
+            int iterations = 0;
+            if (same_pose)
+                solutions.push_back(cached);
+            else if (ur5_inverse_lm(pos, rot, cached, refined, ik_tolerance, 10, &iterations))
+                solutions.push_back(refined);
+            planning_stats.ik_iterations += iterations;
+        }
+    }
+    else
+    {
+        // The out of reach analytic branches are clamped, only the exact solutions are kept
+        Eigen::Array<bool, 8, 1> exact;
+        Eigen::Matrix<double, 8, 6> ik_result = ur5_inverse_complete_simd(pos, rot, exact);
+        for (int i = 0; i < 8; i++)
+            if (exact(i) && ik_result.row(i).allFinite())
+                solutions.push_back(ik_result.row(i).transpose());
+
+        // No analytic branch reaches the pose: iterations from the initial configuration, e.g. at the workspace boundary
+        JointStateVector iterative;
+        if (solutions.empty() && ur5_inverse_lm(pos, rot, initial_joints, iterative, ik_tolerance, 100, &planning_stats.ik_iterations))
+            solutions.push_back(iterative);
+
+        if (!solutions.empty())
+            ik_cache.insert(pos, rot, solutions);
+    }
+
+    // Ranked by the distance from the initial configuration
+    stable_sort(solutions.begin(), solutions.end(), [&initial_joints](const JointStateVector &a, const JointStateVector &b)
+    {
+        return (a - initial_joints).norm() < (b - initial_joints).norm();
+    });
+
+    ROS_DEBUG("UR5 inverse kinematics: %d solutions, cache %s, %d iterations", (int)solutions.size(),
+        planning_stats.ik_cache_hit ? "hit" : "miss", planning_stats.ik_iterations);
+    return solutions;
 }
 
-JointStateVector UR5Controller::linear_filter(const JointStateVector &final_joints)
+bool UR5Controller::validate_configuration(const JointStateVector &joints, bool grasping) const
 {
-    double v_des = 0.6;
-    v_ref += 0.005 * (v_des - v_ref);
-    lin_filter += 1.0 / loop_frequency * v_ref * (final_joints - lin_filter) / (final_joints - lin_filter).norm();
-    return lin_filter;
+    return ur5_check_configuration(joints) && !collision_scene.in_collision(joints, grasping);
+}
+
+bool UR5Controller::configuration_clearance(const JointStateVector &joints, UR5LinkDistances &clearance) const
+{
+    if (!ur5_check_configuration(joints))
+        return false;
+
+    // The workbench constraint is a distance of the end effector, the end of the last wrist link
+    clearance = collision_scene.clearance(joints, clearance_distance);
+    clearance[5] = min(clearance[5], ur5_workbench_distance(ur5_direct(joints).pos));
+    return *min_element(clearance.begin(), clearance.end()) > 0;
+}
+
+bool UR5Controller::validate_motion(const JointStateVector &from, const JointStateVector &to, const atomic<bool> *cancelled, int *evaluations) const
+{
+    ClearanceFunction clearance = [this](const JointStateVector &q, UR5LinkDistances &distances) { return configuration_clearance(q, distances); };
+    return collision_scene.check_motion(from, to, clearance, max_check_step, evaluations, cancelled);
+}
+
+bool UR5Controller::validate_path(const CubicTrajectory &path, const atomic<bool> *cancelled, int *evaluations) const
+{
+    // The samples of the trajectory lie on the straight motion between its ends
+    return validate_motion(path.front(), path.back(), cancelled, evaluations);
+}
+
+bool UR5Controller::validate_path(const JointPath &path, double step) const
+{
+    int n = ceil(path.length() / step);
+    for (int i = 0; i <= n; i++)
+    {
+        if (!validate_configuration(path.position(n > 0 ? path.length() * i / n : 0)))
+            return false;
+    }
+    return true;
 }
 
 double norm_angle(double angle)
@@ -0,0 +1,63 @@
+/**
+* @file ur5_reachability_builder.cpp
+* @brief Offline tool: compute the reachability map of the UR5 for the default rotation of the end effector (ur5_default_rot)
+* and write it to a binary file, loaded by ur5_controller_node at startup (param /ur5_reachability)
+*
+* Usage: ur5_reachability_builder <file> [voxel size]
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/reachability_map.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        cerr << "usage: " << argv[0] << " <file> [voxel size]" << endl;
+        return 1;
+    }
+    double voxel_size = argc > 2 ? atof(argv[2]) : 0.02;
+
+    // Default rotation of the FSM, the box contains the workspace of the UR5 (base frame)
+    RotationMatrix rot = euler_to_rot(M_PI / 2, 0, 0);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ReachabilityMap map;
+    map.build(rot, Coordinates(-1.0, -1.0, -0.5), Coordinates(1.0, 1.0, 1.0), voxel_size, ur5_check_configuration);
+    double build_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (!map.write(argv[1]))
+    {
+        cerr << "cannot write " << argv[1] << endl;
+        return 1;
+    }
+
+    // Agreement of the queries with the inverse kinematics, on random positions
+    mt19937 gen(42);
+    uniform_real_distribution<double> xy(-1.0, 1.0), z(-0.5, 1.0);
+    int reachable = 0, rejected = 0, accepted = 0, n = 100000;
+    for (int t = 0; t < n; t++)
+    {
+        Coordinates pos(xy(gen), xy(gen), z(gen));
+        Eigen::Matrix<double, 8, 6> ik_result = ur5_inverse_complete_simd(pos, rot);
+        bool valid = false;
+        for (int r = 0; r < 8 && !valid; r++)
+        {
+            JointStateVector q = ik_result.row(r).transpose();
+            valid = q.allFinite() && ur5_check_configuration(q);
+        }
+        reachable += valid;
+        rejected += valid && map.dexterity(pos) == 0;
+        accepted += !valid && map.dexterity(pos) > 0;
+    }
+
+    cout << "map: " << map.size() << " gridpoints, " << map.reachable_points() << " reachable, voxel size " << voxel_size << " m" << endl;
+    cout << "build time: " << build_time << " s" << endl;
+    cout << "random positions: " << reachable << "/" << n << " reachable, " << rejected << " wrongly rejected and "
+         << accepted << " wrongly accepted by the map" << endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+/**
+* @file ur5_roadmap_builder.cpp
+* @brief Offline tool: build the probabilistic roadmap of the UR5 workcell and write it to a binary file,
+* loaded by ur5_controller_node at startup (param /ur5_roadmap)
+*
+* Usage: ur5_roadmap_builder <file> [samples] [neighbours] [seed] [scene file]
+*/
+
+#include "kinematics_lib/ur5_kinematics.h"
+#include "kinematics_lib/roadmap.h"
+#include "kinematics_lib/collision.h"
+#include <chrono>
+#include <iostream>
+#include <set>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        cerr << "usage: " << argv[0] << " <file> [samples] [neighbours] [seed] [scene file]" << endl;
+        return 1;
+    }
+    int n_samples = argc > 2 ? atoi(argv[2]) : 5000;
+    int k = argc > 3 ? atoi(argv[3]) : 10;
+    unsigned int seed = argc > 4 ? atoi(argv[4]) : 42;
+
+    // Same checks of the controller: the obstacles of the scene, if given
+    CollisionScene scene;
+    if (argc > 5 && !scene.load(argv[5]))
+    {
+        cerr << "cannot read the scene " << argv[5] << endl;
+        return 1;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    RoadmapBuilder builder([&scene](const JointStateVector &q) { return ur5_check_configuration(q) && !scene.in_collision(q); });
+
+    // The poses of the cell (same frame and rotation of the FSM): home, pick region on the table,
+    // intermediate position, and the four baskets
+    vector<Coordinates> poses;
+    poses.push_back(Coordinates(0.1, -0.3, 0.4));
+    poses.push_back(Coordinates(-0.1, -0.4, 0.55));
+    for (double x = -0.3; x <= 0.3 + 1e-9; x += 0.1)
+        for (double y = -0.6; y <= -0.4 + 1e-9; y += 0.1)
+            poses.push_back(Coordinates(x, y, 0.8));
+    for (double y : {0.12, -0.03, -0.18, -0.33})
+        poses.push_back(Coordinates(0.42, y, 0.55));
+    RotationMatrix rot = euler_to_rot(M_PI / 2, 0, 0);
+
+    // Every valid ik solution of the poses is a node, so the motions of the cell start and end on the roadmap
+    int n_poses = 0;
+    vector<int> pose_nodes;
+    for (const Coordinates &pos : poses)
+    {
+        Eigen::Matrix<double, 8, 6> ik_result = ur5_inverse_complete(pos, rot);
+        bool reachable = false;
+        for (int i = 0; i < 8; i++)
+        {
+            JointStateVector q = ik_result.row(i).transpose();
+            int node = q.allFinite() ? builder.add_node(q) : -1;
+            if (node >= 0)
+                pose_nodes.push_back(node);
+            reachable = reachable || node >= 0;
+        }
+        n_poses += reachable;
+    }
+
+    JointStateVector limits = JointStateVector::Constant(M_PI);
+    builder.sample(n_samples, -limits, limits, seed);
+    builder.connect(k, 1.5);
+
+    set<int> components;
+    for (int node : pose_nodes)
+        components.insert(builder.component(node));
+
+    if (!builder.write(argv[1]))
+    {
+        cerr << "cannot write " << argv[1] << endl;
+        return 1;
+    }
+
+    cout << "poses: " << n_poses << "/" << poses.size() << " reachable, " << pose_nodes.size() << " ik nodes" << endl;
+    cout << "roadmap: " << builder.size() << " nodes, " << builder.edges() << " edges" << endl;
+    cout << "components of the ik nodes: " << components.size() << endl;
+    cout << "build time: " << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+    return 0;
+}
\ No newline at end of file